@@ -99,6 +99,41 @@ public:
 		}
 	}
 
+	/*
+	 * In virtual time mode the timer is serviced from the main loop
+	 */
+	bool service(uint64_t& due)
+	{
+		if(state != running) {
+			return false;
+		}
+
+		due = start_time + interval;
+		if(now() < due) {
+			return true;
+		}
+
+		auto start = start_time;
+		if(callback.func != nullptr) {
+			callback.func(callback.arg);
+		}
+
+		// Callback may have stopped or re-programmed timer
+		if(state != running) {
+			return false;
+		}
+		if(start_time == start) {
+			if(!auto_load || interval == 0) {
+				state = stopped;
+				return false;
+			}
+			start_time += interval;
+		}
+
+		due = start_time + interval;
+		return true;
+	}
+
 	uint32_t read()
 	{
 		auto elapsed = now() - start_time;
@@ -144,8 +179,8 @@ void* CTimerThread::thread_routine()
 #endif
 
 	while(state != terminating) {
-		if(state == stopped) {
-			thread_state = stopped;
+		if(state == stopped || host_time_is_virtual()) {
+			thread_state = state;
 			sem.wait();
 			continue;
 		}
@@ -244,6 +279,11 @@ uint32_t hw_timer1_read()
 	return timer1->read();
 }
 
+bool host_service_hw_timer1(uint64_t* due)
+{
+	return timer1 && timer1->service(*due);
+}
+
 uint32_t hw_timer2_read()
 {
 	using R = std::ratio<HW_TIMER2_CLK, 1000000000ULL>;
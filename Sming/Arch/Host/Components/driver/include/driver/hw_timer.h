@@ -83,6 +83,13 @@ void hw_timer_init(void);
 
 void hw_timer_cleanup();
 
+/**
+ * @brief Hook function to service timer1 in virtual time mode
+ * @param due On return, time in microseconds (see `os_get_nanoseconds()`) at which timer1 is next due
+ * @retval bool false if timer1 is not running
+ */
+bool host_service_hw_timer1(uint64_t* due);
+
 #ifdef __cplusplus
 }
 #endif
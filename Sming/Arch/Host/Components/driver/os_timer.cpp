@@ -3,31 +3,96 @@
 #include <driver/hw_timer.h>
 #include <muldiv.h>
 #include <cassert>
+#include <vector>
 
 namespace
 {
-os_timer_t* timer_list;
+/*
+ * Armed timers are kept in a binary min-heap ordered by expiry time,
+ * giving O(log n) arm/disarm regardless of how many timers are active.
+ * Each timer records its heap position in `timer_index`.
+ */
+struct TimerEntry {
+	uint32_t expire;
+	uint32_t order; ///< Preserves arming order for timers with identical expiry
+	os_timer_t* timer;
+
+	bool operator<(const TimerEntry& other) const
+	{
+		int diff = expire - other.expire;
+		return (diff != 0) ? (diff < 0) : (int(order - other.order) < 0);
+	}
+};
+
+std::vector<TimerEntry> timer_queue;
+uint32_t timer_arm_count;
 CMutex mutex;
 
-// Called with mutex locked
-void timer_insert(uint32_t expire, os_timer_t* ptimer)
+void set_entry(unsigned index, const TimerEntry& entry)
+{
+	timer_queue[index] = entry;
+	entry.timer->timer_index = index;
+}
+
+void sift_up(unsigned index)
 {
-	os_timer_t* t_prev = nullptr;
-	auto t = timer_list;
-	while(t != nullptr) {
-		if(int(t->timer_expire - expire) > 0) {
+	auto entry = timer_queue[index];
+	while(index > 0) {
+		auto parent = (index - 1) / 2;
+		if(!(entry < timer_queue[parent])) {
 			break;
 		}
-		t_prev = t;
-		t = t->timer_next;
+		set_entry(index, timer_queue[parent]);
+		index = parent;
 	}
-	if(t_prev == nullptr) {
-		timer_list = ptimer;
-	} else {
-		t_prev->timer_next = ptimer;
+	set_entry(index, entry);
+}
+
+void sift_down(unsigned index)
+{
+	auto entry = timer_queue[index];
+	auto count = timer_queue.size();
+	for(;;) {
+		auto child = 2 * index + 1;
+		if(child >= count) {
+			break;
+		}
+		if(child + 1 < count && timer_queue[child + 1] < timer_queue[child]) {
+			++child;
+		}
+		if(!(timer_queue[child] < entry)) {
+			break;
+		}
+		set_entry(index, timer_queue[child]);
+		index = child;
 	}
-	ptimer->timer_next = t;
+	set_entry(index, entry);
+}
+
+// Called with mutex locked
+void timer_insert(uint32_t expire, os_timer_t* ptimer)
+{
+	ptimer->timer_next = nullptr;
 	ptimer->timer_expire = expire;
+	timer_queue.push_back({expire, timer_arm_count++, ptimer});
+	sift_up(timer_queue.size() - 1);
+}
+
+// Called with mutex locked
+void timer_remove(unsigned index)
+{
+	timer_queue[index].timer->timer_next = reinterpret_cast<os_timer_t*>(-1);
+	auto last = timer_queue.back();
+	timer_queue.pop_back();
+	if(index == timer_queue.size()) {
+		return;
+	}
+	set_entry(index, last);
+	if(index > 0 && last < timer_queue[(index - 1) / 2]) {
+		sift_up(index);
+	} else {
+		sift_down(index);
+	}
 }
 
 } // namespace
@@ -41,10 +106,11 @@ void os_timer_arm_ticks(os_timer_t* ptimer, uint32_t ticks, bool repeat_flag)
 	ptimer->timer_period = repeat_flag ? ticks : 0;
 	mutex.lock();
 	timer_insert(hw_timer2_read() + ticks, ptimer);
+	bool isNext = (ptimer->timer_index == 0);
 	mutex.unlock();
 
 	// Kick main thread (which services timers) if we're due next
-	if(timer_list == ptimer) {
+	if(isNext) {
 		host_thread_kick();
 	}
 }
@@ -72,20 +138,11 @@ void os_timer_disarm(struct os_timer_t* ptimer)
 	}
 
 	mutex.lock();
-	if(timer_list != nullptr) {
-		// Remove timer from list
-		if(ptimer == timer_list) {
-			timer_list = ptimer->timer_next;
-		} else {
-			auto t = timer_list;
-			while(t->timer_next != nullptr) {
-				if(t->timer_next == ptimer) {
-					t->timer_next = ptimer->timer_next;
-					break;
-				}
-				t = t->timer_next;
-			}
-		}
+	// Timer may not have been initialised with OS_TIMER_DEFAULT, so validate index
+	auto index = ptimer->timer_index;
+	if(index < timer_queue.size() && timer_queue[index].timer == ptimer) {
+		timer_remove(index);
+	} else {
 		ptimer->timer_next = reinterpret_cast<os_timer_t*>(-1);
 	}
 	mutex.unlock();
@@ -106,25 +163,37 @@ void os_timer_done(struct os_timer_t* ptimer)
 	os_timer_disarm(ptimer);
 }
 
+bool host_get_next_timer(uint32_t* expire)
+{
+	mutex.lock();
+	bool res = !timer_queue.empty();
+	if(res) {
+		*expire = timer_queue.front().expire;
+	}
+	mutex.unlock();
+	return res;
+}
+
 int host_service_timers()
 {
-	if(timer_list == nullptr) {
+	mutex.lock();
+	if(timer_queue.empty()) {
+		mutex.unlock();
 		return -1;
 	}
 
 	auto ticks_now = hw_timer2_read();
-	auto t = timer_list;
+	auto t = timer_queue.front().timer;
 	int ticks = t->timer_expire - ticks_now;
 	if(ticks > 0) {
+		mutex.unlock();
 		// Return milliseconds until timer due
 		using R = std::ratio<1000, HW_TIMER2_CLK>;
 		return muldiv<R::num, R::den>(unsigned(ticks));
 	}
 
-	mutex.lock();
 	// Pop timer from queue
-	timer_list = t->timer_next;
-	t->timer_next = reinterpret_cast<os_timer_t*>(-1);
+	timer_remove(0);
 	// Repeating timer?
 	if(t->timer_period != 0) {
 		timer_insert(t->timer_expire + t->timer_period, t);
@@ -51,6 +51,30 @@ uint32_t system_get_time(void);
 /* Use nanosecond count as base for hardware and CPU cycle counting */
 uint64_t os_get_nanoseconds(void);
 
+/**
+ * @brief Switch all clocks to or from virtual (simulated) time
+ * @param enable true to use virtual time
+ * @param startTime Wall-clock time in seconds since the epoch at which virtual time starts,
+ * or 0 to continue from current time
+ * @note The virtual clock only moves when `host_time_advance()` is called.
+ * Clocks never go backwards: on return to real time, the real clock is offset accordingly.
+ * The wall clock (RTC) reverts to the actual time.
+ * Do not switch whilst the hardware timer is running.
+ */
+void host_time_set_virtual(bool enable, uint64_t startTime);
+
+bool host_time_is_virtual(void);
+
+/**
+ * @brief Move virtual clock forward. Has no effect in real-time mode.
+ */
+void host_time_advance(uint64_t nanoseconds);
+
+/**
+ * @brief Get wall-clock time in nanoseconds since the epoch
+ */
+uint64_t host_time_get_wallclock(void);
+
 #define APB_CLK_FREQ 80000000U
 
 void os_delay_us(uint32_t us);
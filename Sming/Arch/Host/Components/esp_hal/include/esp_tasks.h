@@ -32,6 +32,9 @@ void host_init_tasks();
 // Hook function to process task queues
 void host_service_tasks();
 
+// Determine whether any task queue has events waiting
+bool host_tasks_pending();
+
 typedef void (*host_task_callback_t)(os_param_t param);
 
 bool host_queue_callback(host_task_callback_t callback, os_param_t param);
@@ -2,6 +2,7 @@
 #include <hostlib/hostapi.h>
 #include <hostlib/threads.h>
 #include <sys/time.h>
+#include <atomic>
 #include <Platform/Timers.h>
 
 /* System time */
@@ -34,16 +35,73 @@ static uint64_t initTime()
 
 uint64_t host_system_start_time = initTime();
 
+namespace
+{
+struct {
+	std::atomic<uint64_t> nanoseconds;
+	uint64_t wallclockBase; ///< Wall-clock time corresponding to nanoseconds == 0
+	uint64_t realOffset;	///< Added to real clock after leaving virtual mode so time never goes backwards
+	bool enabled;
+} virtualTime;
+
+} // namespace
+
+void host_time_set_virtual(bool enable, uint64_t startTime)
+{
+	if(enable == virtualTime.enabled) {
+		return;
+	}
+
+	auto now = os_get_nanoseconds();
+	if(enable) {
+		auto wallclock = (startTime == 0) ? host_time_get_wallclock() : (startTime * 1000000000ULL);
+		virtualTime.wallclockBase = wallclock - now;
+		virtualTime.nanoseconds = now;
+		virtualTime.enabled = true;
+	} else {
+		virtualTime.enabled = false;
+		virtualTime.realOffset += now - os_get_nanoseconds();
+	}
+}
+
+bool host_time_is_virtual()
+{
+	return virtualTime.enabled;
+}
+
+void host_time_advance(uint64_t nanoseconds)
+{
+	if(virtualTime.enabled) {
+		virtualTime.nanoseconds += nanoseconds;
+	}
+}
+
+uint64_t host_time_get_wallclock()
+{
+	if(virtualTime.enabled) {
+		return virtualTime.wallclockBase + virtualTime.nanoseconds;
+	}
+
+	timeval tv{};
+	gettimeofday(&tv, nullptr);
+	return ((1000000ULL * tv.tv_sec) + tv.tv_usec) * 1000ULL;
+}
+
 uint64_t os_get_nanoseconds()
 {
+	if(virtualTime.enabled) {
+		return virtualTime.nanoseconds;
+	}
+
 #ifdef __WIN32
 	LARGE_INTEGER count;
 	QueryPerformanceCounter(&count);
-	return timeref.countsPerNanosecond * uint64_t(count.QuadPart - timeref.startCount.QuadPart);
+	return timeref.countsPerNanosecond * uint64_t(count.QuadPart - timeref.startCount.QuadPart) +
+		   virtualTime.realOffset;
 #else
 	timespec ts{};
 	clock_gettime(CLOCK_MONOTONIC, &ts);
-	return (1000000000ULL * ts.tv_sec) + ts.tv_nsec - timeref.startTicks;
+	return (1000000000ULL * ts.tv_sec) + ts.tv_nsec - timeref.startTicks + virtualTime.realOffset;
 #endif
 }
 
@@ -54,6 +112,11 @@ uint32_t system_get_time()
 
 void os_delay_us(uint32_t us)
 {
+	if(virtualTime.enabled) {
+		host_time_advance(us * 1000ULL);
+		return;
+	}
+
 	ElapseTimer timer(us);
 	while(!timer.expired()) {
 		//
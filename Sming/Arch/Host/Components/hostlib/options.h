@@ -59,7 +59,10 @@
 	XX(nonet, no_argument, "Skip network initialisation", nullptr, nullptr, nullptr)                                   \
 	XX(debug, required_argument, "Set debug verbosity", "LEVEL", "Maximum debug message level to print",               \
 	   "0 = errors only, 1 = +warnings, 2 = +info\0")                                                                  \
-	XX(cpulimit, required_argument, "Set CPU limit", "COUNT", "0 = no limit", nullptr)
+	XX(cpulimit, required_argument, "Set CPU limit", "COUNT", "0 = no limit", nullptr)                                 \
+	XX(virtualtime, optional_argument, "Use simulated clock", "SECS",                                                  \
+	   "Start time in seconds since the epoch, omit to use current time",                                              \
+	   "Time advances directly to the next timer when idle\0")
 
 enum option_tag_t {
 #define XX(tag, has_arg, desc, argname, arghelp, examples) opt_##tag,
@@ -31,7 +31,9 @@
 #include <driver/os_timer.h>
 #include <driver/hw_timer.h>
 #include <esp_tasks.h>
+#include <esp_system.h>
 #include <cstdlib>
+#include <algorithm>
 #include "include/hostlib/emu.h"
 #include "include/hostlib/hostlib.h"
 #include "include/hostlib/CommandLine.h"
@@ -126,6 +128,48 @@ int host_main_loop()
 	return host_service_timers();
 }
 
+/*
+ * In virtual time mode, instead of waiting we move the clock directly to the next event.
+ * Only the main thread advances time so event ordering is deterministic.
+ */
+static void host_virtual_wait(int due)
+{
+	// Nominal time taken by each loop iteration whilst tasks are pending, so the clock keeps moving
+	constexpr uint64_t busyLoopTime{10000};
+	constexpr uint64_t noEvent{UINT64_MAX};
+
+	auto now = os_get_nanoseconds();
+	uint64_t next{noEvent};
+
+	uint64_t timer1Due;
+	if(host_service_hw_timer1(&timer1Due)) {
+		next = timer1Due * 1000ULL;
+	}
+
+	uint32_t expire;
+	if(host_get_next_timer(&expire)) {
+		int ticks = expire - hw_timer2_read();
+		uint64_t timerDue = now;
+		if(ticks > 0) {
+			// Round up so timer is due on arrival
+			timerDue += (uint64_t(ticks) * 1000000000ULL + HW_TIMER2_CLK - 1) / HW_TIMER2_CLK;
+		}
+		next = std::min(next, timerDue);
+	}
+
+	if(host_tasks_pending()) {
+		next = std::min(next, now + busyLoopTime);
+	} else if(next == noEvent) {
+		// Nothing scheduled, wait for external event (e.g. UART or network)
+		host_thread_wait(due);
+		return;
+	}
+
+	if(next > now) {
+		host_time_advance(next - now);
+	}
+}
+
 int main(int argc, char* argv[])
 {
 	trap_exceptions();
@@ -135,6 +179,8 @@ int main(int argc, char* argv[])
 		int exitpause{-1};
 		int loopcount{};
 		uint8_t cpulimit{};
+		uint64_t starttime{};
+		bool virtualtime{};
 		bool initonly{};
 		bool enable_network{true};
 		UartServer::Config uart{};
@@ -241,6 +287,11 @@ int main(int argc, char* argv[])
 			config.cpulimit = atoi(arg);
 			break;
 
+		case opt_virtualtime:
+			config.virtualtime = true;
+			config.starttime = arg ? strtoull(arg, nullptr, 0) : 0;
+			break;
+
 		case opt_none:
 			break;
 		}
@@ -267,6 +318,11 @@ int main(int argc, char* argv[])
 	} else {
 		Storage::initialize();
 
+		if(config.virtualtime) {
+			host_time_set_virtual(true, config.starttime);
+			host_debug_i("Using virtual time");
+		}
+
 		CThread::startup(config.cpulimit);
 
 		hw_timer_init();
@@ -303,7 +359,11 @@ int main(int argc, char* argv[])
 				}
 			}
 
-			host_thread_wait(due);
+			if(host_time_is_virtual()) {
+				host_virtual_wait(due);
+			} else {
+				host_thread_wait(due);
+			}
 		}
 
 		host_debug_i(">> Normal Exit <<\n");
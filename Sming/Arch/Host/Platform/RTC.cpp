@@ -10,7 +10,7 @@
 
 #include <Platform/RTC.h>
 
-#include <sys/time.h>
+#include <esp_system.h>
 
 RtcClass RTC;
 
@@ -23,19 +23,12 @@ RtcClass::RtcClass() = default;
 
 uint64_t RtcClass::getRtcNanoseconds()
 {
-	struct timeval tv {
-	};
-	gettimeofday(&tv, nullptr);
-	uint64_t usecs = (tv.tv_sec * 1000000ULL) + (uint32_t)tv.tv_usec;
-	return usecs * 1000;
+	return host_time_get_wallclock();
 }
 
 uint32_t RtcClass::getRtcSeconds()
 {
-	struct timeval tv {
-	};
-	gettimeofday(&tv, nullptr);
-	return tv.tv_sec + timeDiff;
+	return (host_time_get_wallclock() / 1'000'000'000ULL) + timeDiff;
 }
 
 bool RtcClass::setRtcNanoseconds(uint64_t nanoseconds)
@@ -20,7 +20,8 @@ COMPONENT_DEPENDS := \
 	libb64 \
 	ws_parser \
 	mqtt-codec \
-	libyuarel
+	libyuarel \
+	uzlib
 
 # WiFi settings may be provide via Environment variables
 CONFIG_VARS				+= WIFI_SSID WIFI_PWD
@@ -12,11 +12,26 @@
 
 #include "Base64OutputStream.h"
 
+namespace
+{
 // Produce line breaks in output encodings
 const unsigned CHARS_PER_LINE = 72;
 
+/*
+ * Largest source block whose encoding fits in the result buffer.
+ * Allow for 2 bytes carried over from the previous block, a line break after every
+ * CHARS_PER_LINE characters, and round down to whole groups so the encoder's fast path is used.
+ */
+size_t getBlockSize(size_t resultSize)
+{
+	size_t chars = (resultSize > 8) ? (resultSize - 8) * CHARS_PER_LINE / (CHARS_PER_LINE + 1) : 0;
+	return std::max((chars / 4) * 3, size_t(3));
+}
+
+} // namespace
+
 Base64OutputStream::Base64OutputStream(IDataSourceStream* stream, size_t resultSize)
-	: StreamTransformer(stream, resultSize, (resultSize / 4))
+	: StreamTransformer(stream, resultSize, getBlockSize(resultSize))
 {
 	base64_init_encodestate(&state, CHARS_PER_LINE);
 }
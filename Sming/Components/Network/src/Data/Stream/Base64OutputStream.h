@@ -26,6 +26,7 @@ public:
 	 * @brief Stream that transforms bytes of data into base64 data stream
 	 * @param stream - source stream
 	 * @param resultSize The size of the intermediate buffer, created once per object and reused multiple times
+	 * @note Source data is read in the largest blocks whose encoding fits in this buffer
 	 */
 	Base64OutputStream(IDataSourceStream* stream, size_t resultSize = 500);
 
@@ -0,0 +1,136 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * Awaitables.h - Network objects for use with coroutines
+ *
+ ****/
+
+#pragma once
+
+#include <Coroutine.h>
+#include "TcpClient.h"
+#include "Http/HttpClient.h"
+
+namespace Co
+{
+/**
+ * @brief Awaitable which becomes ready when all data queued on a TcpClient has been acknowledged
+ * @note The client's ready-to-send and completion callbacks are used whilst waiting, and cleared afterwards.
+ * The awaitable also becomes ready if the connection closes or fails first; check `isSuccessful()`.
+ */
+class TcpSent : public Awaitable
+{
+public:
+	explicit TcpSent(TcpClient& client) : client(client)
+	{
+	}
+
+	/**
+	 * @brief Start waiting, typically called immediately after `TcpClient::send()`
+	 */
+	void start()
+	{
+		reset();
+		if(check()) {
+			return;
+		}
+		client.setReadyToSendDelegate([this](TcpClient&, TcpConnectionEvent) {
+			// Delegate is destroyed by finish() so don't access any captured values afterwards
+			auto self = this;
+			if(self->check()) {
+				self->finish();
+			}
+		});
+		client.setCompleteDelegate([this](TcpClient&, bool) {
+			// Connection closed or failed before all data was acknowledged
+			auto self = this;
+			self->successful = false;
+			self->finish();
+			self->signal();
+		});
+	}
+
+	/**
+	 * @brief Determine whether data was sent successfully
+	 */
+	bool isSuccessful() const
+	{
+		return successful;
+	}
+
+private:
+	bool check()
+	{
+		if(client.isSendComplete()) {
+			successful = true;
+		} else if(!client.isProcessing()) {
+			successful = false;
+		} else {
+			return false;
+		}
+		signal();
+		return true;
+	}
+
+	void finish()
+	{
+		client.setReadyToSendDelegate(nullptr);
+		client.setCompleteDelegate(nullptr);
+	}
+
+	TcpClient& client;
+	bool successful{false};
+};
+
+/**
+ * @brief Awaitable which sends an HTTP request and becomes ready when the response is complete
+ */
+class HttpResult : public Awaitable
+{
+public:
+	/**
+	 * @brief Send a request
+	 * @param client
+	 * @param request The request's completion callback is used by this object
+	 * @retval bool false if request could not be queued
+	 */
+	bool send(HttpClient& client, HttpRequest* request)
+	{
+		reset();
+		successful = false;
+		status = HTTP_STATUS_OK;
+		request->onRequestComplete([this](HttpConnection& connection, bool success) -> int {
+			successful = success;
+			status = connection.getResponse()->code;
+			signal();
+			return 0;
+		});
+		if(client.send(request)) {
+			return true;
+		}
+		signal();
+		return false;
+	}
+
+	bool isSuccessful() const
+	{
+		return successful;
+	}
+
+	/**
+	 * @brief Get HTTP status code from the response
+	 */
+	HttpStatus getStatus() const
+	{
+		return status;
+	}
+
+private:
+	HttpStatus status{HTTP_STATUS_OK};
+	bool successful{false};
+};
+
+} // namespace Co
@@ -0,0 +1,230 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * DnsCache.cpp
+ *
+ ****/
+
+#include "DnsCache.h"
+#include <lwip/dns.h>
+#include <debug_progmem.h>
+
+struct DnsCache::Request {
+	String name;
+	Callback callback;
+	Request* next;
+};
+
+DnsCache& DnsCache::global()
+{
+	static DnsCache cache;
+	return cache;
+}
+
+DnsCache::~DnsCache()
+{
+	while(requests != nullptr) {
+		auto request = requests;
+		requests = request->next;
+		delete request;
+	}
+}
+
+err_t DnsCache::lookup(const String& name, IpAddress& address, Callback callback)
+{
+	if(!name) {
+		return ERR_ARG;
+	}
+
+	// Addresses in dotted decimal form need no lookup
+	ip_addr_t addr;
+	if(ipaddr_aton(name.c_str(), &addr)) {
+		address = addr;
+		return ERR_OK;
+	}
+
+	auto entry = find(name);
+	if(entry != nullptr) {
+		entry->lastUsed = millis();
+		auto age = entry->getAge();
+		if(entry->address.isNull()) {
+			if(age < settings.negativeTtl) {
+				++stats.negativeHits;
+				return ERR_VAL;
+			}
+		} else if(age < settings.ttl) {
+			++stats.hits;
+			address = entry->address;
+			if(age + settings.prefetch >= settings.ttl && refresh(*entry)) {
+				++stats.prefetches;
+			}
+			return ERR_OK;
+		} else if(age < uint32_t(settings.ttl) + settings.staleTtl) {
+			++stats.staleHits;
+			address = entry->address;
+			if(refresh(*entry)) {
+				++stats.revalidations;
+			}
+			return ERR_OK;
+		}
+	}
+
+	++stats.misses;
+	return query(name, address, callback);
+}
+
+void DnsCache::remove(const String& name)
+{
+	auto entry = find(name);
+	if(entry != nullptr) {
+		*entry = Entry{};
+	}
+}
+
+void DnsCache::clear()
+{
+	for(auto& entry : entries) {
+		entry = Entry{};
+	}
+}
+
+DnsCache::Entry* DnsCache::find(const String& name)
+{
+	for(auto& entry : entries) {
+		if(entry.name == name) {
+			return &entry;
+		}
+	}
+	return nullptr;
+}
+
+bool DnsCache::refresh(Entry& entry)
+{
+	if(entry.refreshing) {
+		return false;
+	}
+
+	debug_d("[DNS] Refreshing '%s'", entry.name.c_str());
+	entry.refreshing = true;
+	IpAddress address;
+	return query(entry.name, address, nullptr) == ERR_INPROGRESS;
+}
+
+err_t DnsCache::resolve(const String& name, IpAddress& address)
+{
+	ip_addr_t addr;
+	err_t err = dns_gethostbyname(
+		name.c_str(), &addr,
+		[](const char* name, LWIP_IP_ADDR_T* ipaddr, void* arg) {
+			IpAddress address;
+			if(ipaddr != nullptr) {
+				address = *ipaddr;
+			}
+			static_cast<DnsCache*>(arg)->resolved(name, address);
+		},
+		this);
+	if(err == ERR_OK) {
+		// Found in lwIP's own table
+		address = addr;
+	}
+	return err;
+}
+
+void DnsCache::resolved(const String& name, IpAddress address)
+{
+	update(name, address);
+
+	// Take waiting requests off the list first, as callbacks may start new lookups
+	Request* waiting{nullptr};
+	for(auto prev = &requests; *prev != nullptr;) {
+		auto request = *prev;
+		if(request->name == name) {
+			*prev = request->next;
+			request->next = waiting;
+			waiting = request;
+		} else {
+			prev = &request->next;
+		}
+	}
+
+	while(waiting != nullptr) {
+		auto request = waiting;
+		waiting = request->next;
+		request->callback(request->name, address);
+		delete request;
+	}
+}
+
+err_t DnsCache::query(const String& name, IpAddress& address, Callback callback)
+{
+	err_t err = resolve(name, address);
+	if(err == ERR_INPROGRESS) {
+		if(callback) {
+			auto request = new Request{name, callback, requests};
+			if(request != nullptr) {
+				requests = request;
+			}
+		}
+		return err;
+	}
+
+	if(err == ERR_OK) {
+		update(name, address);
+		return err;
+	}
+
+	// Local failure, such as no DNS server configured, so don't remember it
+	debug_d("[DNS] Lookup of '%s' failed: %d", name.c_str(), err);
+	++stats.failures;
+	auto entry = find(name);
+	if(entry != nullptr) {
+		entry->refreshing = false;
+	}
+	return err;
+}
+
+void DnsCache::update(const String& name, IpAddress address)
+{
+	auto entry = find(name);
+	if(address.isNull()) {
+		debug_d("[DNS] '%s' not found", name.c_str());
+		++stats.failures;
+		// Keep using an existing address until it runs out
+		if(entry != nullptr && !entry->address.isNull() &&
+		   entry->getAge() < uint32_t(settings.ttl) + settings.staleTtl) {
+			entry->refreshing = false;
+			return;
+		}
+	}
+
+	auto now = millis();
+	auto timestamp = RTC.getRtcSeconds();
+	if(entry == nullptr) {
+		// Use an empty slot, or replace the least recently used entry
+		entry = &entries[0];
+		for(auto& e : entries) {
+			if(!e.name) {
+				entry = &e;
+				break;
+			}
+			if(now - e.lastUsed > now - entry->lastUsed) {
+				entry = &e;
+			}
+		}
+		entry->name = name;
+		entry->lastUsed = now;
+	}
+	entry->address = address;
+	entry->timestamp = timestamp;
+	entry->refreshing = false;
+}
+
+void DnsCache::printStats(Print& p) const
+{
+	p << _F("DNS cache: hits ") << stats.hits << _F(", stale ") << stats.staleHits << _F(", negative ")
+	  << stats.negativeHits << _F(", misses ") << stats.misses << _F(", prefetches ") << stats.prefetches
+	  << _F(", revalidations ") << stats.revalidations << _F(", failures ") << stats.failures << endl;
+}
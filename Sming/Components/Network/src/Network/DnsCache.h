@@ -0,0 +1,197 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * DnsCache.h
+ *
+ ****/
+
+#pragma once
+
+#include <IpAddress.h>
+#include <lwip/err.h>
+#include <WString.h>
+#include <Delegate.h>
+#include <Print.h>
+#include <Clock.h>
+#include <Platform/RTC.h>
+
+/* Number of host names kept in the cache */
+#ifndef DNS_CACHE_SIZE
+#define DNS_CACHE_SIZE 8
+#endif
+
+/* Seconds for which a resolved address is used without asking the DNS server again */
+#ifndef DNS_CACHE_TTL
+#define DNS_CACHE_TTL 300
+#endif
+
+/* Seconds for which a failed lookup is remembered */
+#ifndef DNS_CACHE_NEGATIVE_TTL
+#define DNS_CACHE_NEGATIVE_TTL 10
+#endif
+
+/* Seconds after expiry for which an address may still be used whilst it is looked up again */
+#ifndef DNS_CACHE_STALE_TTL
+#define DNS_CACHE_STALE_TTL 300
+#endif
+
+/* Seconds before expiry at which a frequently used address is looked up again */
+#ifndef DNS_CACHE_PREFETCH
+#define DNS_CACHE_PREFETCH 30
+#endif
+
+/** @defgroup   dnscache DNS cache
+ *  @brief      Shared cache of host name lookups
+ *  @ingroup    networking
+ *  @{
+ */
+
+/**
+ * @brief Cache of host name lookups shared by all network clients
+ *
+ * TcpConnection, UdpConnection and NtpClient resolve host names through this cache,
+ * so reconnecting to the same host does not have to wait for the DNS server.
+ *
+ * - Addresses are kept for `ttl` seconds. lwIP does not report the TTL given by the server so this is fixed.
+ * - Failed lookups are remembered for `negativeTtl` seconds, so repeated attempts fail immediately.
+ * - An expired address may be used for a further `staleTtl` seconds whilst it is looked up again in the background.
+ * - An address used within `prefetch` seconds of expiry is looked up again in the background.
+ *
+ * When the cache is full the least recently used entry is replaced.
+ *
+ * Ages are measured using the RTC, which does not wrap like `millis()`.
+ * Setting the system clock therefore makes existing entries expire, so they are looked up again.
+ */
+class DnsCache
+{
+public:
+	/**
+	 * @brief Called when an asynchronous lookup completes
+	 * @param name Host name
+	 * @param address Null on failure
+	 */
+	using Callback = Delegate<void(const String& name, IpAddress address)>;
+
+	struct Settings {
+		uint16_t ttl{DNS_CACHE_TTL};				  ///< Seconds an address is valid
+		uint16_t negativeTtl{DNS_CACHE_NEGATIVE_TTL}; ///< Seconds a failed lookup is remembered
+		uint16_t staleTtl{DNS_CACHE_STALE_TTL};		  ///< Seconds an expired address may be used whilst revalidating
+		uint16_t prefetch{DNS_CACHE_PREFETCH};		  ///< Seconds before expiry a used address is refreshed
+	};
+
+	struct Stats {
+		uint32_t hits;		   ///< Lookups answered with a valid address
+		uint32_t staleHits;		///< Lookups answered with an expired address
+		uint32_t negativeHits;	///< Lookups failed because of a recent failure
+		uint32_t misses;		///< Lookups sent to the DNS server
+		uint32_t prefetches;	///< Background lookups to refresh an address about to expire
+		uint32_t revalidations; ///< Background lookups to replace an expired address
+		uint32_t failures;		///< DNS server lookups which failed
+	};
+
+	virtual ~DnsCache();
+
+	/**
+	 * @brief Get the cache instance shared by all network clients
+	 */
+	static DnsCache& global();
+
+	/**
+	 * @brief Look up a host name
+	 * @param name Host name, or address in dotted decimal form
+	 * @param address On success, the address
+	 * @param callback Invoked if the result is not immediately available
+	 * @retval err_t
+	 * 	- ERR_OK: address is valid, callback will not be invoked
+	 * 	- ERR_INPROGRESS: callback will be invoked with the result
+	 * 	- Anything else: lookup failed, callback will not be invoked
+	 */
+	err_t lookup(const String& name, IpAddress& address, Callback callback);
+
+	/**
+	 * @brief Remove a host name from the cache, for example if its address no longer responds
+	 */
+	void remove(const String& name);
+
+	/**
+	 * @brief Empty the cache
+	 */
+	void clear();
+
+	const Settings& getSettings() const
+	{
+		return settings;
+	}
+
+	void setSettings(const Settings& settings)
+	{
+		this->settings = settings;
+	}
+
+	const Stats& getStats() const
+	{
+		return stats;
+	}
+
+	void resetStats()
+	{
+		stats = {};
+	}
+
+	void printStats(Print& p) const;
+
+protected:
+	/**
+	 * @brief Ask the DNS server for an address
+	 * @param name
+	 * @param address On success, the address
+	 * @retval err_t
+	 * 	- ERR_OK: address is valid
+	 * 	- ERR_INPROGRESS: `resolved()` will be called with the result
+	 * 	- Anything else: lookup failed
+	 * @note Override to resolve names some other way, for example in tests.
+	 * Do not call `resolved()` before returning.
+	 */
+	virtual err_t resolve(const String& name, IpAddress& address);
+
+	/**
+	 * @brief Called when a lookup which returned ERR_INPROGRESS completes
+	 * @param name
+	 * @param address Null on failure
+	 */
+	void resolved(const String& name, IpAddress address);
+
+private:
+	struct Entry {
+		String name;
+		IpAddress address;		///< Null if lookup failed
+		uint32_t timestamp{0};	///< Time of lookup, in RTC seconds
+		uint32_t lastUsed{0};	///< For replacement, in milliseconds
+		bool refreshing{false};	///< Background lookup in progress
+
+		/**
+		 * @brief Get seconds since entry was looked up
+		 */
+		uint32_t getAge() const
+		{
+			return RTC.getRtcSeconds() - timestamp;
+		}
+	};
+
+	struct Request;
+
+	Entry* find(const String& name);
+	void update(const String& name, IpAddress address);
+	bool refresh(Entry& entry);
+	err_t query(const String& name, IpAddress& address, Callback callback);
+
+	Entry entries[DNS_CACHE_SIZE];
+	Request* requests{nullptr}; ///< Callbacks waiting for lookups to complete
+	Settings settings;
+	Stats stats{};
+};
+
+/** @} */
@@ -0,0 +1,277 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * EventSourceResource.cpp
+ *
+ ****/
+
+#include "EventSourceResource.h"
+#include <debug_progmem.h>
+#include <algorithm>
+
+/*
+ * Response body for one subscriber, reading from the shared buffer.
+ * The size is unknown so no Content-Length is sent, and the body ends when the connection closes.
+ */
+class EventSourceResource::Subscriber : public IDataSourceStream
+{
+public:
+	Subscriber(EventSourceResource& resource, HttpServerConnection& connection)
+		: resource(&resource), connection(connection), start(resource.head), pos(resource.head)
+	{
+	}
+
+	~Subscriber()
+	{
+		if(resource != nullptr) {
+			resource->unsubscribe(this);
+		}
+	}
+
+	int available() override
+	{
+		return -1;
+	}
+
+	uint16_t readMemoryBlock(char* data, int bufSize) override
+	{
+		if(resource == nullptr || bufSize <= 0) {
+			return 0;
+		}
+		auto& res = *resource;
+		size_t count = std::min(size_t(res.head - pos), size_t(bufSize));
+		if(count < res.head - pos) {
+			/*
+			 * Pass whole events where possible, so a subscriber whose connection stalls stops at the start
+			 * of an event and DropOldest can skip events. Only an event too large for the buffer is split.
+			 */
+			size_t n = count;
+			while(n != 0 && !isEventEnd(pos + n)) {
+				--n;
+			}
+			if(n != 0) {
+				count = n;
+			} else if(bufSize < NETWORK_SEND_BUFFER_SIZE) {
+				// Wait for more space
+				return 0;
+			}
+		}
+		size_t offset = pos & (res.bufferSize - 1);
+		size_t n = std::min(count, res.bufferSize - offset);
+		memcpy(data, &res.buffer[offset], n);
+		memcpy(&data[n], res.buffer, count - n);
+		return count;
+	}
+
+	int seekFrom(int offset, SeekOrigin origin) override
+	{
+		if(origin != SeekOrigin::Current || offset < 0) {
+			return -1;
+		}
+		if(offset != 0) {
+			if(resource == nullptr || uint32_t(offset) > resource->head - pos) {
+				return -1;
+			}
+			// Bytes just sent are still in the buffer, so check whether they completed an event
+			char prev = (offset > 1) ? resource->getChar(pos + offset - 2) : lastChar;
+			pos += offset;
+			lastChar = resource->getChar(pos - 1);
+			atEventStart = (prev == '\n' && lastChar == '\n');
+		}
+		return pos - start;
+	}
+
+	bool isFinished() override
+	{
+		return resource == nullptr;
+	}
+
+	/*
+	 * Every event ends with a blank line
+	 */
+	bool isEventEnd(uint32_t end) const
+	{
+		char prev = (end - pos >= 2) ? resource->getChar(end - 2) : lastChar;
+		return prev == '\n' && resource->getChar(end - 1) == '\n';
+	}
+
+	/*
+	 * Stop subscribing. The connection finishes the response and, as it was marked
+	 * `Connection: close`, closes itself.
+	 */
+	void detach()
+	{
+		resource = nullptr;
+		connection.send();
+	}
+
+	EventSourceResource* resource;
+	HttpServerConnection& connection;
+	uint32_t start;
+	uint32_t pos;
+	char lastChar{'\n'};
+	bool atEventStart{true};
+};
+
+EventSourceResource::EventSourceResource(size_t bufferSize, unsigned maxSubscribers)
+	: bufferSize(SpscRing<char>::roundSize(bufferSize)), buffer(new char[this->bufferSize]),
+	  maxSubscribers(maxSubscribers)
+{
+	onRequestComplete = HttpResourceDelegate(&EventSourceResource::subscribe, this);
+}
+
+EventSourceResource::~EventSourceResource()
+{
+	while(subscribers.count() != 0) {
+		disconnect(subscribers.lastElement());
+	}
+	delete[] buffer;
+}
+
+int EventSourceResource::subscribe(HttpServerConnection& connection, HttpRequest& request, HttpResponse& response)
+{
+	if(request.method != HTTP_GET) {
+		response.code = HTTP_STATUS_METHOD_NOT_ALLOWED;
+		return 0;
+	}
+
+	if(buffer == nullptr || subscribers.count() >= maxSubscribers) {
+		debug_w("[SSE] Refusing subscriber, %u connected", subscribers.count());
+		response.code = HTTP_STATUS_SERVICE_UNAVAILABLE;
+		return 0;
+	}
+
+	auto subscriber = new Subscriber(*this, connection);
+	if(subscriber == nullptr || !subscribers.add(subscriber)) {
+		delete subscriber;
+		response.code = HTTP_STATUS_SERVICE_UNAVAILABLE;
+		return 0;
+	}
+
+	response.freeStreams();
+	response.stream = subscriber;
+	response.setContentType(F("text/event-stream"));
+	response.headers[HTTP_HEADER_CACHE_CONTROL] = F("no-cache");
+	response.headers[HTTP_HEADER_CONNECTION] = F("close");
+
+	/*
+	 * Events may be infrequent, so use the longest idle timeout available (about 18 hours).
+	 * Send comments periodically to keep the connection open through proxies and detect dead clients.
+	 */
+	connection.setTimeOut(USHRT_MAX);
+
+	debug_d("[SSE] New subscriber, %u connected", subscribers.count());
+	return 0;
+}
+
+void EventSourceResource::unsubscribe(Subscriber* subscriber)
+{
+	subscribers.removeElement(subscriber);
+	debug_d("[SSE] Subscriber closed, %u connected", subscribers.count());
+}
+
+void EventSourceResource::disconnect(Subscriber* subscriber)
+{
+	subscribers.removeElement(subscriber);
+	subscriber->detach();
+}
+
+bool EventSourceResource::send(const String& data, const String& event, const String& id)
+{
+	if(event.indexOf('\n') >= 0 || id.indexOf('\n') >= 0) {
+		return false;
+	}
+
+	String text;
+	if(event) {
+		text += _F("event: ");
+		text += event;
+		text += '\n';
+	}
+	if(id) {
+		text += _F("id: ");
+		text += id;
+		text += '\n';
+	}
+	int lineStart = 0;
+	int lineEnd;
+	do {
+		lineEnd = data.indexOf('\n', lineStart);
+		text += _F("data: ");
+		text.concat(data.c_str() + lineStart, ((lineEnd < 0) ? data.length() : unsigned(lineEnd)) - lineStart);
+		text += '\n';
+		lineStart = lineEnd + 1;
+	} while(lineEnd >= 0);
+	text += '\n';
+
+	return publish(text);
+}
+
+bool EventSourceResource::sendComment(const String& text)
+{
+	if(text.indexOf('\n') >= 0) {
+		return false;
+	}
+
+	String s;
+	s += ':';
+	if(text) {
+		s += ' ';
+		s += text;
+	}
+	s += _F("\n\n");
+	return publish(s);
+}
+
+bool EventSourceResource::publish(const String& text)
+{
+	size_t length = text.length();
+	if(buffer == nullptr || length > bufferSize) {
+		return false;
+	}
+
+	// Deal with subscribers which haven't yet sent data we're about to overwrite
+	uint32_t newHead = head + length;
+	for(unsigned i = subscribers.count(); i-- != 0;) {
+		auto subscriber = subscribers[i];
+		if(newHead - subscriber->pos <= bufferSize) {
+			continue;
+		}
+
+		// Events can only be skipped if sending hasn't started: we can't stop part-way through
+		if(dropPolicy == DropPolicy::Disconnect || !subscriber->atEventStart) {
+			debug_w("[SSE] Disconnecting slow subscriber");
+			disconnect(subscriber);
+			++disconnectCount;
+			continue;
+		}
+
+		// Every event ends with a blank line, and the new event will fit once we reach the head
+		uint32_t pos = subscriber->pos;
+		while(newHead - pos > bufferSize) {
+			char prev = '\0';
+			char c;
+			while((c = getChar(pos++)) != '\n' || prev != '\n') {
+				prev = c;
+			}
+			++droppedCount;
+		}
+		subscriber->pos = pos;
+	}
+
+	size_t offset = head & (bufferSize - 1);
+	size_t n = std::min(length, bufferSize - offset);
+	memcpy(&buffer[offset], text.c_str(), n);
+	memcpy(buffer, text.c_str() + n, length - n);
+	head = newHead;
+
+	// Start sending immediately rather than waiting for the next poll
+	for(unsigned i = subscribers.count(); i-- != 0;) {
+		subscribers[i]->connection.send();
+	}
+
+	return true;
+}
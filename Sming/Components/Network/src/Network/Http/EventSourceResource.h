@@ -0,0 +1,130 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * EventSourceResource.h
+ *
+ ****/
+
+#pragma once
+
+#include "HttpServerConnection.h"
+#include "HttpResource.h"
+#include <Data/Buffer/SpscRing.h>
+#include <WVector.h>
+
+/* Size of buffer shared by all subscribers to an event source. Sets the largest event which can be sent. */
+#ifndef HTTP_SSE_BUFFER_SIZE
+#define HTTP_SSE_BUFFER_SIZE 2048
+#endif
+
+/* Default subscriber limit. Keep this below the server's connection limit so other requests can be served. */
+#ifndef HTTP_SSE_MAX_SUBSCRIBERS
+#define HTTP_SSE_MAX_SUBSCRIBERS 4
+#endif
+
+/**
+ * @brief Resource serving a stream of Server-Sent Events (text/event-stream)
+ * @ingroup httpserver
+ *
+ * Each GET request subscribes to the stream, and the connection stays open until the client or server closes it.
+ * Events are formatted once into a ring buffer shared by all subscribers, and each connection sends
+ * directly from that buffer at its own pace.
+ *
+ * A subscriber which falls so far behind that a new event would overwrite data it has not yet sent
+ * is dealt with according to the DropPolicy. Whole events are passed to TCP where possible,
+ * so a subscriber whose connection stalls normally stops at the start of an event.
+ *
+ * Subscriber connections use the longest idle timeout available (about 18 hours).
+ * Call `sendComment()` periodically, say every 15 to 30 seconds, to keep them alive.
+ */
+class EventSourceResource : public HttpResource
+{
+public:
+	enum class DropPolicy {
+		DropOldest, ///< Skip the oldest events not yet started, disconnecting if part-way through sending one
+		Disconnect, ///< Close the slow subscriber's connection, so it reconnects
+	};
+
+	/**
+	 * @brief Constructor
+	 * @param bufferSize Size of buffer shared between all subscribers, rounded up to a power of 2
+	 * @param maxSubscribers Further requests are refused with 503 Service Unavailable
+	 */
+	EventSourceResource(size_t bufferSize = HTTP_SSE_BUFFER_SIZE, unsigned maxSubscribers = HTTP_SSE_MAX_SUBSCRIBERS);
+
+	~EventSourceResource();
+
+	/**
+	 * @brief Send an event to all current subscribers
+	 * @param data Event content. Each line is sent as a separate `data` field.
+	 * @param event Optional event type, must not contain line breaks
+	 * @param id Optional event ID, must not contain line breaks
+	 * @retval bool false if the event is invalid or larger than the buffer
+	 */
+	bool send(const String& data, const String& event = nullptr, const String& id = nullptr);
+
+	/**
+	 * @brief Send a comment line, which clients ignore
+	 * @param text Must not contain line breaks
+	 * @retval bool
+	 * @note Use as a keep-alive, every 15 to 30 seconds, so intermediate proxies don't close idle connections
+	 * and clients which have gone away are detected
+	 */
+	bool sendComment(const String& text = nullptr);
+
+	void setDropPolicy(DropPolicy policy)
+	{
+		dropPolicy = policy;
+	}
+
+	void setMaxSubscribers(unsigned count)
+	{
+		maxSubscribers = count;
+	}
+
+	unsigned getSubscriberCount() const
+	{
+		return subscribers.count();
+	}
+
+	/**
+	 * @brief Get number of events skipped by slow subscribers
+	 */
+	unsigned getDroppedCount() const
+	{
+		return droppedCount;
+	}
+
+	/**
+	 * @brief Get number of subscribers disconnected for being too slow
+	 */
+	unsigned getDisconnectCount() const
+	{
+		return disconnectCount;
+	}
+
+private:
+	class Subscriber;
+
+	int subscribe(HttpServerConnection& connection, HttpRequest& request, HttpResponse& response);
+	void unsubscribe(Subscriber* subscriber);
+	void disconnect(Subscriber* subscriber);
+	bool publish(const String& text);
+
+	char getChar(uint32_t pos) const
+	{
+		return buffer[pos & (bufferSize - 1)];
+	}
+
+	size_t bufferSize; ///< Power of 2, so positions remain valid when they wrap
+	char* buffer;
+	uint32_t head{0}; ///< Total bytes written
+	Vector<Subscriber*> subscribers;
+	unsigned maxSubscribers;
+	unsigned droppedCount{0};
+	unsigned disconnectCount{0};
+	DropPolicy dropPolicy{DropPolicy::DropOldest};
+};
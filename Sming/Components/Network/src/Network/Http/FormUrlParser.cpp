@@ -0,0 +1,137 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * FormUrlParser.cpp
+ *
+ ****/
+
+#include "FormUrlParser.h"
+#include <Data/WebHelpers/escape.h>
+#include <stringutil.h>
+#include <debug_progmem.h>
+#include <algorithm>
+
+static_assert(FORM_URL_PARSER_BUFSIZE >= 4 && FORM_URL_PARSER_BUFSIZE <= 255, "Bad FORM_URL_PARSER_BUFSIZE");
+
+bool FormUrlParser::parse(const char* data, size_t length)
+{
+	while(length != 0 && !stopped) {
+		if(inValue) {
+			auto end = static_cast<const char*>(memchr_fast(data, '&', length));
+			size_t len = (end == nullptr) ? length : end - data;
+			if(!addValue(data, len, end != nullptr)) {
+				break;
+			}
+			if(end == nullptr) {
+				break;
+			}
+			name.setLength(0);
+			inValue = false;
+			++len; // Skip the '&'
+			data += len;
+			length -= len;
+			continue;
+		}
+
+		// Name ends at '=', or at '&' if there's no value
+		auto end = static_cast<const char*>(memchr_fast(data, '&', length));
+		size_t len = (end == nullptr) ? length : end - data;
+		auto sep = static_cast<const char*>(memchr_fast(data, '=', len));
+		if(sep != nullptr) {
+			end = sep;
+			len = sep - data;
+		}
+		if(!name.concat(data, len)) {
+			debug_e("[FORM] Out of memory");
+			stopped = true;
+			break;
+		}
+		if(end == nullptr) {
+			break;
+		}
+		uri_unescape_inplace(name);
+		if(*end == '=') {
+			inValue = true;
+		} else if(name.length() != 0) {
+			if(!emit("", 0, true)) {
+				break;
+			}
+			name.setLength(0);
+		}
+		++len; // Skip the '=' or '&'
+		data += len;
+		length -= len;
+	}
+
+	return !stopped;
+}
+
+bool FormUrlParser::finish()
+{
+	if(!stopped) {
+		if(inValue) {
+			addValue("", 0, true);
+		} else if(name.length() != 0) {
+			uri_unescape_inplace(name);
+			emit("", 0, true);
+		}
+	}
+
+	bool result = !stopped;
+	name.setLength(0);
+	bufferLength = 0;
+	inValue = false;
+	stopped = false;
+	return result;
+}
+
+bool FormUrlParser::addValue(const char* data, size_t length, bool complete)
+{
+	// Content with nothing to unescape is passed on directly
+	if(bufferLength == 0 && memchr_fast(data, '%', length) == nullptr && memchr_fast(data, '+', length) == nullptr) {
+		return (length == 0 && !complete) || emit(data, length, complete);
+	}
+
+	while(length != 0) {
+		size_t len = std::min(length, sizeof(buffer) - bufferLength);
+		memcpy(&buffer[bufferLength], data, len);
+		bufferLength += len;
+		data += len;
+		length -= len;
+		if(bufferLength == sizeof(buffer) && !flush(false)) {
+			return false;
+		}
+	}
+
+	return !complete || flush(true);
+}
+
+bool FormUrlParser::flush(bool complete)
+{
+	// Keep back any escape sequence which may continue in the next block
+	unsigned keep = 0;
+	if(!complete) {
+		if(buffer[bufferLength - 1] == '%') {
+			keep = 1;
+		} else if(buffer[bufferLength - 2] == '%') {
+			keep = 2;
+		}
+	}
+
+	unsigned len = bufferLength - keep;
+	bool result = emit(buffer, uri_unescape_inplace(buffer, len), complete);
+	memmove(buffer, &buffer[len], keep);
+	bufferLength = keep;
+	return result;
+}
+
+bool FormUrlParser::emit(const char* value, size_t length, bool complete)
+{
+	if(!callback(name, value, length, complete)) {
+		stopped = true;
+	}
+	return !stopped;
+}
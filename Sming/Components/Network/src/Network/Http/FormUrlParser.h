@@ -0,0 +1,72 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * FormUrlParser.h
+ *
+ ****/
+
+#pragma once
+
+#include <WString.h>
+#include <Delegate.h>
+
+/* Size of buffer used to unescape parameter values */
+#ifndef FORM_URL_PARSER_BUFSIZE
+#define FORM_URL_PARSER_BUFSIZE 64
+#endif
+
+/**
+ * @brief Streaming parser for application/x-www-form-urlencoded content
+ * @ingroup http
+ *
+ * Data may be passed in blocks of any size. Each parameter name is unescaped and passed to the callback
+ * along with its value. Values are not stored: they are passed as fragments, unescaped either directly
+ * from the data provided or via a small fixed buffer, so memory use does not depend on the content size.
+ *
+ * A parameter without '=' is reported with an empty value.
+ */
+class FormUrlParser
+{
+public:
+	/**
+	 * @brief Called for each fragment of a parameter value
+	 * @param name Unescaped parameter name
+	 * @param value Unescaped fragment of the value, not nul-terminated
+	 * @param length Number of characters in value
+	 * @param complete true for the final fragment of this value
+	 * @retval bool Return false to stop parsing
+	 */
+	using Callback = Delegate<bool(const String& name, const char* value, size_t length, bool complete)>;
+
+	FormUrlParser(Callback callback) : callback(callback)
+	{
+	}
+
+	/**
+	 * @brief Parse a block of content
+	 * @retval bool false if parsing was stopped by the callback
+	 */
+	bool parse(const char* data, size_t length);
+
+	/**
+	 * @brief Call at end of content to complete the final parameter
+	 * @retval bool false if parsing was stopped by the callback
+	 * @note The parser is reset and may be used again
+	 */
+	bool finish();
+
+private:
+	bool addValue(const char* data, size_t length, bool complete);
+	bool flush(bool complete);
+	bool emit(const char* value, size_t length, bool complete);
+
+	Callback callback;
+	String name;
+	char buffer[FORM_URL_PARSER_BUFSIZE];
+	uint8_t bufferLength{0};
+	bool inValue{false};
+	bool stopped{false};
+};
@@ -15,7 +15,7 @@
  ****/
 
 #include "HttpBodyParser.h"
-#include <Data/WebHelpers/escape.h>
+#include "FormUrlParser.h"
 #include <Data/Stream/MemoryDataStream.h>
 
 /*
@@ -23,8 +23,24 @@
  * This structure stores the temporary values during parsing.
  */
 struct FormUrlParserState {
-	char searchChar{'='};
-	String postName;
+	FormUrlParserState(HttpParams& params)
+		: parser([this, &params](const String& name, const char* value, size_t length, bool complete) {
+			  if(complete && postValue.length() == 0) {
+				  params[name].setString(value, length);
+				  return true;
+			  }
+			  postValue.concat(value, length);
+			  if(complete) {
+				  params[name] = postValue;
+				  // Keep String memory allocated, but clear content
+				  postValue.setLength(0);
+			  }
+			  return true;
+		  })
+	{
+	}
+
+	FormUrlParser parser;
 	String postValue;
 };
 
@@ -37,22 +53,17 @@ size_t formUrlParser(HttpRequest& request, const char* at, int length)
 
 	if(length == PARSE_DATASTART) {
 		delete state;
-		request.args = new FormUrlParserState;
+		request.args = new FormUrlParserState(request.postParams);
 		return 0;
 	}
 
-	auto& params = request.postParams;
-
 	if(length == PARSE_DATAEND) {
 		if(state == nullptr) {
 			return 0;
 		}
 
 		// Store last parameter, if there is one
-		if(state->postName.length() != 0) {
-			uri_unescape_inplace(state->postValue);
-			params[state->postName] = state->postValue;
-		}
+		state->parser.finish();
 
 		delete state;
 		request.args = nullptr;
@@ -65,41 +76,41 @@ size_t formUrlParser(HttpRequest& request, const char* at, int length)
 		return 0;
 	}
 
-	size_t consumed = length;
-	while(length > 0) {
-		// Look for search character ('=' or '&') in received text
-		auto found = static_cast<const char*>(memchr(at, state->searchChar, length));
-		unsigned foundLength = (found == nullptr) ? length : (found - at);
-
-		if(foundLength != 0) {
-			if(state->searchChar == '=') {
-				state->postName.concat(at, foundLength);
-			} else {
-				state->postValue.concat(at, foundLength);
-			}
+	state->parser.parse(at, length);
+	return length;
+}
+
+HttpBodyParserDelegate createFormUrlStreamParser(HttpFormFieldDelegate callback)
+{
+	return [callback](HttpRequest& request, const char* at, int length) -> size_t {
+		auto parser = static_cast<FormUrlParser*>(request.args);
+
+		if(length == PARSE_DATASTART) {
+			delete parser;
+			request.args = new FormUrlParser(
+				[callback, &request](const String& name, const char* value, size_t length, bool complete) {
+					return callback(request, name, value, length, complete);
+				});
+			return 0;
 		}
 
-		if(found == nullptr) {
-			break;
+		if(parser == nullptr) {
+			debug_e("Invalid request argument");
+			return 0;
 		}
 
-		if(state->searchChar == '=') {
-			uri_unescape_inplace(state->postName);
-			state->searchChar = '&';
-		} else {
-			uri_unescape_inplace(state->postValue);
-			params[state->postName] = state->postValue;
-			state->searchChar = '=';
-			// Keep String memory allocated, but clear content
-			state->postName.setLength(0);
-			state->postValue.setLength(0);
+		if(length == PARSE_DATAEND || length < 0) {
+			if(length == PARSE_DATAEND) {
+				parser->finish();
+			}
+			delete parser;
+			request.args = nullptr;
+			return 0;
 		}
-		++foundLength; // Skip the '=' or '&'
-		at += foundLength;
-		length -= foundLength;
-	}
 
-	return consumed;
+		parser->parse(at, length);
+		return length;
+	};
 }
 
 size_t bodyToStringParser(HttpRequest& request, const char* at, int length)
@@ -46,6 +46,31 @@ using BodyParsers = HashMap<String, HttpBodyParserDelegate>;
  */
 size_t formUrlParser(HttpRequest& request, const char* at, int length);
 
+/**
+ * @brief Called for each fragment of a form field value
+ * @param request
+ * @param name Unescaped field name
+ * @param value Unescaped fragment of the value, not nul-terminated
+ * @param length Number of characters in value
+ * @param complete true for the final fragment of this value
+ * @retval bool Return false to ignore the remaining fields
+ * @see `FormUrlParser`
+ */
+using HttpFormFieldDelegate = Delegate<bool(HttpRequest& request, const String& name, const char* value,
+											size_t length, bool complete)>;
+
+/**
+ * @brief Create a parser for application/x-www-form-urlencoded body data which passes fields to a callback
+ * @param callback
+ * @retval HttpBodyParserDelegate
+ *
+ * Unlike `formUrlParser`, fields are not stored in `HttpRequest::postParams`.
+ * Memory use is therefore fixed regardless of the number or size of fields. For example:
+ *
+ * 		server.setBodyParser(MIME_FORM_URL_ENCODED, createFormUrlStreamParser(onFormField));
+ */
+HttpBodyParserDelegate createFormUrlStreamParser(HttpFormFieldDelegate callback);
+
 /**
  * @brief Stores the complete body into memory
  * @see `HttpBodyParserDelegate`
@@ -13,40 +13,11 @@
 #include "HttpClient.h"
 #include <Data/Stream/FileStream.h>
 
-HttpClient::HttpConnectionPool HttpClient::httpConnectionPool;
-SimpleTimer HttpClient::cleanUpTimer;
+HttpClientPool HttpClient::connectionPool;
 
-bool HttpClient::send(HttpRequest* request)
+namespace
 {
-	String cacheKey = getCacheKey(request->uri);
-
-	HttpClientConnection* connection = nullptr;
-
-	int i = httpConnectionPool.indexOf(cacheKey);
-	if(i >= 0) {
-		// Check existing connection
-		connection = httpConnectionPool.valueAt(i);
-	}
-
-	if(connection == nullptr) {
-		debug_d("Creating new HttpClientConnection");
-		connection = new HttpClientConnection();
-		if(connection == nullptr) {
-			debug_e("Cannot send request. Out of memory");
-			// Out of memory
-			delete request;
-			return false;
-		}
-		httpConnectionPool[cacheKey] = connection;
-	}
-
-	if(!cleanUpTimer.isStarted()) {
-		cleanUpTimer.initializeMs<60000>(HttpClient::cleanInactive).start(); // run every minute
-	}
-	return connection->send(request);
-}
-
-bool HttpClient::downloadFile(const Url& url, const String& saveFileName, RequestCompletedDelegate requestComplete)
+FileStream* openFile(const Url& url, const String& saveFileName, FileOpenFlags openFlags)
 {
 	String file = saveFileName;
 	if(file.length() == 0) {
@@ -54,30 +25,48 @@ bool HttpClient::downloadFile(const Url& url, const String& saveFileName, Reques
 	}
 
 	auto fileStream = new FileStream();
-	if(!fileStream->open(file, File::CreateNewAlways | File::WriteOnly)) {
+	if(!fileStream->open(file, openFlags)) {
 		debug_e("HttpClient failed to open \"%s\"", file.c_str());
 		delete fileStream;
-		return false;
+		return nullptr;
 	}
 
-	return send(
-		createRequest(url)->setResponseStream(fileStream)->setMethod(HTTP_GET)->onRequestComplete(requestComplete));
+	return fileStream;
 }
 
-void HttpClient::cleanInactive()
+} // namespace
+
+bool HttpClient::send(HttpRequest* request)
+{
+	return connectionPool.send(request);
+}
+
+bool HttpClient::downloadFile(const Url& url, const String& saveFileName, RequestCompletedDelegate requestComplete)
 {
-	debug_d("Total connections: %d", httpConnectionPool.count());
+	auto fileStream = openFile(url, saveFileName, File::CreateNewAlways | File::WriteOnly);
+	if(fileStream == nullptr) {
+		return false;
+	}
 
-	size_t i = 0;
-	while(i < httpConnectionPool.count()) {
-		auto connection = httpConnectionPool.valueAt(i);
+	return send(createRequest(url)
+					->setResponseStream(fileStream)
+					->setResumable()
+					->setMethod(HTTP_GET)
+					->onRequestComplete(requestComplete));
+}
 
-		if(connection->getConnectionState() > eTCS_Connecting && !connection->isActive()) {
-			debug_d("Removing stale connection: State: %d, Active: %d, Finished: %d", connection->getConnectionState(),
-					connection->isActive(), connection->isFinished());
-			httpConnectionPool.removeAt(i);
-		} else {
-			++i;
-		}
+bool HttpClient::resumeDownload(const Url& url, const String& saveFileName, const String& validator,
+								RequestCompletedDelegate requestComplete)
+{
+	// Existing content is kept
+	auto fileStream = openFile(url, saveFileName, File::Create | File::WriteOnly);
+	if(fileStream == nullptr) {
+		return false;
 	}
+
+	return send(createRequest(url)
+					->setResponseStream(fileStream)
+					->setResumable(validator)
+					->setMethod(HTTP_GET)
+					->onRequestComplete(requestComplete));
 }
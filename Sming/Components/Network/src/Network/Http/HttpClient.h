@@ -21,9 +21,8 @@
 #include "../TcpClient.h"
 #include "HttpCommon.h"
 #include "HttpRequest.h"
-#include "HttpClientConnection.h"
+#include "HttpClientPool.h"
 #include <Data/Stream/LimitedMemoryStream.h>
-#include <SimpleTimer.h>
 
 class HttpClient
 {
@@ -94,9 +93,26 @@ public:
 	 * @param url Source of file data
 	 * @param saveFileName Path to save file to. Optional: specify nullptr to use name from url
 	 * @param requestComplete Completion callback
+	 * @note If the connection fails the request is resent, continuing from the end of the data received so far.
+	 * See `HttpRequest::setResumable()`.
 	 */
 	bool downloadFile(const Url& url, const String& saveFileName, RequestCompletedDelegate requestComplete = nullptr);
 
+	/**
+	 * @brief Queue request to continue downloading a file
+	 * @param url Source of file data
+	 * @param saveFileName Path to file, which is created if it doesn't exist.
+	 * Specify nullptr to use name from url.
+	 * @param validator ETag or Last-Modified value for the existing file content, if known.
+	 * Use `HttpRequest::getRangeValidator()` from the completion callback of an earlier download to obtain it.
+	 * @param requestComplete Completion callback
+	 *
+	 * Only the content following that already in the file is requested.
+	 * If the server sends the full content instead, the file is replaced.
+	 */
+	bool resumeDownload(const Url& url, const String& saveFileName, const String& validator = nullptr,
+						RequestCompletedDelegate requestComplete = nullptr);
+
 	/* Low Level Methods */
 
 	/*
@@ -123,22 +139,21 @@ public:
 	 */
 	static void cleanup()
 	{
-		httpConnectionPool.clear();
+		connectionPool.clear();
 	}
 
-protected:
-	String getCacheKey(const Url& url)
+	/**
+	 * @brief Get the pool of connections shared by all HttpClient instances
+	 *
+	 * Use this to change limits or inspect statistics.
+	 */
+	static HttpClientPool& getConnectionPool()
 	{
-		return url.Host + ':' + url.getPort();
+		return connectionPool;
 	}
 
 protected:
-	using HttpConnectionPool = ObjectMap<String, HttpClientConnection>;
-	static HttpConnectionPool httpConnectionPool;
-
-private:
-	static SimpleTimer cleanUpTimer;
-	static void cleanInactive();
+	static HttpClientPool connectionPool;
 };
 
 /** @} */
@@ -16,6 +16,20 @@
 #include "Data/Stream/LimitedMemoryStream.h"
 #include "Data/Stream/ChunkedStream.h"
 #include "Data/Stream/UrlencodedOutputStream.h"
+#include "HttpRange.h"
+
+namespace
+{
+/*
+ * Get validator to use in If-Range header, which must be strong (RFC 7233 3.2)
+ */
+const String& getRangeValidator(const HttpHeaders& headers)
+{
+	auto& etag = headers[HTTP_HEADER_ETAG];
+	return etag.startsWith(_F("\"")) ? etag : headers[HTTP_HEADER_LAST_MODIFIED];
+}
+
+} // namespace
 
 bool HttpClientConnection::connect(const String& host, int port, bool useSsl)
 {
@@ -41,6 +55,7 @@ bool HttpClientConnection::connect(const String& host, int port, bool useSsl)
 
 bool HttpClientConnection::send(HttpRequest* request)
 {
+	request->queueTime = millis();
 	if(!waitingQueue.enqueue(request)) {
 		// the queue is full and we cannot add more requests at the time.
 		debug_e("HCC::send: The request queue is full at the moment");
@@ -55,6 +70,7 @@ bool HttpClientConnection::send(HttpRequest* request)
 void HttpClientConnection::reset()
 {
 	incomingRequest = nullptr;
+	decoder.reset();
 
 	response.reset();
 
@@ -115,11 +131,19 @@ int HttpClientConnection::onMessageComplete(http_parser* parser)
 	debug_d("HCC::onMessageComplete: executionQueue: %d, %s", executionQueue.count(),
 			incomingRequest->uri.toString().c_str());
 
+	// Output any remaining decoded content
+	int decodeError = 0;
+	if(decoder) {
+		decodeError = decoder->finish();
+		decoder.reset();
+	}
+
 	// we are finished with this request
 	int hasError = 0;
 	if(incomingRequest->requestCompletedDelegate) {
-		bool success = (HTTP_PARSER_ERRNO(parser) == HPE_OK) && // false when the parsing has failed
-					   (response.isSuccess());					// false when the HTTP status code is not ok
+		bool success = (HTTP_PARSER_ERRNO(parser) == HPE_OK) &&	   // false when the parsing has failed
+					   (response.isSuccess() || isRangeComplete()) && // false when the HTTP status code is not ok
+					   (decodeError == 0);							   // false when compressed content is invalid
 		hasError = incomingRequest->requestCompletedDelegate(*this, success);
 	}
 
@@ -139,7 +163,8 @@ int HttpClientConnection::onMessageComplete(http_parser* parser)
 
 	const String& headerConnection = static_cast<const HttpHeaders&>(response->headers)[HTTP_HEADER_CONNECTION];
 	if(headerConnection.equalsIgnoreCase(_F("close"))) {
-		allowPipe = false;
+		pipelineDepth = 1;
+		pipelineResponseCount = 0;
 		// if the server does not support keep-alive -> close the connection
 		// see: https://tools.ietf.org/html/rfc2616#section-14.10
 		debug_d("HCC::onMessageComplete: Closing as requested by server");
@@ -149,7 +174,19 @@ int HttpClientConnection::onMessageComplete(http_parser* parser)
 		return hasError;
 	}
 
-	allowPipe = true; // if the server supports keep-alive then it would most probably support also pipelining...
+	// If the server supports keep-alive then it would most probably support also pipelining...
+	// Increase depth gradually so a server which does not is detected before many requests are outstanding
+	if(pipelineDepth < pipelineLimit) {
+		if(++pipelineResponseCount >= pipelineDepth) {
+			++pipelineDepth;
+			pipelineResponseCount = 0;
+		}
+	} else if(pipelineLimit < maxPipelineDepth && ++pipelineResponseCount >= HTTP_CLIENT_PIPELINE_RECOVERY) {
+		// Limit was reduced after a failure, but the server has since been reliable so try a little deeper
+		++pipelineLimit;
+		pipelineResponseCount = 0;
+		debug_d("HCC::onMessageComplete: Raising pipeline limit to %u", pipelineLimit);
+	}
 
 	if(executionQueue.count() == 0) {
 		onConnected(ERR_OK);
@@ -204,11 +241,96 @@ int HttpClientConnection::onHeadersComplete(const HttpHeaders& headers)
 		} else {
 			response.setBuffer(new LimitedMemoryStream(NETWORK_SEND_BUFFER_SIZE));
 		}
+
+		if(incomingRequest->resumable) {
+			error = checkRange();
+		}
+
+		decoder.reset();
+		HttpContentDecoder::Format format;
+		auto& encoding = static_cast<const HttpHeaders&>(response.headers)[HTTP_HEADER_CONTENT_ENCODING];
+		if(incomingRequest->contentDecoding && !incomingRequest->resumable &&
+		   HttpContentDecoder::getFormat(encoding, format)) {
+			decoder.reset(
+				new HttpContentDecoder(format, HttpContentDecoder::Callback(&HttpClientConnection::writeBody, this)));
+		}
 	}
 
 	return error;
 }
 
+int HttpClientConnection::checkRange()
+{
+	auto& request = *incomingRequest;
+	auto& headers = static_cast<const HttpHeaders&>(response.headers);
+
+	switch(response.code) {
+	case HTTP_STATUS_PARTIAL_CONTENT: {
+		// Must follow on from existing content
+		HttpRange range;
+		if(request.rangeOffset == 0 || !HttpRange::parseContentRange(headers[HTTP_HEADER_CONTENT_RANGE], range) ||
+		   range.start != request.rangeOffset) {
+			debug_w("[HTTP] Unexpected Content-Range '%s'", headers[HTTP_HEADER_CONTENT_RANGE].c_str());
+			return -1;
+		}
+		if(!request.rangeValidator) {
+			request.rangeValidator = getRangeValidator(headers);
+		}
+		return 0;
+	}
+
+	case HTTP_STATUS_OK: {
+		// Validator is used if the request has to be sent again
+		request.rangeValidator = getRangeValidator(headers);
+
+		if(request.rangeOffset == 0) {
+			return 0;
+		}
+
+		// Range was ignored or content has changed, so start again
+		debug_i("[HTTP] Server sent full content, discarding %u bytes", request.rangeOffset);
+		request.rangeOffset = 0;
+		auto file = (response.buffer != nullptr && response.buffer->getStreamType() == eSST_File)
+						? static_cast<IFS::FileStream*>(response.buffer)
+						: nullptr;
+		if(file == nullptr || !file->truncate(0) || file->seekFrom(0, SeekOrigin::Start) != 0) {
+			debug_w("[HTTP] Cannot discard existing content");
+			return -1;
+		}
+		return 0;
+	}
+
+	case HTTP_STATUS_RANGE_NOT_SATISFIABLE:
+		if(isRangeComplete()) {
+			debug_i("[HTTP] Already have all %u bytes of content", request.rangeOffset);
+		}
+		[[fallthrough]];
+
+	default:
+		// Leave existing content alone, and don't try to resume if the request is resent
+		request.resumable = false;
+		response.freeStreams();
+		response.setBuffer(new LimitedMemoryStream(NETWORK_SEND_BUFFER_SIZE));
+		return 0;
+	}
+}
+
+/*
+ * A range starting at the end of the content gets a 416 response.
+ * That's fine if we've already got all of it.
+ */
+bool HttpClientConnection::isRangeComplete() const
+{
+	if(incomingRequest == nullptr || incomingRequest->rangeOffset == 0 ||
+	   response.code != HTTP_STATUS_RANGE_NOT_SATISFIABLE) {
+		return false;
+	}
+	uint32_t size;
+	auto& headers = static_cast<const HttpHeaders&>(response.headers);
+	return HttpRange::parseUnsatisfiedRange(headers[HTTP_HEADER_CONTENT_RANGE], size) &&
+		   size == incomingRequest->rangeOffset;
+}
+
 int HttpClientConnection::onBody(const char* at, size_t length)
 {
 	if(incomingRequest == nullptr) {
@@ -216,6 +338,15 @@ int HttpClientConnection::onBody(const char* at, size_t length)
 		return 1;
 	}
 
+	if(decoder) {
+		return decoder->decode(at, length);
+	}
+
+	return writeBody(at, length);
+}
+
+int HttpClientConnection::writeBody(const char* at, size_t length)
+{
 	if(incomingRequest->requestBodyDelegate) {
 		return incomingRequest->requestBodyDelegate(*this, at, length);
 	}
@@ -249,17 +380,15 @@ REENTER:
 
 		// if the executionQueue is not empty then we have to check if we can pipeline that request
 		if(executionQueue.count() != 0) {
-			if(!(allowPipe && (request->method == HTTP_GET || request->method == HTTP_HEAD))) {
+			if(executionQueue.count() >= pipelineDepth || !canPipeline(request->method)) {
 				// if the current request cannot be pipelined -> break;
 				break;
 			}
 
 			// if we have previous request
-			if(outgoingRequest != nullptr) {
-				if(!(outgoingRequest->method == HTTP_GET || outgoingRequest->method == HTTP_HEAD)) {
-					// the outgoing request does not allow pipelining
-					break;
-				}
+			if(outgoingRequest != nullptr && !canPipeline(outgoingRequest->method)) {
+				// the outgoing request does not allow pipelining
+				break;
 			}
 		} // executionQueue.count()
 
@@ -269,6 +398,7 @@ REENTER:
 		}
 
 		waitingQueue.dequeue();
+		onRequestStarted(millis() - request->queueTime);
 
 		outgoingRequest = request;
 		sendRequestHeaders(request);
@@ -336,6 +466,17 @@ void HttpClientConnection::sendRequestHeaders(HttpRequest* request)
 		request->headers[HTTP_HEADER_HOST] = request->uri.getHostWithPort();
 	}
 
+	if(request->resumable) {
+		setRangeHeaders(*request);
+	} else if(request->contentDecoding && !request->headers.contains(HTTP_HEADER_ACCEPT_ENCODING)) {
+		// Don't ask for compressed content we probably can't decode
+		if(HttpContentDecoder::isMemoryAvailable()) {
+			request->headers[HTTP_HEADER_ACCEPT_ENCODING] = HttpContentDecoder::getAcceptEncoding();
+		} else {
+			debug_w("[HTTP] Not enough memory to decode content, compression not requested");
+		}
+	}
+
 	request->headers[HTTP_HEADER_CONTENT_LENGTH] = "0";
 	if(request->files.count()) {
 		auto mStream = new MultipartStream(MultipartStream::Producer(&HttpClientConnection::multipartProducer, this));
@@ -377,6 +518,29 @@ void HttpClientConnection::sendRequestHeaders(HttpRequest* request)
 	sendString("\r\n");
 }
 
+void HttpClientConnection::setRangeHeaders(HttpRequest& request)
+{
+	request.headers.remove(HTTP_HEADER_RANGE);
+	request.headers.remove(HTTP_HEADER_IF_RANGE);
+	request.rangeOffset = 0;
+
+	// Writes are appended, so the end of the stream is where we continue from
+	auto stream = request.responseStream;
+	int size = (stream == nullptr) ? -1 : stream->seekFrom(0, SeekOrigin::End);
+	if(size <= 0) {
+		return;
+	}
+
+	request.rangeOffset = size;
+	String s = F("bytes=");
+	s += size;
+	s += '-';
+	request.headers[HTTP_HEADER_RANGE] = s;
+	if(request.rangeValidator) {
+		request.headers[HTTP_HEADER_IF_RANGE] = request.rangeValidator;
+	}
+}
+
 bool HttpClientConnection::sendRequestBody(HttpRequest* request)
 {
 	if(state == eHCS_StartBody) {
@@ -412,10 +576,57 @@ bool HttpClientConnection::sendRequestBody(HttpRequest* request)
 
 void HttpClientConnection::cleanup()
 {
+	// Keep content received so far so a resumable request continues from there when resent
+	if(incomingRequest != nullptr && incomingRequest->resumable && incomingRequest->responseStream == nullptr &&
+	   response.buffer != nullptr && response.buffer == response.stream) {
+		incomingRequest->responseStream = response.buffer;
+		response.buffer = nullptr;
+		response.stream = nullptr;
+	}
+
 	reset();
 
+	if(executionQueue.count() > 1) {
+		// Pipelined requests were lost, so server may not handle them properly
+		pipelineLimit = std::max(pipelineDepth / 2, 1);
+		debug_w("HCC::cleanup: %u pipelined requests lost, limiting depth to %u", executionQueue.count(),
+				pipelineLimit);
+	}
+	pipelineDepth = 1;
+	pipelineResponseCount = 0;
+
 	// if there are requests in the executionQueue -> move them back to the waiting queue
 	while(executionQueue.count() != 0) {
-		waitingQueue.enqueue(executionQueue.dequeue());
+		auto request = executionQueue.peek();
+		if(canResend(*request)) {
+			++request->resendCount;
+			waitingQueue.enqueue(executionQueue.dequeue());
+			continue;
+		}
+
+		// Not safe to send again, so fail it. Request stays queued until callback returns.
+		debug_w("HCC::cleanup: Request failed: %s", request->uri.toString().c_str());
+		if(request->requestCompletedDelegate) {
+			request->requestCompletedDelegate(*this, false);
+		}
+		delete executionQueue.dequeue();
+	}
+}
+
+bool HttpClientConnection::canResend(const HttpRequest& request)
+{
+	if(request.resendCount >= HTTP_CLIENT_MAX_RESEND) {
+		return false;
+	}
+
+	// Only methods without side-effects, and which don't have a body stream (which has been consumed)
+	switch(request.method) {
+	case HTTP_GET:
+	case HTTP_HEAD:
+	case HTTP_OPTIONS:
+	case HTTP_TRACE:
+		return true;
+	default:
+		return false;
 	}
 }
@@ -14,8 +14,10 @@
 
 #include "HttpConnection.h"
 #include "DateTime.h"
+#include <Clock.h>
 #include "Data/ObjectQueue.h"
 #include <Data/Stream/MultipartStream.h>
+#include "HttpContentDecoder.h"
 
 /**
  *  @brief      Provides http client connection
@@ -23,6 +25,21 @@
  *  @{
  */
 
+/* Maximum number of requests in flight on a client connection. Set to 1 to disable pipelining. */
+#ifndef HTTP_CLIENT_PIPELINE_DEPTH
+#define HTTP_CLIENT_PIPELINE_DEPTH 4
+#endif
+
+/* Successful responses needed to raise a pipeline limit which was reduced after a failure */
+#ifndef HTTP_CLIENT_PIPELINE_RECOVERY
+#define HTTP_CLIENT_PIPELINE_RECOVERY 32
+#endif
+
+/* Number of times a safe request (GET, HEAD, etc.) is resent if its connection fails */
+#ifndef HTTP_CLIENT_MAX_RESEND
+#define HTTP_CLIENT_MAX_RESEND 2
+#endif
+
 using RequestQueue = ObjectQueue<HttpRequest, HTTP_REQUEST_POOL_SIZE>;
 
 class HttpClientConnection : public HttpConnection
@@ -34,9 +51,17 @@ public:
 
 	~HttpClientConnection()
 	{
-		cleanup();
+		// Requests in progress are about to be freed, so cleanup() must not see them
+		incomingRequest = nullptr;
+		outgoingRequest = nullptr;
 
 		// Free any outstanding queued requests
+		while(executionQueue.count() != 0) {
+			delete executionQueue.dequeue();
+		}
+
+		cleanup();
+
 		while(waitingQueue.count() != 0) {
 			delete waitingQueue.dequeue();
 		}
@@ -58,6 +83,38 @@ public:
 		return (waitingQueue.count() + executionQueue.count() == 0);
 	}
 
+	/**
+	 * @brief Set maximum number of requests to pipeline on this connection
+	 * @param depth Use 1 to disable pipelining
+	 *
+	 * Pipelining is only used for GET and HEAD requests, once the server has responded with keep-alive.
+	 * The depth starts at 1 and increases as responses are received, up to this limit.
+	 * If the connection fails with pipelined requests outstanding then the limit is halved.
+	 * It rises again by one after each HTTP_CLIENT_PIPELINE_RECOVERY successful responses.
+	 */
+	void setMaxPipelineDepth(uint8_t depth)
+	{
+		maxPipelineDepth = std::max(depth, uint8_t(1));
+		pipelineLimit = maxPipelineDepth;
+		pipelineDepth = std::min(pipelineDepth, pipelineLimit);
+	}
+
+	/**
+	 * @brief Get number of requests currently allowed in flight
+	 */
+	uint8_t getPipelineDepth() const
+	{
+		return pipelineDepth;
+	}
+
+	/**
+	 * @brief Get number of requests waiting or in progress
+	 */
+	unsigned getRequestCount() const
+	{
+		return waitingQueue.count() + executionQueue.count();
+	}
+
 protected:
 	// HTTP parser methods
 
@@ -82,6 +139,14 @@ protected:
 		}
 	}
 
+	/**
+	 * @brief Called when a request is taken from the waiting queue and sent
+	 * @param waitTime How long the request was queued, in milliseconds
+	 */
+	virtual void onRequestStarted([[maybe_unused]] uint32_t waitTime)
+	{
+	}
+
 	err_t onConnected(err_t err) override
 	{
 		if(err == ERR_OK) {
@@ -93,8 +158,19 @@ protected:
 	}
 
 private:
+	static bool canPipeline(HttpMethod method)
+	{
+		return method == HTTP_GET || method == HTTP_HEAD;
+	}
+
+	static bool canResend(const HttpRequest& request);
+
 	void sendRequestHeaders(HttpRequest* request);
 	bool sendRequestBody(HttpRequest* request);
+	int writeBody(const char* at, size_t length);
+	int checkRange();
+	bool isRangeComplete() const;
+	static void setRangeHeaders(HttpRequest& request);
 	MultipartStream::BodyPart multipartProducer();
 
 private:
@@ -103,8 +179,12 @@ private:
 
 	HttpRequest* incomingRequest = nullptr;
 	HttpRequest* outgoingRequest = nullptr;
+	std::unique_ptr<HttpContentDecoder> decoder; ///< Set whilst receiving compressed content
 
-	bool allowPipe = false; /// < Flag to specify if HTTP pipelining is allowed for this connection
+	uint8_t maxPipelineDepth{HTTP_CLIENT_PIPELINE_DEPTH}; ///< Configured limit
+	uint8_t pipelineLimit{HTTP_CLIENT_PIPELINE_DEPTH};	  ///< Limit, reduced if pipelining fails
+	uint8_t pipelineDepth{1};							  ///< Number of requests currently allowed in flight
+	uint8_t pipelineResponseCount{0};					  ///< Responses received since depth or limit last increased
 };
 
 /** @} */
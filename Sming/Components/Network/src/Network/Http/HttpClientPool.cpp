@@ -0,0 +1,164 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * HttpClientPool.cpp
+ *
+ ****/
+
+#include "HttpClientPool.h"
+
+void HttpClientPool::Connection::onRequestStarted(uint32_t waitTime)
+{
+	auto& stats = pool.stats;
+	++stats.started;
+	stats.totalWaitTime += waitTime;
+	if(waitTime > stats.maxWaitTime) {
+		stats.maxWaitTime = waitTime;
+	}
+	touch();
+}
+
+int HttpClientPool::Connection::onMessageComplete(http_parser* parser)
+{
+	int err = HttpClientConnection::onMessageComplete(parser);
+	touch();
+	return err;
+}
+
+bool HttpClientPool::send(HttpRequest* request)
+{
+	String key = getKey(request->uri);
+
+	// Find least busy connection to this host
+	Connection* connection = nullptr;
+	unsigned hostCount = 0;
+	for(auto& c : connections) {
+		if(c.key != key) {
+			continue;
+		}
+		++hostCount;
+		if(connection == nullptr || c.getRequestCount() < connection->getRequestCount()) {
+			connection = &c;
+		}
+	}
+
+	// Open another connection if all existing ones are busy
+	if((connection == nullptr || !connection->isFinished()) && hostCount < settings.maxPerHost) {
+		bool canOpen = connections.count() < settings.maxConnections;
+		if(!canOpen) {
+			auto lru = findLeastRecentlyUsedIdle();
+			if(lru != nullptr) {
+				debug_d("[HTTP] Closing idle connection to %s", lru->key.c_str());
+				connections.remove(lru);
+				++stats.evicted;
+				canOpen = true;
+			}
+		}
+		if(canOpen) {
+			debug_d("[HTTP] New connection to %s", key.c_str());
+			auto newConnection = new Connection(*this, key);
+			if(newConnection != nullptr) {
+				newConnection->setMaxPipelineDepth(settings.maxPipelineDepth);
+				connections.add(newConnection);
+				++stats.created;
+				connection = newConnection;
+			}
+		}
+	}
+
+	if(connection == nullptr) {
+		debug_e("[HTTP] Connection pool full, request to %s rejected", key.c_str());
+		++stats.rejected;
+		delete request;
+		return false;
+	}
+
+	if(connection->isProcessing()) {
+		++stats.reused;
+	}
+
+	startTimer();
+	connection->touch();
+	return connection->send(request);
+}
+
+HttpClientPool::Connection* HttpClientPool::findLeastRecentlyUsedIdle()
+{
+	Connection* lru = nullptr;
+	for(auto& c : connections) {
+		if(c.isFinished() && (lru == nullptr || c.getIdleTime() > lru->getIdleTime())) {
+			lru = &c;
+		}
+	}
+	return lru;
+}
+
+size_t HttpClientPool::count(const Url& url) const
+{
+	String key = getKey(url);
+	return std::count_if(connections.begin(), connections.end(), [&](const Connection& c) { return c.key == key; });
+}
+
+void HttpClientPool::setSettings(const Settings& settings)
+{
+	this->settings = settings;
+	for(auto& c : connections) {
+		c.setMaxPipelineDepth(settings.maxPipelineDepth);
+	}
+	if(cleanUpTimer.isStarted()) {
+		cleanUpTimer.stop();
+		startTimer();
+	}
+}
+
+void HttpClientPool::startTimer()
+{
+	if(cleanUpTimer.isStarted()) {
+		return;
+	}
+	// Check often enough that connections are closed reasonably close to their timeout
+	unsigned interval = std::max(settings.idleTimeout / 4, 1);
+	cleanUpTimer
+		.initializeMs(
+			interval * 1000, [](void* arg) { static_cast<HttpClientPool*>(arg)->cleanInactive(); }, this)
+		.start();
+}
+
+void HttpClientPool::cleanInactive()
+{
+	debug_d("[HTTP] Total connections: %u", connections.count());
+
+	auto idleTimeout = settings.idleTimeout * 1000U;
+	for(auto it = connections.begin(); it != connections.end();) {
+		auto& connection = *it;
+		++it;
+
+		bool dead = connection.getConnectionState() > eTCS_Connecting && !connection.isActive();
+		bool expired = connection.isFinished() && connection.getIdleTime() >= idleTimeout;
+		if(dead || expired) {
+			debug_d("[HTTP] Removing %s connection to %s: State: %d, Active: %d, Finished: %d",
+					dead ? "stale" : "idle", connection.key.c_str(), connection.getConnectionState(),
+					connection.isActive(), connection.isFinished());
+			connections.remove(&connection);
+			++stats.evicted;
+		}
+	}
+
+	if(connections.isEmpty()) {
+		cleanUpTimer.stop();
+	}
+}
+
+void HttpClientPool::printStats(Print& p) const
+{
+	p << _F("HTTP client connections: ") << connections.count() << _F(", created ") << stats.created
+	  << _F(", reused ") << stats.reused << _F(", evicted ") << stats.evicted << _F(", rejected ") << stats.rejected
+	  << endl;
+	if(stats.started != 0) {
+		p << _F("  Queue wait: average ") << stats.totalWaitTime / stats.started << _F(" ms, max ")
+		  << stats.maxWaitTime << _F(" ms") << endl;
+	}
+}
@@ -0,0 +1,171 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * HttpClientPool.h
+ *
+ ****/
+
+#pragma once
+
+#include "HttpClientConnection.h"
+#include <Data/LinkedObjectList.h>
+#include <SimpleTimer.h>
+#include <Print.h>
+
+/* Maximum number of connections HttpClient keeps open */
+#ifndef HTTP_CLIENT_MAX_CONNECTIONS
+#define HTTP_CLIENT_MAX_CONNECTIONS 4
+#endif
+
+/* Maximum number of parallel connections to the same host */
+#ifndef HTTP_CLIENT_MAX_CONNECTIONS_PER_HOST
+#define HTTP_CLIENT_MAX_CONNECTIONS_PER_HOST 2
+#endif
+
+/* Seconds after which an idle connection is closed */
+#ifndef HTTP_CLIENT_IDLE_TIMEOUT
+#define HTTP_CLIENT_IDLE_TIMEOUT 60
+#endif
+
+/**
+ * @brief Bounded pool of client connections shared by all HttpClient instances
+ * @ingroup httpclient
+ *
+ * Requests to the same host are spread over up to `maxPerHost` parallel connections.
+ * An idle connection is always preferred, otherwise a new one is opened if limits allow,
+ * otherwise the request is queued on the least busy connection to that host.
+ *
+ * When the pool is full, the least recently used idle connection is closed to make room.
+ * Connections left idle for longer than `idleTimeout` are closed automatically.
+ */
+class HttpClientPool
+{
+public:
+	struct Settings {
+		uint8_t maxConnections{HTTP_CLIENT_MAX_CONNECTIONS};	  ///< Total connection limit
+		uint8_t maxPerHost{HTTP_CLIENT_MAX_CONNECTIONS_PER_HOST}; ///< Limit for connections to any single host
+		uint16_t idleTimeout{HTTP_CLIENT_IDLE_TIMEOUT};			  ///< Seconds before idle connection is closed
+		uint8_t maxPipelineDepth{HTTP_CLIENT_PIPELINE_DEPTH};	  ///< Requests in flight per connection
+	};
+
+	struct Stats {
+		uint32_t created;		///< Connections opened
+		uint32_t reused;		///< Requests sent using an already-open connection
+		uint32_t evicted;		///< Connections closed because they were idle, dead or needed for another host
+		uint32_t rejected;		///< Requests failed because pool was full and host had no connection
+		uint32_t started;		///< Requests taken from a queue and sent
+		uint32_t totalWaitTime;	///< Total time requests spent queued, in milliseconds
+		uint32_t maxWaitTime;	///< Longest time any request spent queued, in milliseconds
+	};
+
+	~HttpClientPool()
+	{
+		clear();
+	}
+
+	/**
+	 * @brief Queue a request on a suitable connection
+	 * @param request Freed on failure
+	 * @retval bool true if request was queued
+	 */
+	bool send(HttpRequest* request);
+
+	/**
+	 * @brief Close all connections and discard any outstanding requests
+	 */
+	void clear()
+	{
+		cleanUpTimer.stop();
+		connections.clear();
+	}
+
+	/**
+	 * @brief Close connections which are dead or have been idle for longer than the configured timeout
+	 */
+	void cleanInactive();
+
+	/**
+	 * @brief Get number of open connections
+	 */
+	size_t count() const
+	{
+		return connections.count();
+	}
+
+	/**
+	 * @brief Get number of open connections to a specific host
+	 */
+	size_t count(const Url& url) const;
+
+	const Settings& getSettings() const
+	{
+		return settings;
+	}
+
+	/**
+	 * @brief Change pool limits
+	 * @note Existing connections are not closed if the new limits are lower,
+	 * but no new connections are opened until usage falls below them.
+	 */
+	void setSettings(const Settings& settings);
+
+	const Stats& getStats() const
+	{
+		return stats;
+	}
+
+	void resetStats()
+	{
+		stats = {};
+	}
+
+	void printStats(Print& p) const;
+
+private:
+	class Connection : public HttpClientConnection, public LinkedObjectTemplate<Connection>
+	{
+	public:
+		using OwnedList = OwnedLinkedObjectListTemplate<Connection>;
+
+		Connection(HttpClientPool& pool, const String& key) : pool(pool), key(key), lastActive(millis())
+		{
+		}
+
+		uint32_t getIdleTime() const
+		{
+			return millis() - lastActive;
+		}
+
+		void touch()
+		{
+			lastActive = millis();
+		}
+
+	protected:
+		void onRequestStarted(uint32_t waitTime) override;
+		int onMessageComplete(http_parser* parser) override;
+
+	public:
+		HttpClientPool& pool;
+		String key;	///< "host:port"
+
+	private:
+		uint32_t lastActive; ///< Time of last activity, in milliseconds
+	};
+
+	static String getKey(const Url& url)
+	{
+		return url.Host + ':' + url.getPort();
+	}
+
+	Connection* findLeastRecentlyUsedIdle();
+	void startTimer();
+
+	Connection::OwnedList connections;
+	SimpleTimer cleanUpTimer;
+	Settings settings;
+	Stats stats{};
+};
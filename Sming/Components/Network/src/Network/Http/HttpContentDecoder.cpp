@@ -0,0 +1,225 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * HttpContentDecoder.cpp
+ *
+ ****/
+
+#include "HttpContentDecoder.h"
+#include <uzlib.h>
+#include <debug_progmem.h>
+#include <esp_systemapi.h>
+
+namespace
+{
+constexpr size_t inputBufferSize{1024};
+constexpr size_t outputBufferSize{256};
+
+/*
+ * uzlib cannot suspend when it runs out of input, so we only decode whilst there is enough
+ * for the most it might read in one step: a dynamic block header (under 300 bytes) plus
+ * a length/distance pair, or a gzip trailer.
+ */
+constexpr size_t inputMargin{320};
+
+} // namespace
+
+struct HttpContentDecoder::Inflater {
+	uzlib_uncomp state{}; // Must be first, for readSource()
+	uint8_t* window{nullptr};
+	bool underrun{false};
+	uint16_t inputLength{0};
+	uint8_t input[inputBufferSize];
+	uint8_t output[outputBufferSize];
+
+	~Inflater()
+	{
+		delete[] window;
+	}
+
+	// Called by uzlib if it needs more data than we have
+	static int readSource(uzlib_uncomp* uncomp)
+	{
+		auto self = reinterpret_cast<Inflater*>(uncomp);
+		self->underrun = true;
+		return -1;
+	}
+};
+
+String HttpContentDecoder::getAcceptEncoding()
+{
+	return F("gzip, deflate");
+}
+
+size_t HttpContentDecoder::getMemoryRequired(uint8_t windowBits)
+{
+	return sizeof(HttpContentDecoder) + sizeof(Inflater) + (1U << windowBits);
+}
+
+bool HttpContentDecoder::isMemoryAvailable(uint8_t windowBits)
+{
+	return system_get_free_heap_size() >= getMemoryRequired(windowBits);
+}
+
+bool HttpContentDecoder::getFormat(const String& contentEncoding, Format& format)
+{
+	String s = contentEncoding;
+	s.trim();
+	if(s.equalsIgnoreCase(_F("gzip")) || s.equalsIgnoreCase(_F("x-gzip"))) {
+		format = Format::gzip;
+		return true;
+	}
+	if(s.equalsIgnoreCase(_F("deflate"))) {
+		format = Format::deflate;
+		return true;
+	}
+	return false;
+}
+
+HttpContentDecoder::HttpContentDecoder(Format format, Callback callback, uint8_t windowBits)
+	: inflater(new Inflater), callback(callback), format(format), windowBits(windowBits)
+{
+	static bool initialised;
+	if(!initialised) {
+		uzlib_init();
+		initialised = true;
+	}
+
+	if(inflater != nullptr) {
+		inflater->window = new uint8_t[1U << windowBits];
+	}
+	if(inflater == nullptr || inflater->window == nullptr) {
+		debug_e("[HTTP] Out of memory for content decoder");
+		status = TINF_DATA_ERROR;
+		return;
+	}
+
+	auto& d = inflater->state;
+	uzlib_uncompress_init(&d, inflater->window, 1U << windowBits);
+	d.source_read_cb = Inflater::readSource;
+}
+
+HttpContentDecoder::~HttpContentDecoder()
+{
+	delete inflater;
+}
+
+int HttpContentDecoder::decode(const char* data, size_t length)
+{
+	// Anything following the compressed data is ignored
+	while(status == 0 && !done && length != 0) {
+		auto& inf = *inflater;
+		size_t n = std::min(length, inputBufferSize - inf.inputLength);
+		memcpy(&inf.input[inf.inputLength], data, n);
+		inf.inputLength += n;
+		data += n;
+		length -= n;
+		status = process(false);
+	}
+
+	return status;
+}
+
+int HttpContentDecoder::finish()
+{
+	if(status == 0 && !done) {
+		status = process(true);
+		if(status == 0 && !done) {
+			debug_w("[HTTP] Compressed content is incomplete");
+			status = TINF_DATA_ERROR;
+		}
+	}
+
+	return status;
+}
+
+int HttpContentDecoder::process(bool final)
+{
+	auto& inf = *inflater;
+	auto& d = inf.state;
+	d.source = inf.input;
+	d.source_limit = inf.input + inf.inputLength;
+
+	int err = 0;
+	while(err == 0 && !done) {
+		size_t available = d.source_limit - d.source;
+		if(!final && available < inputMargin) {
+			break;
+		}
+
+		if(!headerDone) {
+			err = readHeader();
+			continue;
+		}
+
+		// Each output byte needs at most 2 bytes of input, once a length/distance pair has been read
+		size_t outputLength = outputBufferSize;
+		if(!final) {
+			outputLength = std::min(outputLength, std::max(size_t(1), (available - inputMargin) / 2));
+		}
+		d.dest = inf.output;
+		d.dest_limit = inf.output + outputLength;
+		int res = uzlib_uncompress_chksum(&d);
+		if(inf.underrun) {
+			res = TINF_DATA_ERROR;
+		}
+		if(res != TINF_OK && res != TINF_DONE) {
+			debug_w("[HTTP] Content decoding failed: %d", res);
+			err = res;
+			break;
+		}
+
+		size_t length = d.dest - inf.output;
+		if(length != 0 && callback) {
+			err = callback(reinterpret_cast<const char*>(inf.output), length);
+		}
+		done = (res == TINF_DONE);
+	}
+
+	// Keep unused input for next time
+	size_t remaining = d.source_limit - d.source;
+	memmove(inf.input, d.source, remaining);
+	inf.inputLength = remaining;
+
+	return err;
+}
+
+int HttpContentDecoder::readHeader()
+{
+	auto& d = inflater->state;
+	headerDone = true;
+
+	int res;
+	if(format == Format::gzip) {
+		res = uzlib_gzip_parse_header(&d);
+	} else {
+		// Some servers send raw deflate data instead of zlib format, so check for a valid zlib header
+		size_t available = d.source_limit - d.source;
+		if(available < 2) {
+			return 0;
+		}
+		uint8_t cmf = d.source[0];
+		uint8_t flg = d.source[1];
+		if((cmf & 0x0f) != 8 || ((cmf << 8) | flg) % 31 != 0) {
+			return 0;
+		}
+		if((cmf >> 4) + 8 > windowBits) {
+			debug_w("[HTTP] Content uses %u-bit window, limit is %u", (cmf >> 4) + 8, windowBits);
+			return TINF_DICT_ERROR;
+		}
+		res = uzlib_zlib_parse_header(&d);
+	}
+
+	if(inflater->underrun) {
+		res = TINF_DATA_ERROR;
+	}
+	if(res < 0) {
+		debug_w("[HTTP] Invalid compressed content header: %d", res);
+		return res;
+	}
+
+	return 0;
+}
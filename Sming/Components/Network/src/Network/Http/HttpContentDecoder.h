@@ -0,0 +1,98 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * HttpContentDecoder.h
+ *
+ ****/
+
+#pragma once
+
+#include <WString.h>
+#include <Delegate.h>
+
+/* Largest deflate window accepted, as a power of 2. The window buffer is allocated whilst decoding a response,
+ * so decoding is only enabled on request. */
+#ifndef HTTP_CLIENT_DECODE_WINDOW_BITS
+#define HTTP_CLIENT_DECODE_WINDOW_BITS 15
+#endif
+
+/**
+ * @brief Streaming decoder for gzip and deflate content encodings, using uzlib
+ * @ingroup httpclient
+ *
+ * Compressed data may be passed in blocks of any size. Decoded output is passed to the callback
+ * in blocks of up to 256 bytes.
+ *
+ * Memory use is fixed: a window buffer of 2^windowBits bytes plus about 3K of working state.
+ * Content compressed with a larger window than this cannot be decoded, and fails with TINF_DICT_ERROR.
+ */
+class HttpContentDecoder
+{
+public:
+	/**
+	 * @brief Called with decoded data
+	 * @retval int Return non-zero to stop decoding
+	 */
+	using Callback = Delegate<int(const char* data, size_t length)>;
+
+	enum class Format {
+		gzip,	 ///< RFC 1952
+		deflate, ///< RFC 1950 zlib format, or raw RFC 1951 data as sent by some servers
+	};
+
+	/**
+	 * @brief Get the value for an Accept-Encoding request header listing supported encodings
+	 */
+	static String getAcceptEncoding();
+
+	/**
+	 * @brief Get the amount of memory allocated by a decoder
+	 */
+	static size_t getMemoryRequired(uint8_t windowBits = HTTP_CLIENT_DECODE_WINDOW_BITS);
+
+	/**
+	 * @brief Determine whether there is currently enough free heap to create a decoder
+	 * @note Fragmentation may still cause allocation to fail
+	 */
+	static bool isMemoryAvailable(uint8_t windowBits = HTTP_CLIENT_DECODE_WINDOW_BITS);
+
+	/**
+	 * @brief Determine format from the value of a Content-Encoding header
+	 * @retval bool false if encoding is not supported
+	 */
+	static bool getFormat(const String& contentEncoding, Format& format);
+
+	HttpContentDecoder(Format format, Callback callback, uint8_t windowBits = HTTP_CLIENT_DECODE_WINDOW_BITS);
+
+	~HttpContentDecoder();
+
+	/**
+	 * @brief Decode a block of content
+	 * @retval int 0 on success, negative uzlib error code, or non-zero value returned from callback
+	 */
+	int decode(const char* data, size_t length);
+
+	/**
+	 * @brief Call at end of content to decode any remaining data
+	 * @retval int 0 on success, error code as for `decode()`
+	 * @note Fails with TINF_DATA_ERROR if content is incomplete
+	 */
+	int finish();
+
+private:
+	struct Inflater;
+
+	int process(bool final);
+	int readHeader();
+
+	Inflater* inflater;
+	Callback callback;
+	Format format;
+	uint8_t windowBits;
+	int status{0};
+	bool headerDone{false};
+	bool done{false};
+};
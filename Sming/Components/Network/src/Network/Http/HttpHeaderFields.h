@@ -35,6 +35,7 @@
 #define HTTP_HEADER_FIELDNAME_MAP(XX)                                                                                  \
 	XX(ACCEPT, "Accept", 0, "Limit acceptable response types")                                                         \
 	XX(ACCEPT_ENCODING, "Accept-Encoding", 0, "Limit acceptable content encoding types")                               \
+	XX(ACCEPT_RANGES, "Accept-Ranges", 0, "Indicates server supports range requests")                                  \
 	XX(ACCESS_CONTROL_ALLOW_ORIGIN, "Access-Control-Allow-Origin", 0, "")                                              \
 	XX(AUTHORIZATION, "Authorization", 0, "Basic user agent authentication")                                           \
 	XX(CC, "Cc", 0, "email field")                                                                                     \
@@ -42,6 +43,7 @@
 	XX(CONTENT_DISPOSITION, "Content-Disposition", 0, "Additional information about how to process response payload")  \
 	XX(CONTENT_ENCODING, "Content-Encoding", 0, "Applied encodings in addition to content type")                       \
 	XX(CONTENT_LENGTH, "Content-Length", 0, "Anticipated size for payload when not using transfer encoding")           \
+	XX(CONTENT_RANGE, "Content-Range", 0, "Position of partial content within full representation")                    \
 	XX(CONTENT_TYPE, "Content-Type", 0,                                                                                \
 	   "Payload media type indicating both data format and intended manner of processing by recipient")                \
 	XX(CONTENT_TRANSFER_ENCODING, "Content-Transfer-Encoding", 0, "Coding method used in a MIME message body part")    \
@@ -59,14 +61,18 @@
 	   "Precondition check using ETag to avoid accidental overwrites when servicing multiple user requests. Ensures "  \
 	   "resource entity tag matches before proceeding.")                                                               \
 	XX(IF_MODIFIED_SINCE, "If-Modified-Since", 0, "Precondition check using Date")                                     \
+	XX(IF_RANGE, "If-Range", 0, "Precondition for Range request using ETag or Date")                                   \
 	XX(LAST_MODIFIED, "Last-Modified", 0, "Server timestamp indicating date and time resource was last modified")      \
 	XX(LOCATION, "Location", 0, "Used in redirect responses, amongst other places")                                    \
+	XX(RANGE, "Range", 0, "Request only part of a representation")                                                     \
 	XX(SEC_WEBSOCKET_ACCEPT, "Sec-WebSocket-Accept", 0, "Server response to opening Websocket handshake")              \
 	XX(SEC_WEBSOCKET_VERSION, "Sec-WebSocket-Version", 0,                                                              \
 	   "Websocket opening request indicates acceptable protocol version. Can appear more than once.")                  \
 	XX(SEC_WEBSOCKET_KEY, "Sec-WebSocket-Key", 0, "Websocket opening request validation key")                          \
 	XX(SEC_WEBSOCKET_PROTOCOL, "Sec-WebSocket-Protocol", 0,                                                            \
 	   "Websocket opening request indicates supported protocol(s), response contains negotiated protocol(s)")          \
+	XX(SEC_WEBSOCKET_EXTENSIONS, "Sec-WebSocket-Extensions", 0,                                                        \
+	   "Websocket opening request offers extensions, response contains accepted extension(s)")                         \
 	XX(SERVER, "Server", 0, "Identifies software handling requests")                                                   \
 	XX(SET_COOKIE, "Set-Cookie", Flag::Multi,                                                                          \
 	   "Server may pass name/value pairs and associated metadata to user agent (client)")                              \
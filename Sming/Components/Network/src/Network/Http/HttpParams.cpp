@@ -13,10 +13,7 @@
 #include "HttpParams.h"
 #include <Data/WebHelpers/escape.h>
 #include "Print.h"
-#include "libyuarel/yuarel.h"
-
-// Set a reasonable limit on the number of expected parameters in a query string
-static const unsigned MAX_PARAMS = 16;
+#include "HttpParamsView.h"
 
 void HttpParams::parseQuery(char* query)
 {
@@ -25,25 +22,14 @@ void HttpParams::parseQuery(char* query)
 	if(query == nullptr) {
 		return;
 	}
-	// Accept query strings with or without '?' prefix
-	if(*query == '?') {
-		++query;
-	}
-
-	struct yuarel_param params[MAX_PARAMS];
-	int paramCount = yuarel_parse_query(query, '&', params, MAX_PARAMS);
-	if(paramCount <= 0) {
-		return;
-	}
 
-	if(!allocate(paramCount)) {
+	HttpParamsView params(query, strlen(query));
+	if(!allocate(params.count())) {
 		return;
 	}
 
-	for(int i = 0; i < paramCount; ++i) {
-		String key = uri_unescape_inplace(params[i].key);
-		String value = uri_unescape_inplace(params[i].val);
-		operator[](key) = value;
+	for(auto& param : params) {
+		operator[](param.getName()) = param.getValue();
 	}
 }
 
@@ -28,10 +28,14 @@
  *  @todo values stored in escaped form, unescape return value and escape provided values.
  *  Revise HttpBodyParser.cpp as it will no longer do this job.
  *
+ * Parameters are stored inline for typical queries, so no heap allocation is required
+ * beyond the String content itself. The cost is a larger object: on the ESP8266 this adds
+ * about 96 bytes of RAM to every instance, including each Url.
+ *
  * @ingroup http
  *
  */
-class HttpParams : public HashMap<String, String>
+class HttpParams : public SmallMap<String, String, 4>
 {
 public:
 	HttpParams() = default;
@@ -48,8 +52,7 @@ public:
 
 	/** @brief Called from URL class to process query section of a URI
 	 *  @param query extracted from URI, with or without '?' prefix
-	 *  @retval bool true on success, false if parsing failed
-	 *  @note query string is modified by this call
+	 *  @note Use `HttpParamsView` to read parameters without copying them
 	 */
 	void parseQuery(char* query);
 
@@ -0,0 +1,116 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * HttpParamsView.cpp
+ *
+ ****/
+
+#include "HttpParamsView.h"
+#include <Data/WebHelpers/escape.h>
+#include <stringutil.h>
+#include <cctype>
+
+namespace
+{
+String unescape(const char* text, size_t length)
+{
+	String s(text, length);
+	if(s) {
+		s.setLength(uri_unescape_inplace(s.begin(), length));
+	}
+	return s;
+}
+
+} // namespace
+
+String HttpParamsView::Param::getName() const
+{
+	return unescape(name, nameLength);
+}
+
+String HttpParamsView::Param::getValue() const
+{
+	return unescape(value, valueLength);
+}
+
+bool HttpParamsView::Param::nameEquals(const char* str, size_t length) const
+{
+	auto src = name;
+	auto end = name + nameLength;
+	for(; src < end; --length, ++str) {
+		if(length == 0) {
+			return false;
+		}
+		char c = *src++;
+		if(c == '+') {
+			c = ' ';
+		} else if(c == '%' && end - src >= 2 && isxdigit(uint8_t(src[0])) && isxdigit(uint8_t(src[1]))) {
+			c = char((unhex(src[0]) << 4) | unhex(src[1]));
+			src += 2;
+		}
+		if(c != *str) {
+			return false;
+		}
+	}
+	return length == 0;
+}
+
+void HttpParamsView::Iterator::next()
+{
+	param = {};
+	while(pos < end) {
+		auto start = pos;
+		auto sep = static_cast<const char*>(memchr_fast(start, '&', end - start));
+		auto paramEnd = sep ?: end;
+		pos = sep ? sep + 1 : end;
+		if(paramEnd == start) {
+			continue; // Empty parameter
+		}
+
+		param.name = start;
+		auto eq = static_cast<const char*>(memchr_fast(start, '=', paramEnd - start));
+		if(eq == nullptr) {
+			param.nameLength = paramEnd - start;
+			param.value = paramEnd;
+		} else {
+			param.nameLength = eq - start;
+			param.value = eq + 1;
+		}
+		param.valueLength = paramEnd - param.value;
+		return;
+	}
+}
+
+HttpParamsView::HttpParamsView(const char* query, size_t length) : query(query), length(length)
+{
+	// Accept query strings with or without '?' prefix
+	if(length != 0 && *query == '?') {
+		++this->query;
+		--this->length;
+	}
+}
+
+unsigned HttpParamsView::count() const
+{
+	return std::distance(begin(), end());
+}
+
+bool HttpParamsView::find(const char* name, size_t nameLength, Param& param) const
+{
+	for(auto& p : *this) {
+		if(p.nameEquals(name, nameLength)) {
+			param = p;
+			return true;
+		}
+	}
+	return false;
+}
+
+String HttpParamsView::operator[](const String& name) const
+{
+	Param param;
+	return find(name.c_str(), name.length(), param) ? param.getValue() : nullptr;
+}
@@ -0,0 +1,157 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * HttpParamsView.h
+ *
+ ****/
+
+#pragma once
+
+#include "WString.h"
+#include <iterator>
+
+/**
+ * @brief Read-only view of URI query or form parameters
+ * @ingroup http
+ *
+ * Unlike `HttpParams`, nothing is copied: parameters are located on demand in the original text,
+ * which must remain valid for the lifetime of the view. Names and values are only unescaped when requested.
+ *
+ * 		HttpParamsView params(query);
+ * 		String cid = params["cid"];
+ * 		for(auto param : params) {
+ * 			Serial << param.getName() << " = " << param.getValue() << endl;
+ * 		}
+ */
+class HttpParamsView
+{
+public:
+	/**
+	 * @brief Location of a parameter within the original text, in escaped form
+	 */
+	struct Param {
+		const char* name;
+		size_t nameLength;
+		const char* value;
+		size_t valueLength;
+
+		/**
+		 * @brief Get the unescaped name
+		 */
+		String getName() const;
+
+		/**
+		 * @brief Get the unescaped value
+		 */
+		String getValue() const;
+
+		/**
+		 * @brief Compare name with unescaped text, without copying
+		 */
+		bool nameEquals(const char* str, size_t length) const;
+	};
+
+	class Iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Param;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const Param*;
+		using reference = const Param&;
+
+		Iterator(const char* pos, const char* end) : pos(pos), end(end)
+		{
+			next();
+		}
+
+		const Param& operator*() const
+		{
+			return param;
+		}
+
+		const Param* operator->() const
+		{
+			return &param;
+		}
+
+		Iterator& operator++()
+		{
+			next();
+			return *this;
+		}
+
+		bool operator==(const Iterator& other) const
+		{
+			return param.name == other.param.name;
+		}
+
+		bool operator!=(const Iterator& other) const
+		{
+			return !operator==(other);
+		}
+
+	private:
+		void next();
+
+		const char* pos;
+		const char* end;
+		Param param{};
+	};
+
+	/**
+	 * @brief Construct a view
+	 * @param query Text of the form "name1=value1&name2=value2", with or without '?' prefix
+	 * @param length Number of characters in query
+	 */
+	HttpParamsView(const char* query, size_t length);
+
+	explicit HttpParamsView(const String& query) : HttpParamsView(query.c_str(), query.length())
+	{
+	}
+
+	// Content is not copied, so a temporary String cannot be used
+	HttpParamsView(String&&) = delete;
+
+	Iterator begin() const
+	{
+		return Iterator(query, query + length);
+	}
+
+	Iterator end() const
+	{
+		return Iterator(query + length, query + length);
+	}
+
+	/**
+	 * @brief Get number of parameters
+	 */
+	unsigned count() const;
+
+	/**
+	 * @brief Locate a parameter
+	 * @param name Unescaped parameter name
+	 * @param param On success, the location of the parameter
+	 * @retval bool true if parameter was found
+	 */
+	bool find(const char* name, size_t nameLength, Param& param) const;
+
+	bool contains(const String& name) const
+	{
+		Param param;
+		return find(name.c_str(), name.length(), param);
+	}
+
+	/**
+	 * @brief Get unescaped value of a parameter
+	 * @retval String Invalid if parameter was not found
+	 */
+	String operator[](const String& name) const;
+
+private:
+	const char* query;
+	size_t length;
+};
@@ -0,0 +1,174 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * HttpRange.cpp
+ *
+ ****/
+
+#include "HttpRange.h"
+#include <stringutil.h>
+
+namespace
+{
+void skipSpace(const char*& p)
+{
+	while(*p == ' ' || *p == '\t') {
+		++p;
+	}
+}
+
+/*
+ * Range units are case-insensitive
+ */
+bool matchUnit(const String& value, const char* prefix)
+{
+	auto length = strlen(prefix);
+	return value.length() >= length && memicmp(value.c_str(), prefix, length) == 0;
+}
+
+/*
+ * Parse an unsigned decimal number, after any leading whitespace.
+ * Values too large for 32 bits are limited so they don't overflow.
+ * Returns false if there are no digits.
+ */
+bool parseNumber(const char*& p, uint64_t& value)
+{
+	skipSpace(p);
+	if(!isdigit(uint8_t(*p))) {
+		return false;
+	}
+	value = 0;
+	while(isdigit(uint8_t(*p))) {
+		if(value <= UINT32_MAX) {
+			value = (value * 10) + (*p - '0');
+		}
+		++p;
+	}
+	return true;
+}
+
+} // namespace
+
+String HttpRange::toString(uint32_t size) const
+{
+	String s = F("bytes ");
+	s += start;
+	s += '-';
+	s += end;
+	s += '/';
+	s += size;
+	return s;
+}
+
+int HttpRange::parse(const String& value, uint32_t size, HttpRange* ranges, unsigned maxRanges)
+{
+	// Only byte ranges are supported
+	if(!matchUnit(value, _F("bytes="))) {
+		return -1;
+	}
+
+	unsigned specCount{0};
+	unsigned count{0};
+	auto p = value.c_str() + 6;
+	for(;;) {
+		// Empty list elements are permitted
+		skipSpace(p);
+		if(*p == ',') {
+			++p;
+			continue;
+		}
+		if(*p == '\0') {
+			break;
+		}
+
+		uint64_t first;
+		uint64_t last;
+		bool hasFirst = parseNumber(p, first);
+		skipSpace(p);
+		if(*p != '-') {
+			return -1;
+		}
+		++p;
+		bool hasLast = parseNumber(p, last);
+		skipSpace(p);
+		if(*p != ',' && *p != '\0') {
+			return -1;
+		}
+		++specCount;
+
+		HttpRange range;
+		if(hasFirst) {
+			if(hasLast && last < first) {
+				return -1;
+			}
+			if(first >= size) {
+				// Unsatisfiable
+				continue;
+			}
+			range.start = first;
+			range.end = (hasLast && last < size) ? last : size - 1;
+		} else {
+			// Suffix range, specifies length of final part of content
+			if(!hasLast) {
+				return -1;
+			}
+			if(last == 0 || size == 0) {
+				continue;
+			}
+			range.start = (last < size) ? size - last : 0;
+			range.end = size - 1;
+		}
+
+		if(count >= maxRanges) {
+			return -1;
+		}
+		for(unsigned i = 0; i < count; ++i) {
+			if(range.start <= ranges[i].end && range.end >= ranges[i].start) {
+				return -1;
+			}
+		}
+		ranges[count++] = range;
+	}
+
+	return (specCount == 0) ? -1 : int(count);
+}
+
+bool HttpRange::parseContentRange(const String& value, HttpRange& range)
+{
+	if(!matchUnit(value, _F("bytes "))) {
+		return false;
+	}
+
+	auto p = value.c_str() + 6;
+	uint64_t first;
+	uint64_t last;
+	if(!parseNumber(p, first) || *p++ != '-' || !parseNumber(p, last) || *p != '/') {
+		return false;
+	}
+	if(last < first || last > UINT32_MAX) {
+		return false;
+	}
+
+	range.start = first;
+	range.end = last;
+	return true;
+}
+
+bool HttpRange::parseUnsatisfiedRange(const String& value, uint32_t& size)
+{
+	if(!matchUnit(value, _F("bytes */"))) {
+		return false;
+	}
+
+	auto p = value.c_str() + 8;
+	uint64_t length;
+	if(!parseNumber(p, length) || *p != '\0' || length > UINT32_MAX) {
+		return false;
+	}
+
+	size = length;
+	return true;
+}
@@ -0,0 +1,61 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * HttpRange.h
+ *
+ ****/
+
+#pragma once
+
+#include <WString.h>
+
+/**
+ * @brief A range of bytes, as used in Range and Content-Range headers (RFC 7233)
+ * @ingroup http
+ */
+struct HttpRange {
+	uint32_t start{0}; ///< Position of first byte
+	uint32_t end{0};   ///< Position of last byte, inclusive
+
+	uint32_t length() const
+	{
+		return end - start + 1;
+	}
+
+	/**
+	 * @brief Get value for a Content-Range header
+	 * @param size Total size of content
+	 */
+	String toString(uint32_t size) const;
+
+	/**
+	 * @brief Parse the value of a Range request header
+	 * @param value Header value
+	 * @param size Total size of content
+	 * @param ranges On success, the satisfiable ranges, clipped to the size of the content
+	 * @param maxRanges Number of entries in `ranges`
+	 * @retval int Number of ranges, 0 if none can be satisfied.
+	 * Returns -1 if the header is invalid, requests overlapping ranges or more than `maxRanges`:
+	 * the header should be ignored and the full content sent.
+	 */
+	static int parse(const String& value, uint32_t size, HttpRange* ranges, unsigned maxRanges);
+
+	/**
+	 * @brief Parse the value of a Content-Range response header
+	 * @param value Header value, e.g. "bytes 100-199/1000"
+	 * @param range On success, the range of content in the response
+	 * @retval bool false if value is invalid or does not specify a range
+	 */
+	static bool parseContentRange(const String& value, HttpRange& range);
+
+	/**
+	 * @brief Parse the value of a Content-Range header sent with a 416 (Range Not Satisfiable) response
+	 * @param value Header value, with an asterisk in place of the range
+	 * @param size On success, the total size of the content
+	 * @retval bool false if value is invalid or specifies a range
+	 */
+	static bool parseUnsatisfiedRange(const String& value, uint32_t& size);
+};
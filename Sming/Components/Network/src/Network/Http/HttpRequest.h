@@ -52,7 +52,8 @@ public:
 	HttpRequest(const HttpRequest& value)
 		: uri(value.uri), method(value.method), headers(value.headers), postParams(value.postParams),
 		  headersCompletedDelegate(value.headersCompletedDelegate), requestBodyDelegate(value.requestBodyDelegate),
-		  requestCompletedDelegate(value.requestCompletedDelegate), sslInitDelegate(value.sslInitDelegate)
+		  requestCompletedDelegate(value.requestCompletedDelegate), sslInitDelegate(value.sslInitDelegate),
+		  rangeValidator(value.rangeValidator), contentDecoding(value.contentDecoding), resumable(value.resumable)
 	{
 	}
 
@@ -225,6 +226,58 @@ public:
 		return responseStream;
 	}
 
+	/**
+	 * @brief Control decoding of compressed response content
+	 * @param enable Disabled by default
+	 *
+	 * When enabled, the server is told that gzip and deflate encodings are accepted
+	 * (unless an Accept-Encoding header has been set) and responses using them are decoded
+	 * before being passed to the body delegate or response stream.
+	 * Response headers are not changed, so Content-Length gives the size of the encoded content.
+	 *
+	 * Decoding a response allocates a window buffer of 2^HTTP_CLIENT_DECODE_WINDOW_BITS bytes (32K by default),
+	 * which may not be available on devices such as the ESP8266. Compression is only requested if there
+	 * is enough free heap when the request is sent.
+	 */
+	HttpRequest* setContentDecoding(bool enable)
+	{
+		contentDecoding = enable;
+		return this;
+	}
+
+	/**
+	 * @brief Continue from the end of any content already in the response stream
+	 * @param validator ETag or Last-Modified value from the response which provided the existing content.
+	 * If the content has since changed on the server it is sent in full, replacing what was there.
+	 *
+	 * A Range header is sent requesting only the content which follows.
+	 * If the connection fails and the request is sent again, it continues from wherever it got to.
+	 *
+	 * Content is stored as received: compression is not requested and any content encoding is not decoded,
+	 * since ranges refer to the encoded data.
+	 *
+	 * @note If the server sends the full content, a FileStream is truncated before it is written.
+	 * With other streams the request fails.
+	 * If the existing content is already complete, the server's 416 (Range Not Satisfiable) response
+	 * is reported as success.
+	 */
+	HttpRequest* setResumable(const String& validator = nullptr)
+	{
+		resumable = true;
+		rangeValidator = validator;
+		return this;
+	}
+
+	/**
+	 * @brief Get the validator for a resumable request
+	 * @retval String ETag or Last-Modified value from the response, which may be passed to
+	 * `setResumable()` in a later request to continue receiving the same content
+	 */
+	const String& getRangeValidator() const
+	{
+		return rangeValidator;
+	}
+
 	HttpRequest* onHeadersComplete(RequestHeadersCompletedDelegate delegateFunction)
 	{
 		headersCompletedDelegate = delegateFunction;
@@ -297,6 +350,12 @@ protected:
 
 	IDataSourceStream* bodyStream = nullptr;
 	ReadWriteStream* responseStream = nullptr; ///< User-requested stream to store response
+	uint32_t queueTime = 0;					   ///< When request was queued for sending, in milliseconds
+	uint8_t resendCount = 0;				   ///< Times request has been resent after connection failure
+	String rangeValidator;					   ///< Sent in If-Range header for resumable requests
+	uint32_t rangeOffset = 0;				   ///< Start of requested range
+	bool contentDecoding = false;			   ///< Request and decode compressed response content
+	bool resumable = false;					   ///< Continue from end of existing response content
 
 #ifdef ENABLE_HTTP_REQUEST_AUTH
 	AuthAdapter* auth = nullptr;
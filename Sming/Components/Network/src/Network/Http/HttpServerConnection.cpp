@@ -15,13 +15,62 @@
 #include "Network/HttpServer.h"
 #include "Network/TcpServer.h"
 #include <Data/WebConstants.h>
+#include "HttpRange.h"
 #include "Data/Stream/ChunkedStream.h"
+#include "Data/Stream/MultipartStream.h"
+#include "Data/Stream/RangeStream.h"
 #include <SystemClock.h>
+#include <algorithm>
 
 #if HTTP_SERVER_EXPOSE_VERSION == 1
 #include <SmingVersion.h>
 #endif
 
+namespace
+{
+/*
+ * Body of a multipart/byteranges response, containing several ranges of the same source
+ */
+class ByteRangesStream : public MultipartStream
+{
+public:
+	ByteRangesStream(IDataSourceStream* source, uint32_t offset, uint32_t size, const String& contentType,
+					 const HttpRange* ranges, unsigned count)
+		: MultipartStream(Producer(&ByteRangesStream::nextPart, this)), source(source), contentType(contentType),
+		  offset(offset), size(size), count(count)
+	{
+		std::copy_n(ranges, count, this->ranges);
+	}
+
+private:
+	BodyPart nextPart()
+	{
+		BodyPart part;
+		if(index >= count) {
+			return part;
+		}
+
+		auto& range = ranges[index++];
+		part.headers = new HttpHeaders;
+		if(contentType) {
+			(*part.headers)[HTTP_HEADER_CONTENT_TYPE] = contentType;
+		}
+		(*part.headers)[HTTP_HEADER_CONTENT_RANGE] = range.toString(size);
+		part.stream = new RangeStream(source, offset + range.start, range.length());
+		return part;
+	}
+
+	std::shared_ptr<IDataSourceStream> source;
+	String contentType;
+	uint32_t offset;
+	uint32_t size;
+	HttpRange ranges[HTTP_SERVER_MAX_RANGES];
+	uint8_t count;
+	uint8_t index{0};
+};
+
+} // namespace
+
 int HttpServerConnection::onMessageBegin(http_parser* parser)
 {
 	// Reset Response ...
@@ -279,6 +328,8 @@ void HttpServerConnection::sendResponseHeaders(HttpResponse* response)
 	}
 #endif /* DISABLE_HTTPSRV_ETAG */
 
+	applyRange(response);
+
 	String statusLine = F("HTTP/1.1 ");
 	statusLine += unsigned(response->code);
 	statusLine += ' ';
@@ -321,6 +372,80 @@ void HttpServerConnection::sendResponseHeaders(HttpResponse* response)
 	sendString("\r\n");
 }
 
+void HttpServerConnection::applyRange(HttpResponse* response)
+{
+	// Ranges can only be served from complete content with a known size which supports seeking
+	auto stream = response->stream;
+	if(stream == nullptr || response->code != HTTP_STATUS_OK ||
+	   (request.method != HTTP_GET && request.method != HTTP_HEAD) ||
+	   response->headers.contains(HTTP_HEADER_TRANSFER_ENCODING)) {
+		return;
+	}
+	int size = stream->available();
+	int offset = stream->seekFrom(0, SeekOrigin::Current);
+	if(size < 0 || offset < 0) {
+		return;
+	}
+
+	response->headers[HTTP_HEADER_ACCEPT_RANGES] = F("bytes");
+
+	auto& requestHeaders = static_cast<const HttpHeaders&>(request.headers);
+	if(!requestHeaders.contains(HTTP_HEADER_RANGE)) {
+		return;
+	}
+
+	// Send full content if it has changed since the client's partial copy was obtained (RFC 7233 3.2)
+	if(requestHeaders.contains(HTTP_HEADER_IF_RANGE)) {
+		auto& validator = requestHeaders[HTTP_HEADER_IF_RANGE];
+		auto& responseHeaders = static_cast<const HttpHeaders&>(response->headers);
+		auto& etag = responseHeaders[HTTP_HEADER_ETAG];
+		bool match = validator.startsWith(_F("\""))
+						 ? (validator == etag)
+						 : (validator == responseHeaders[HTTP_HEADER_LAST_MODIFIED]);
+		if(!match) {
+			return;
+		}
+	}
+
+	HttpRange ranges[HTTP_SERVER_MAX_RANGES];
+	int count = HttpRange::parse(requestHeaders[HTTP_HEADER_RANGE], size, ranges, HTTP_SERVER_MAX_RANGES);
+	if(count < 0) {
+		return;
+	}
+
+	if(count == 0) {
+		response->code = HTTP_STATUS_RANGE_NOT_SATISFIABLE;
+		String s = F("bytes */");
+		s += size;
+		response->headers[HTTP_HEADER_CONTENT_RANGE] = s;
+		response->headers[HTTP_HEADER_CONTENT_LENGTH] = "0";
+		response->freeStreams();
+		return;
+	}
+
+	// Ownership of the stream passes to the range stream(s). It may also have been the response buffer.
+	response->buffer = nullptr;
+	response->stream = nullptr;
+	response->code = HTTP_STATUS_PARTIAL_CONTENT;
+	response->headers.remove(HTTP_HEADER_CONTENT_LENGTH);
+
+	if(count == 1) {
+		auto& range = ranges[0];
+		response->headers[HTTP_HEADER_CONTENT_RANGE] = range.toString(size);
+		response->stream = new RangeStream(std::shared_ptr<IDataSourceStream>(stream), offset + range.start,
+										   range.length());
+		return;
+	}
+
+	String contentType = response->headers[HTTP_HEADER_CONTENT_TYPE];
+	auto multipart = new ByteRangesStream(stream, offset, size, contentType, ranges, count);
+	String s = F("multipart/byteranges; boundary=");
+	s += multipart->getBoundary();
+	response->headers[HTTP_HEADER_CONTENT_TYPE] = s;
+	response->headers[HTTP_HEADER_TRANSFER_ENCODING] = _F("chunked");
+	response->stream = multipart;
+}
+
 bool HttpServerConnection::sendResponseBody(HttpResponse* response)
 {
 	if(state == eHCS_StartBody) {
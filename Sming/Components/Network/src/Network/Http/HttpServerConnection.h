@@ -23,6 +23,11 @@
  *  @{
  */
 
+/* Most ranges served from a single Range request header. Requests for more are sent the full content. */
+#ifndef HTTP_SERVER_MAX_RANGES
+#define HTTP_SERVER_MAX_RANGES 4
+#endif
+
 class HttpResourceTree;
 class HttpServerConnection;
 
@@ -116,6 +121,7 @@ protected:
 
 private:
 	void sendResponseHeaders(HttpResponse* response);
+	void applyRange(HttpResponse* response);
 	bool sendResponseBody(HttpResponse* response);
 
 public:
@@ -75,6 +75,9 @@ bool WebsocketClient::connect(const Url& url)
 	request->headers[HTTP_HEADER_SEC_WEBSOCKET_KEY] = key;
 	request->headers[HTTP_HEADER_SEC_WEBSOCKET_PROTOCOL] = F("chat");
 	request->headers[HTTP_HEADER_SEC_WEBSOCKET_VERSION] = String(WEBSOCKET_VERSION);
+	if(deflateEnabled) {
+		request->headers[HTTP_HEADER_SEC_WEBSOCKET_EXTENSIONS] = WebsocketDeflate::getOffer();
+	}
 	request->onHeadersComplete(RequestHeadersCompletedDelegate(&WebsocketClient::verifyKey, this));
 
 	if(!httpConnection->send(request)) {
@@ -105,6 +108,23 @@ int WebsocketClient::verifyKey(HttpConnection& connection, HttpResponse& respons
 		return -3;
 	}
 
+	// Server may only accept an extension we offered
+	WebsocketDeflate* negotiated = nullptr;
+	bool extensionsOk;
+	if(deflateEnabled) {
+		extensionsOk =
+			WebsocketDeflate::checkResponse(response.headers[HTTP_HEADER_SEC_WEBSOCKET_EXTENSIONS], negotiated);
+	} else {
+		extensionsOk = !response.headers.contains(HTTP_HEADER_SEC_WEBSOCKET_EXTENSIONS);
+	}
+	if(!extensionsOk) {
+		debug_e("WS: extension negotiation failed");
+		state = eWSCS_Closed;
+		connection.setTimeOut(1);
+		return -4;
+	}
+	deflate.reset(negotiated);
+
 	response.headers.clear();
 
 	state = eWSCS_Open;
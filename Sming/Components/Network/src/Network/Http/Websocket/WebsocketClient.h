@@ -76,6 +76,8 @@ public:
 
 	using WebsocketConnection::close;
 	using WebsocketConnection::getState;
+	using WebsocketConnection::isDeflateActive;
+	using WebsocketConnection::setDeflateEnabled;
 
 	/**
 	 * @brief Set the SSL session initialisation callback
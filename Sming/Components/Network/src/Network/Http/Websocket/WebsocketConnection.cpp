@@ -75,6 +75,15 @@ bool WebsocketConnection::bind(HttpRequest& request, HttpResponse& response)
 	response.headers[HTTP_HEADER_UPGRADE] = WSSTR_WEBSOCKET;
 	response.headers[HTTP_HEADER_SEC_WEBSOCKET_ACCEPT] = base64_encode(hash.data(), hash.size());
 
+	deflate.reset();
+	if(deflateEnabled && request.headers.contains(HTTP_HEADER_SEC_WEBSOCKET_EXTENSIONS)) {
+		String extensions;
+		deflate.reset(WebsocketDeflate::accept(request.headers[HTTP_HEADER_SEC_WEBSOCKET_EXTENSIONS], extensions));
+		if(deflate) {
+			response.headers[HTTP_HEADER_SEC_WEBSOCKET_EXTENSIONS] = extensions;
+		}
+	}
+
 	isClientConnection = false;
 
 	return true;
@@ -102,20 +111,95 @@ void WebsocketConnection::activate()
 
 bool WebsocketConnection::processFrame(TcpClient&, char* at, int size)
 {
-	int rc = ws_parser_execute(&parser, &parserSettings, this, at, size);
-	if(rc != WS_OK) {
-		debug_e("WebsocketResource error: %d %s\n", rc, ws_parser_error(rc));
-		return false;
+	while(size > 0) {
+		int len = scanFrameHeaders(at, size);
+		if(len < 0) {
+			return false;
+		}
+
+		int rc = ws_parser_execute(&parser, &parserSettings, this, at, len);
+		if(rc != WS_OK) {
+			debug_e("WebsocketResource error: %d %s\n", rc, ws_parser_error(rc));
+			return false;
+		}
+
+		at += len;
+		size -= len;
 	}
 
 	return true;
 }
 
+int WebsocketConnection::scanFrameHeaders(char* data, size_t length)
+{
+	auto& scan = frameScanner;
+	size_t pos = 0;
+	while(pos < length) {
+		if(scan.headerPos != 0 && scan.headerPos == scan.headerLength) {
+			// Skip payload
+			auto n = std::min(uint64_t(length - pos), scan.payloadRemaining);
+			pos += n;
+			scan.payloadRemaining -= n;
+			if(scan.payloadRemaining == 0) {
+				scan.headerPos = 0;
+			}
+			continue;
+		}
+
+		uint8_t c = data[pos];
+		if(scan.headerPos == 0) {
+			// Parse one frame at a time so callbacks see the flags for the current frame
+			if(pos != 0) {
+				break;
+			}
+			scan.fin = c & _BV(7);
+			scan.compressed = c & _BV(6);
+			scan.opcode = c & 0x0f;
+			scan.headerLength = 2;
+			scan.lengthEnd = 2;
+			scan.payloadRemaining = 0;
+			if(scan.compressed && deflate) {
+				// Only the first frame of a data message may be compressed (RFC 7692 6.1)
+				if(scan.opcode != WS_FRAME_TEXT && scan.opcode != WS_FRAME_BINARY) {
+					debug_e("WS: Unexpected RSV1 in frame with opcode %u", scan.opcode);
+					return -1;
+				}
+				data[pos] &= ~_BV(6);
+			}
+		} else if(scan.headerPos == 1) {
+			uint8_t len = c & 0x7f;
+			if(len == 126) {
+				scan.lengthEnd = 4;
+			} else if(len == 127) {
+				scan.lengthEnd = 10;
+			} else {
+				scan.payloadRemaining = len;
+			}
+			scan.headerLength = scan.lengthEnd + ((c & _BV(7)) ? 4 : 0);
+		} else if(scan.headerPos < scan.lengthEnd) {
+			scan.payloadRemaining = (scan.payloadRemaining << 8) | c;
+		}
+
+		++pos;
+		++scan.headerPos;
+		if(scan.headerPos == scan.headerLength && scan.payloadRemaining == 0) {
+			scan.headerPos = 0;
+		}
+	}
+
+	return pos;
+}
+
 int WebsocketConnection::staticOnDataBegin(void* userData, ws_frame_type_t type)
 {
 	GET_CONNECTION();
 
 	connection->frameType = type;
+	if(connection->frameScanner.opcode != 0) {
+		// First frame of a message
+		connection->messageCompressed = connection->frameScanner.compressed && connection->deflate;
+		connection->compressedMessage = nullptr;
+	}
 
 	debug_d("data_begin: %s\n", type == WS_FRAME_TEXT ? _F("text") : type == WS_FRAME_BINARY ? _F("binary") : "?");
 
@@ -126,15 +210,56 @@ int WebsocketConnection::staticOnDataPayload(void* userData, const char* at, siz
 {
 	GET_CONNECTION();
 
-	switch(connection->frameType) {
+	if(!connection->messageCompressed) {
+		connection->deliverMessage(const_cast<char*>(at), length);
+		return WS_OK;
+	}
+
+	// Compressed messages can only be decoded once complete
+	auto& message = connection->compressedMessage;
+	if(message.length() + length > WEBSOCKET_DEFLATE_MAX_MESSAGE_SIZE) {
+		debug_e("WS: Compressed message exceeds %u bytes", WEBSOCKET_DEFLATE_MAX_MESSAGE_SIZE);
+		return -1;
+	}
+	if(!message.concat(at, length)) {
+		return -1;
+	}
+
+	return WS_OK;
+}
+
+int WebsocketConnection::staticOnDataEnd(void* userData)
+{
+	GET_CONNECTION();
+
+	if(!connection->messageCompressed || !connection->frameScanner.fin) {
+		return WS_OK;
+	}
+
+	connection->messageCompressed = false;
+	auto& compressed = connection->compressedMessage;
+	String message = connection->deflate->decompress(compressed.c_str(), compressed.length());
+	compressed = nullptr;
+	if(!message) {
+		return -1;
+	}
+
+	connection->deliverMessage(message.begin(), message.length());
+
+	return WS_OK;
+}
+
+void WebsocketConnection::deliverMessage(char* data, size_t length)
+{
+	switch(frameType) {
 	case WS_FRAME_TEXT:
-		if(connection->wsMessage) {
-			connection->wsMessage(*connection, String(at, length));
+		if(wsMessage) {
+			wsMessage(*this, String(data, length));
 		}
 		break;
 	case WS_FRAME_BINARY:
-		if(connection->wsBinary) {
-			connection->wsBinary(*connection, reinterpret_cast<uint8_t*>(const_cast<char*>(at)), length);
+		if(wsBinary) {
+			wsBinary(*this, reinterpret_cast<uint8_t*>(data), length);
 		}
 		break;
 	case WS_FRAME_CLOSE:
@@ -142,13 +267,6 @@ int WebsocketConnection::staticOnDataPayload(void* userData, const char* at, siz
 	case WS_FRAME_PONG:
 		break;
 	}
-
-	return WS_OK;
-}
-
-int WebsocketConnection::staticOnDataEnd(void*)
-{
-	return WS_OK;
 }
 
 int WebsocketConnection::staticOnControlBegin(void* userData, ws_frame_type_t type)
@@ -199,6 +317,14 @@ int WebsocketConnection::staticOnControlEnd(void* userData)
 
 bool WebsocketConnection::send(const char* message, size_t length, ws_frame_type_t type)
 {
+	if(deflate && (type == WS_FRAME_TEXT || type == WS_FRAME_BINARY)) {
+		String compressed = deflate->compress(message, length);
+		if(compressed) {
+			auto stream = new MemoryDataStream(std::move(compressed));
+			return sendFrame(stream, type, isClientConnection, true, true);
+		}
+	}
+
 	auto stream = new MemoryDataStream();
 	if(stream == nullptr) {
 		debug_e("Unable to create memory buffer");
@@ -216,6 +342,12 @@ bool WebsocketConnection::send(const char* message, size_t length, ws_frame_type
 }
 
 bool WebsocketConnection::send(IDataSourceStream* source, ws_frame_type_t type, bool useMask, bool isFin)
+{
+	return sendFrame(source, type, useMask, isFin, false);
+}
+
+bool WebsocketConnection::sendFrame(IDataSourceStream* source, ws_frame_type_t type, bool useMask, bool isFin,
+									bool compressed)
 {
 	// Ensure source gets destroyed if we return prematurely
 	std::unique_ptr<IDataSourceStream> sourceRef(source);
@@ -249,6 +381,9 @@ bool WebsocketConnection::send(IDataSourceStream* source, ws_frame_type_t type,
 	if(isFin) {
 		packet[len] |= _BV(7); // set Fin
 	}
+	if(compressed) {
+		packet[len] |= _BV(6); // set RSV1
+	}
 	packet[len++] |= type; // set opcode
 	if(useMask) {
 		packet[len] |= _BV(7); // set mask
@@ -303,7 +438,32 @@ void WebsocketConnection::broadcast(const char* message, size_t length, ws_frame
 	}
 	memcpy(data.get(), message, length);
 
+	// Compress once for all connections using the same window size
+	bool compressible = (type == WS_FRAME_TEXT || type == WS_FRAME_BINARY);
+	std::shared_ptr<char[]> compressedData;
+	size_t compressedLength = 0;
+	uint8_t compressedWindowBits = 0;
+
 	for(auto skt : websocketList) {
+		if(compressible && skt->deflate) {
+			auto windowBits = skt->deflate->getWindowBits();
+			if(windowBits != compressedWindowBits) {
+				compressedWindowBits = windowBits;
+				compressedData.reset();
+				String s = skt->deflate->compress(message, length);
+				if(s) {
+					compressedLength = s.length();
+					compressedData.reset(new char[compressedLength]);
+					memcpy(compressedData.get(), s.c_str(), compressedLength);
+				}
+			}
+			if(compressedData) {
+				auto stream = new SharedMemoryStream<const char[]>(compressedData, compressedLength);
+				skt->sendFrame(stream, type, false, true, true);
+				continue;
+			}
+		}
+
 		auto stream = new SharedMemoryStream<const char[]>(data, length);
 		skt->send(stream, type);
 	}
@@ -339,6 +499,9 @@ void WebsocketConnection::close()
 void WebsocketConnection::reset()
 {
 	ws_parser_init(&parser);
+	frameScanner = {};
+	compressedMessage = nullptr;
+	messageCompressed = false;
 
 	activated = false;
 }
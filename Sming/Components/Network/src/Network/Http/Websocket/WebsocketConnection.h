@@ -12,6 +12,7 @@
 
 #include "Network/TcpServer.h"
 #include "../HttpConnection.h"
+#include "WebsocketDeflate.h"
 
 extern "C" {
 #include "ws_parser/ws_parser.h"
@@ -268,6 +269,26 @@ public:
 		return state;
 	}
 
+	/**
+	 * @brief Enable or disable negotiation of permessage-deflate compression
+	 * @param enable Compression is disabled by default
+	 * @note Must be called before connecting or binding.
+	 * Compressed messages larger than WEBSOCKET_DEFLATE_MAX_MESSAGE_SIZE, before or after decompression,
+	 * fail the connection.
+	 */
+	void setDeflateEnabled(bool enable)
+	{
+		deflateEnabled = enable;
+	}
+
+	/**
+	 * @brief Determine if permessage-deflate compression was negotiated for this connection
+	 */
+	bool isDeflateActive() const
+	{
+		return bool(deflate);
+	}
+
 protected:
 	// Static handlers for ws_parser
 	static int staticOnDataBegin(void* userData, ws_frame_type_t type);
@@ -285,6 +306,26 @@ protected:
 	 */
 	bool processFrame(TcpClient& client, char* at, int size);
 
+	/**
+	 * @brief Send a single frame
+	 * @param compressed true if source contains compressed data, sets RSV1 in frame header
+	 * @see See `send(IDataSourceStream*, ws_frame_type_t, bool, bool)`
+	 */
+	bool sendFrame(IDataSourceStream* source, ws_frame_type_t type, bool useMask, bool isFin, bool compressed);
+
+	/**
+	 * @brief Examine frame headers in received data ahead of the parser
+	 * @param data Received data, compression flags are cleared
+	 * @param length
+	 * @retval int Number of bytes up to the start of the next frame header, -1 on error
+	 */
+	int scanFrameHeaders(char* data, size_t length);
+
+	/**
+	 * @brief Deliver a completed message to the application
+	 */
+	void deliverMessage(char* data, size_t length);
+
 protected:
 	WebsocketDelegate wsConnect;
 	WebsocketMessageDelegate wsMessage;
@@ -296,9 +337,29 @@ protected:
 
 	WsConnectionState state;
 
+	std::unique_ptr<WebsocketDeflate> deflate; ///< Set if permessage-deflate was negotiated
+	bool deflateEnabled = false;
+
 private:
+	/**
+	 * @brief Tracks frame headers in received data
+	 * @note ws_parser rejects frames with RSV bits set, so compressed frames must be identified beforehand
+	 */
+	struct FrameScanner {
+		uint64_t payloadRemaining;
+		uint8_t headerPos;	  ///< Number of header bytes received, 0 at start of frame
+		uint8_t headerLength; ///< Total header length, once known
+		uint8_t lengthEnd;	  ///< Offset of end of extended payload length field
+		uint8_t opcode;
+		bool fin;
+		bool compressed; ///< RSV1 set
+	};
+
 	ws_frame_type_t frameType = WS_FRAME_TEXT;
 	WsFrameInfo controlFrame;
+	FrameScanner frameScanner{};
+	String compressedMessage; ///< Payload of compressed message being received
+	bool messageCompressed = false;
 
 	ws_parser_t parser;
 	static const ws_parser_callbacks_t parserSettings;
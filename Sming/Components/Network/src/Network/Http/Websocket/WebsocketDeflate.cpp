@@ -0,0 +1,316 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * WebsocketDeflate.cpp
+ *
+ ****/
+
+#include "WebsocketDeflate.h"
+#include <uzlib.h>
+#include <debug_progmem.h>
+
+namespace
+{
+DEFINE_FSTR_LOCAL(EXTENSION_NAME, "permessage-deflate")
+DEFINE_FSTR_LOCAL(SERVER_NO_CONTEXT_TAKEOVER, "server_no_context_takeover")
+DEFINE_FSTR_LOCAL(CLIENT_NO_CONTEXT_TAKEOVER, "client_no_context_takeover")
+DEFINE_FSTR_LOCAL(SERVER_MAX_WINDOW_BITS, "server_max_window_bits")
+DEFINE_FSTR_LOCAL(CLIENT_MAX_WINDOW_BITS, "client_max_window_bits")
+
+// Appended to received messages before decompression (RFC 7692 7.2.2)
+const uint8_t messageTrailer[]{0x00, 0x00, 0xff, 0xff};
+
+/*
+ * Parameters of a single extension offer or response.
+ * For window bits, -1 means absent and 0 means present without a value.
+ */
+struct Params {
+	bool serverNoContextTakeover{false};
+	bool clientNoContextTakeover{false};
+	int8_t serverMaxWindowBits{-1};
+	int8_t clientMaxWindowBits{-1};
+};
+
+/*
+ * Parse window bits value, which may be quoted
+ */
+int8_t parseWindowBits(String value)
+{
+	if(!value) {
+		return 0;
+	}
+	if(value.length() >= 2 && value[0] == '"' && value[value.length() - 1] == '"') {
+		value.remove(value.length() - 1);
+		value.remove(0, 1);
+	}
+	if(value.length() < 1 || value.length() > 2 || !isdigit(value[0]) || !isdigit(value[value.length() - 1])) {
+		return -1;
+	}
+	int bits = value.toInt();
+	return (bits >= 8 && bits <= 15) ? bits : -1;
+}
+
+/*
+ * Parse one comma-separated element of a Sec-WebSocket-Extensions header
+ * Returns false if this isn't a valid permessage-deflate element
+ */
+bool parseExtension(const String& element, Params& params)
+{
+	int start = 0;
+	bool first = true;
+	for(;;) {
+		int end = element.indexOf(';', start);
+		String param = element.substring(start, (end < 0) ? element.length() : end);
+		param.trim();
+
+		if(first) {
+			if(!param.equalsIgnoreCase(EXTENSION_NAME)) {
+				return false;
+			}
+			first = false;
+		} else {
+			String value;
+			int i = param.indexOf('=');
+			if(i >= 0) {
+				value = param.substring(i + 1);
+				value.trim();
+				param.setLength(i);
+				param.trim();
+				if(!value) {
+					return false;
+				}
+			}
+
+			// Each parameter may appear only once (RFC 7692 7.1)
+			if(param == SERVER_NO_CONTEXT_TAKEOVER && !value && !params.serverNoContextTakeover) {
+				params.serverNoContextTakeover = true;
+			} else if(param == CLIENT_NO_CONTEXT_TAKEOVER && !value && !params.clientNoContextTakeover) {
+				params.clientNoContextTakeover = true;
+			} else if(param == SERVER_MAX_WINDOW_BITS && value && params.serverMaxWindowBits < 0) {
+				params.serverMaxWindowBits = parseWindowBits(value);
+				if(params.serverMaxWindowBits < 0) {
+					return false;
+				}
+			} else if(param == CLIENT_MAX_WINDOW_BITS && params.clientMaxWindowBits < 0) {
+				params.clientMaxWindowBits = parseWindowBits(value);
+				if(params.clientMaxWindowBits < 0) {
+					return false;
+				}
+			} else {
+				return false;
+			}
+		}
+
+		if(end < 0) {
+			return true;
+		}
+		start = end + 1;
+	}
+}
+
+struct Decompressor {
+	uzlib_uncomp state{};
+	uint8_t trailerPos{0};
+	bool finished{false};
+
+	static int readTrailer(uzlib_uncomp* uncomp)
+	{
+		auto self = reinterpret_cast<Decompressor*>(uncomp);
+		if(self->trailerPos < sizeof(messageTrailer)) {
+			return messageTrailer[self->trailerPos++];
+		}
+		self->finished = true;
+		return -1;
+	}
+};
+
+} // namespace
+
+String WebsocketDeflate::getOffer()
+{
+	// We can limit our own window to suit the server, but need it to keep messages independent
+	String s = EXTENSION_NAME;
+	s += "; ";
+	s += CLIENT_NO_CONTEXT_TAKEOVER;
+	s += "; ";
+	s += SERVER_NO_CONTEXT_TAKEOVER;
+	s += "; ";
+	s += CLIENT_MAX_WINDOW_BITS;
+	return s;
+}
+
+WebsocketDeflate* WebsocketDeflate::accept(const String& offers, String& response)
+{
+	int start = 0;
+	for(;;) {
+		int end = offers.indexOf(',', start);
+		Params params;
+		if(parseExtension(offers.substring(start, (end < 0) ? offers.length() : end), params)) {
+			/*
+			 * Received messages are decompressed individually, so the client must not use context takeover.
+			 * We don't use it either, whether or not the client asked.
+			 * Our decompressor doesn't use a window so there's no need to limit the client's.
+			 */
+			response = EXTENSION_NAME;
+			response += "; ";
+			response += SERVER_NO_CONTEXT_TAKEOVER;
+			response += "; ";
+			response += CLIENT_NO_CONTEXT_TAKEOVER;
+			uint8_t windowBits = 15;
+			if(params.serverMaxWindowBits > 0) {
+				windowBits = params.serverMaxWindowBits;
+				response += "; ";
+				response += SERVER_MAX_WINDOW_BITS;
+				response += '=';
+				response += windowBits;
+			}
+			return new WebsocketDeflate(windowBits);
+		}
+
+		if(end < 0) {
+			return nullptr;
+		}
+		start = end + 1;
+	}
+}
+
+bool WebsocketDeflate::checkResponse(const String& response, WebsocketDeflate*& deflate)
+{
+	deflate = nullptr;
+
+	String s = response;
+	s.trim();
+	if(!s) {
+		// Server declined compression
+		return true;
+	}
+
+	// Server must accept only what we offered, once
+	Params params;
+	if(s.indexOf(',') >= 0 || !parseExtension(s, params)) {
+		debug_w("[WS] Invalid extension response '%s'", s.c_str());
+		return false;
+	}
+	if(!params.serverNoContextTakeover || params.clientMaxWindowBits == 0) {
+		debug_w("[WS] Unacceptable deflate parameters '%s'", s.c_str());
+		return false;
+	}
+
+	deflate = new WebsocketDeflate(params.clientMaxWindowBits > 0 ? params.clientMaxWindowBits : 15);
+	return true;
+}
+
+String WebsocketDeflate::compress(const void* data, size_t length) const
+{
+	if(length < WEBSOCKET_DEFLATE_MIN_SIZE) {
+		return nullptr;
+	}
+
+	uzlib_comp comp{};
+	comp.hash_bits = WEBSOCKET_DEFLATE_HASH_BITS;
+	comp.dict_size = 1U << windowBits;
+	comp.hash_table = static_cast<uzlib_hash_entry_t*>(calloc(1U << comp.hash_bits, sizeof(uzlib_hash_entry_t)));
+	if(comp.hash_table == nullptr) {
+		return nullptr;
+	}
+
+	/*
+	 * A single block with BFINAL set is produced, followed by a zero byte.
+	 * This allows the receiver's trailer to complete an empty stored block (RFC 7692 7.2.3.3).
+	 */
+	zlib_start_block(&comp.out);
+	uzlib_compress(&comp, static_cast<const uint8_t*>(data), length);
+	zlib_finish_block(&comp.out);
+	free(comp.hash_table);
+
+	auto& out = comp.out;
+	size_t compressedLength = out.outlen + 1;
+	if(compressedLength >= length) {
+		debug_d("[WS] Message not compressible (%u -> %u)", length, compressedLength);
+		free(out.outbuf);
+		return nullptr;
+	}
+
+	// Need room for the extra byte plus String's NUL terminator
+	auto buf = static_cast<char*>(realloc(out.outbuf, compressedLength + 1));
+	if(buf == nullptr) {
+		free(out.outbuf);
+		return nullptr;
+	}
+	buf[out.outlen] = 0x00;
+
+	String result;
+	if(!result.setBuffer({buf, compressedLength + 1, compressedLength})) {
+		free(buf);
+		return nullptr;
+	}
+
+	debug_d("[WS] Compressed %u -> %u bytes", length, compressedLength);
+	return result;
+}
+
+String WebsocketDeflate::decompress(const void* data, size_t length) const
+{
+	static bool initialised;
+	if(!initialised) {
+		uzlib_init();
+		initialised = true;
+	}
+
+	Decompressor d;
+	auto& state = d.state;
+	// No dictionary: back-references are resolved within the output buffer
+	uzlib_uncompress_init(&state, nullptr, 0);
+	state.source = static_cast<const uint8_t*>(data);
+	state.source_limit = state.source + length;
+	state.source_read_cb = Decompressor::readTrailer;
+
+	// Decompressor stops when the buffer is full, so allow an extra byte to detect oversize messages
+	const size_t maxLength = WEBSOCKET_DEFLATE_MAX_MESSAGE_SIZE + 1;
+	String result;
+	size_t outputLength = std::min(maxLength, std::max(size_t(256), length * 4));
+	if(!result.setLength(outputLength)) {
+		return nullptr;
+	}
+	auto buffer = reinterpret_cast<uint8_t*>(result.begin());
+	state.destStart = buffer;
+	state.dest = buffer;
+	state.dest_limit = buffer + outputLength;
+
+	for(;;) {
+		int res = uzlib_uncompress(&state);
+		size_t pos = state.dest - buffer;
+
+		if(res == TINF_OK) {
+			// Output buffer is full
+			if(outputLength >= maxLength) {
+				debug_w("[WS] Decompressed message exceeds %u bytes", WEBSOCKET_DEFLATE_MAX_MESSAGE_SIZE);
+				return nullptr;
+			}
+			outputLength = std::min(outputLength * 2, maxLength);
+			if(!result.setLength(outputLength)) {
+				return nullptr;
+			}
+			buffer = reinterpret_cast<uint8_t*>(result.begin());
+			state.destStart = buffer;
+			state.dest = buffer + pos;
+			state.dest_limit = buffer + outputLength;
+			continue;
+		}
+
+		/*
+		 * Without BFINAL, the decompressor reads past the empty stored block at the end of the trailer
+		 * and fails, which is fine provided all the data has been consumed.
+		 */
+		if(res != TINF_DONE && !d.finished) {
+			debug_w("[WS] Decompression failed: %d", res);
+			return nullptr;
+		}
+
+		result.setLength(pos);
+		return result;
+	}
+}
@@ -0,0 +1,95 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * WebsocketDeflate.h
+ *
+ ****/
+
+#pragma once
+
+#include <WString.h>
+
+/* Largest message accepted in compressed form, after decompression. Larger messages fail the connection. */
+#ifndef WEBSOCKET_DEFLATE_MAX_MESSAGE_SIZE
+#define WEBSOCKET_DEFLATE_MAX_MESSAGE_SIZE 8192
+#endif
+
+/* Messages shorter than this are always sent uncompressed */
+#ifndef WEBSOCKET_DEFLATE_MIN_SIZE
+#define WEBSOCKET_DEFLATE_MIN_SIZE 64
+#endif
+
+/* Size of compressor hash table as a power of 2. Each entry takes one pointer. */
+#ifndef WEBSOCKET_DEFLATE_HASH_BITS
+#define WEBSOCKET_DEFLATE_HASH_BITS 9
+#endif
+
+/**
+ * @brief Implements the permessage-deflate websocket extension (RFC 7692) using uzlib
+ * @ingroup websocket
+ *
+ * Every message is compressed independently, so no compression state is kept between messages.
+ * Both endpoints are asked not to use context takeover, so received messages can also be decompressed
+ * independently: memory is only required whilst a message is being compressed or decompressed.
+ *
+ * The memory required for received messages is limited by `WEBSOCKET_DEFLATE_MAX_MESSAGE_SIZE`.
+ */
+class WebsocketDeflate
+{
+public:
+	/**
+	 * @brief Constructor
+	 * @param windowBits Limits distance of back-references in compressed messages we send
+	 */
+	WebsocketDeflate(uint8_t windowBits = 15) : windowBits(windowBits)
+	{
+	}
+
+	/**
+	 * @brief Get the offer for a client to put in its Sec-WebSocket-Extensions request header
+	 */
+	static String getOffer();
+
+	/**
+	 * @brief Server: choose from the offers in a client's Sec-WebSocket-Extensions request header
+	 * @param offers Content of request header
+	 * @param response On success, content for the Sec-WebSocket-Extensions response header
+	 * @retval WebsocketDeflate* New object if an offer was accepted, nullptr otherwise
+	 */
+	static WebsocketDeflate* accept(const String& offers, String& response);
+
+	/**
+	 * @brief Client: check the Sec-WebSocket-Extensions header in a server's response
+	 * @param response Content of response header, may be empty
+	 * @param deflate On success, a new object or nullptr if compression was declined
+	 * @retval bool false if the response is invalid and the connection must be failed
+	 */
+	static bool checkResponse(const String& response, WebsocketDeflate*& deflate);
+
+	/**
+	 * @brief Compress a message
+	 * @param data
+	 * @param length
+	 * @retval String Compressed message payload, invalid if compression would not make it smaller
+	 */
+	String compress(const void* data, size_t length) const;
+
+	/**
+	 * @brief Decompress a message
+	 * @param data Compressed message payload
+	 * @param length
+	 * @retval String Decompressed message, invalid if data is corrupt or too large
+	 */
+	String decompress(const void* data, size_t length) const;
+
+	uint8_t getWindowBits() const
+	{
+		return windowBits;
+	}
+
+private:
+	uint8_t windowBits;
+};
@@ -25,6 +25,7 @@ int WebsocketResource::checkHeaders(HttpServerConnection& connection, HttpReques
 	socket->setConnectionHandler(wsConnect);
 	socket->setPongHandler(wsPong);
 	socket->setDisconnectionHandler(wsDisconnect);
+	socket->setDeflateEnabled(deflateEnabled);
 	if(!socket->bind(request, response)) {
 		debug_w("Not a valid WebsocketRequest?");
 		delete socket;
@@ -58,6 +58,17 @@ public:
 		wsDisconnect = handler;
 	}
 
+	/**
+	 * @brief Enable or disable permessage-deflate compression for new connections
+	 * @param enable Compression is disabled by default. If enabled, it is used when requested by the client.
+	 * @note Compressed messages larger than WEBSOCKET_DEFLATE_MAX_MESSAGE_SIZE, before or after decompression,
+	 * fail the connection.
+	 */
+	void setDeflateEnabled(bool enable)
+	{
+		deflateEnabled = enable;
+	}
+
 protected:
 	bool onConnect();
 
@@ -67,4 +78,5 @@ protected:
 	WebsocketBinaryDelegate wsBinary = nullptr;
 	WebsocketDelegate wsPong = nullptr;
 	WebsocketDelegate wsDisconnect = nullptr;
+	bool deflateEnabled = false;
 };
@@ -11,6 +11,7 @@
 #include "NtpClient.h"
 #include "Platform/Station.h"
 #include "SystemClock.h"
+#include "DnsCache.h"
 #include <lwip_includes.h>
 
 NtpClient::NtpClient(const String& reqServer, unsigned reqIntervalSeconds, NtpTimeResultDelegate delegateFunction)
@@ -45,26 +46,19 @@ void NtpClient::requestTime()
 		return;
 	}
 
-	ip_addr_t resolvedIp;
-	int result = dns_gethostbyname(
-		server.c_str(), &resolvedIp,
-		[](const char*, LWIP_IP_ADDR_T* ip, void* arg) {
-			// We do a new request since the last one was never done.
-			if(ip)
-				reinterpret_cast<NtpClient*>(arg)->internalRequestTime(*ip);
-		},
-		this);
+	IpAddress resolvedIp;
+	err_t result = DnsCache::global().lookup(server, resolvedIp, [this](const String&, IpAddress ip) {
+		// We do a new request since the last one was never done.
+		if(!ip.isNull()) {
+			internalRequestTime(ip);
+		}
+	});
 
-	debug_d("dns_gethostbyname() returned %d", result);
+	debug_d("DNS lookup returned %d", result);
 
 	switch(result) {
 	case ERR_OK:
-		// Documentation says this will be the result if the string is already
-		// an ip address in dotted decimal form or if the host is found in dns cache.
-		// however I'm not sure if the dns cache is working since this never seems to
-		// be called for a host lookup other than an ip address.
-		// Doesn't really matter since the lookup will be fast anyways, the host
-		// is most likely found in the dns cache of the next node the query is sent to.
+		// Server given as an address, or found in DNS cache
 		internalRequestTime(resolvedIp);
 		break;
 	case ERR_INPROGRESS:
@@ -99,6 +99,14 @@ public:
 		completed = completeCb;
 	}
 
+	/**	@brief	Set or clear the callback for ready-to-send events
+	 *	@param	readyCb callback delegate or nullptr
+	 */
+	void setReadyToSendDelegate(TcpClientEventDelegate readyCb = nullptr)
+	{
+		ready = readyCb;
+	}
+
 	bool send(const char* data, uint16_t len, bool forceCloseAfterSent = false);
 
 	bool sendString(const String& data, bool forceCloseAfterSent = false)
@@ -128,6 +136,14 @@ public:
 		return state;
 	}
 
+	/**
+	 * @brief Determine whether all queued data has been sent and acknowledged by the remote host
+	 */
+	bool isSendComplete() const
+	{
+		return stream == nullptr && totalSentConfirmedBytes >= totalSentBytes;
+	}
+
 	/**
 	 * Schedules the connection to get closed after the data is sent
 	 * @param ignoreIncomingData when that flag is set the connection will start ignoring incoming data.
@@ -13,7 +13,7 @@
 #include <Data/Stream/DataSourceStream.h>
 #include "NetUtils.h"
 #include <WString.h>
-#include <lwip/dns.h>
+#include "DnsCache.h"
 
 #define debug_tcp_e(fmt, ...) debug_e("TCP %p " fmt, this, ##__VA_ARGS__)
 #define debug_tcp_w(fmt, ...) debug_w("TCP %p " fmt, this, ##__VA_ARGS__)
@@ -71,8 +71,6 @@ bool TcpConnection::connect(const String& server, int port, bool useSsl)
 		initialize(tcpNew);
 	}
 
-	ip_addr_t addr;
-
 	this->useSsl = useSsl;
 	if(useSsl) {
 		if(!sslCreateSession()) {
@@ -84,28 +82,16 @@ bool TcpConnection::connect(const String& server, int port, bool useSsl)
 	debug_tcp_d("connect to \"%s:%d\"", server.c_str(), port);
 	canSend = false; // Wait for connection
 
-	struct DnsLookup {
-		TcpConnection* con;
-		int port;
-	};
-	DnsLookup* look = new DnsLookup{this, port};
-	err_t dnslook = dns_gethostbyname(
-		server.c_str(), &addr,
-		[](const char* name, LWIP_IP_ADDR_T* ipaddr, void* arg) {
-			auto dlook = static_cast<DnsLookup*>(arg);
-			if(dlook != nullptr) {
-				dlook->con->internalOnDnsResponse(name, ipaddr, dlook->port);
-				delete dlook;
-			}
-		},
-		look);
-	if(dnslook == ERR_INPROGRESS) {
+	IpAddress addr;
+	err_t err = DnsCache::global().lookup(server, addr, [this, port](const String& name, IpAddress ip) {
+		internalOnDnsResponse(name, ip, port);
+	});
+	if(err == ERR_INPROGRESS) {
 		// Operation pending - see internalOnDnsResponse()
 		return true;
 	}
-	delete look;
 
-	return (dnslook == ERR_OK) ? internalConnect(addr, port) : false;
+	return (err == ERR_OK) ? internalConnect(addr, port) : false;
 }
 
 bool TcpConnection::connect(IpAddress addr, uint16_t port, bool useSsl)
@@ -558,16 +544,15 @@ void TcpConnection::internalOnError(err_t err)
 	debug_tcp_ext("<error");
 }
 
-void TcpConnection::internalOnDnsResponse([[maybe_unused]] const char* name, LWIP_IP_ADDR_T* ipaddr, int port)
+void TcpConnection::internalOnDnsResponse([[maybe_unused]] const String& name, IpAddress ip, int port)
 {
-	if(ipaddr != nullptr) {
-		IpAddress ip = *ipaddr;
-		debug_tcp_d("DNS record found: %s = %s", name, ip.toString().c_str());
+	if(!ip.isNull()) {
+		debug_tcp_d("DNS record found: %s = %s", name.c_str(), ip.toString().c_str());
 
 		internalConnect(ip, port);
 	} else {
 #ifdef NETWORK_DEBUG
-		debug_tcp_d("DNS record _not_ found: %s", name);
+		debug_tcp_d("DNS record _not_ found: %s", name.c_str());
 #endif
 
 		closeTcpConnection(tcp);
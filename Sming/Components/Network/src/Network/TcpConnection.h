@@ -212,7 +212,7 @@ protected:
 	err_t internalOnSent(uint16_t len);
 	err_t internalOnPoll();
 	void internalOnError(err_t err);
-	void internalOnDnsResponse(const char* name, LWIP_IP_ADDR_T* ipaddr, int port);
+	void internalOnDnsResponse(const String& name, IpAddress ip, int port);
 
 private:
 	static err_t staticOnPoll(void* arg, tcp_pcb* tcp);
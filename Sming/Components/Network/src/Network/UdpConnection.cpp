@@ -10,8 +10,159 @@
 
 #include "UdpConnection.h"
 #include "WString.h"
+#include "DnsCache.h"
+#include <Platform/System.h>
 #include <debug_progmem.h>
 
+/*
+ * Buffers for sendBatch().
+ * Sending moves the payload pointer back over the protocol headers, so we keep the original
+ * position to restore it. Drivers may hold a reference until transmission is complete.
+ */
+struct UdpConnection::SendPool {
+	struct Entry {
+		pbuf* buf;
+		void* payload;
+	};
+	Entry entries[UDP_SEND_POOL_SIZE]{};
+
+	~SendPool()
+	{
+		for(auto& e : entries) {
+			if(e.buf != nullptr) {
+				pbuf_free(e.buf);
+			}
+		}
+	}
+
+	/*
+	 * Get a buffer containing the given data.
+	 * Caller must release it with pbuf_free() after sending.
+	 * allocCount is incremented if a new buffer is allocated.
+	 */
+	pbuf* get(const char* data, uint16_t length, unsigned& allocCount)
+	{
+		if(length <= UDP_SEND_POOL_BUFFER_SIZE) {
+			for(auto& e : entries) {
+				if(e.buf == nullptr) {
+					e.buf = pbuf_alloc(PBUF_TRANSPORT, UDP_SEND_POOL_BUFFER_SIZE, PBUF_RAM);
+					if(e.buf == nullptr) {
+						break;
+					}
+					++allocCount;
+					e.payload = e.buf->payload;
+				} else if(e.buf->ref != 1) {
+					// Still in use
+					continue;
+				} else {
+					auto offset = static_cast<uint8_t*>(e.buf->payload) - static_cast<uint8_t*>(e.payload);
+					pbuf_header(e.buf, s16_t(offset));
+				}
+				e.buf->len = e.buf->tot_len = length;
+				memcpy(e.buf->payload, data, length);
+				pbuf_ref(e.buf);
+				return e.buf;
+			}
+		}
+
+		pbuf* p = pbuf_alloc(PBUF_TRANSPORT, length, PBUF_RAM);
+		if(p != nullptr) {
+			++allocCount;
+			memcpy(p->payload, data, length);
+		}
+		return p;
+	}
+};
+
+/*
+ * Datagrams held for the batch receive handler.
+ * This is owned by the connection, but if a dispatch callback is pending when the connection is closed
+ * then it's left for the callback to delete.
+ */
+struct UdpConnection::ReceiveQueue {
+	UdpConnection* connection;
+	unsigned count{0};
+	bool scheduled{false};
+	bool dispatching{false};
+	pbuf* bufs[UDP_RECEIVE_BATCH_SIZE];
+	UdpDatagram datagrams[UDP_RECEIVE_BATCH_SIZE];
+
+	ReceiveQueue(UdpConnection* connection) : connection(connection)
+	{
+	}
+
+	~ReceiveQueue()
+	{
+		clear();
+	}
+
+	bool isFull() const
+	{
+		return count == UDP_RECEIVE_BATCH_SIZE;
+	}
+
+	void add(pbuf* buf, IpAddress remoteIP, uint16_t remotePort)
+	{
+		bufs[count] = buf;
+		auto& dgram = datagrams[count];
+		dgram.data = static_cast<const char*>(buf->payload);
+		dgram.length = buf->tot_len;
+		dgram.remoteIP = remoteIP;
+		dgram.remotePort = remotePort;
+		++count;
+
+		if(!scheduled) {
+			scheduled = System.queueCallback(staticDispatch, this);
+			if(!scheduled) {
+				dispatch();
+			}
+		}
+	}
+
+	void clear()
+	{
+		for(unsigned i = 0; i < count; ++i) {
+			pbuf_free(bufs[i]);
+		}
+		count = 0;
+	}
+
+	void release()
+	{
+		connection = nullptr;
+		if(!scheduled && !dispatching) {
+			delete this;
+		}
+	}
+
+	void dispatch()
+	{
+		if(connection != nullptr && count != 0) {
+			dispatching = true;
+			if(connection->onBatchCallback) {
+				connection->onBatchCallback(*connection, datagrams, count);
+			} else {
+				// Handler was removed after these were queued
+				for(unsigned i = 0; i < count && connection != nullptr; ++i) {
+					connection->onReceive(bufs[i], datagrams[i].remoteIP, datagrams[i].remotePort);
+				}
+			}
+			dispatching = false;
+		}
+		clear();
+		if(connection == nullptr) {
+			delete this;
+		}
+	}
+
+	static void staticDispatch(void* param)
+	{
+		auto queue = static_cast<ReceiveQueue*>(param);
+		queue->scheduled = false;
+		queue->dispatch();
+	}
+};
+
 bool UdpConnection::initialize(udp_pcb* pcb)
 {
 	if(pcb == nullptr) {
@@ -29,6 +180,13 @@ bool UdpConnection::initialize(udp_pcb* pcb)
 
 void UdpConnection::close()
 {
+	delete sendPool;
+	sendPool = nullptr;
+	if(receiveQueue != nullptr) {
+		receiveQueue->release();
+		receiveQueue = nullptr;
+	}
+
 	udp_recv(udp, nullptr, nullptr);
 	udp_remove(udp);
 	udp = nullptr;
@@ -67,6 +225,22 @@ bool UdpConnection::connect(IpAddress ip, uint16_t port)
 	return res == ERR_OK;
 }
 
+bool UdpConnection::connect(const String& host, uint16_t port)
+{
+	IpAddress ip;
+	err_t err = DnsCache::global().lookup(host, ip, [this, port](const String&, IpAddress ip) {
+		if(!ip.isNull()) {
+			connect(ip, port);
+		}
+	});
+	if(err == ERR_INPROGRESS) {
+		debug_d("UDP lookup of '%s' in progress", host.c_str());
+		return true;
+	}
+
+	return (err == ERR_OK) ? connect(ip, port) : false;
+}
+
 bool UdpConnection::send(const char* data, int length)
 {
 	pbuf* p = pbuf_alloc(PBUF_TRANSPORT, length, PBUF_RAM);
@@ -93,6 +267,67 @@ bool UdpConnection::sendTo(IpAddress remoteIP, uint16_t remotePort, const char*
 	}
 }
 
+unsigned UdpConnection::sendBatch(const UdpDatagram* datagrams, unsigned count)
+{
+	if(udp == nullptr) {
+		return 0;
+	}
+	if(sendPool == nullptr) {
+		sendPool = new SendPool;
+		if(sendPool == nullptr) {
+			return 0;
+		}
+	}
+
+	for(unsigned i = 0; i < count; ++i) {
+		auto& dgram = datagrams[i];
+		pbuf* p = sendPool->get(dgram.data, dgram.length, sendAllocCount);
+		if(p == nullptr) {
+			return i;
+		}
+		err_t res;
+		if(dgram.remotePort == 0) {
+			res = udp_send(udp, p);
+		} else {
+			IpAddress remoteIP = dgram.remoteIP;
+			res = udp_sendto(udp, p, remoteIP, dgram.remotePort);
+		}
+		pbuf_free(p);
+		if(res != ERR_OK) {
+			debug_w("UDP batch send failed: %d", res);
+			return i;
+		}
+	}
+
+	return count;
+}
+
+void UdpConnection::queueReceive(pbuf* buf, IpAddress remoteIP, uint16_t remotePort)
+{
+	if(receiveQueue == nullptr) {
+		receiveQueue = new ReceiveQueue(this);
+	}
+	if(receiveQueue == nullptr || receiveQueue->isFull()) {
+		++droppedCount;
+		return;
+	}
+
+	// Datagram must be contiguous for the handler
+	if(buf->len == buf->tot_len) {
+		pbuf_ref(buf);
+	} else {
+		pbuf* p = pbuf_alloc(PBUF_RAW, buf->tot_len, PBUF_RAM);
+		if(p == nullptr) {
+			++droppedCount;
+			return;
+		}
+		pbuf_copy(p, buf);
+		buf = p;
+	}
+
+	receiveQueue->add(buf, remoteIP, remotePort);
+}
+
 void UdpConnection::onReceive(pbuf* buf, IpAddress remoteIP, uint16_t remotePort)
 {
 	debug_d("UDP received: %d bytes", buf->tot_len);
@@ -112,7 +347,11 @@ void UdpConnection::staticOnReceive(void* arg, struct udp_pcb*, struct pbuf* p,
 	auto conn = static_cast<UdpConnection*>(arg);
 	if(conn != nullptr) {
 		IpAddress reip = addr != nullptr ? IpAddress(*addr) : IpAddress();
-		conn->onReceive(p, reip, port);
+		if(conn->onBatchCallback) {
+			conn->queueReceive(p, reip, port);
+		} else {
+			conn->onReceive(p, reip, port);
+		}
 	}
 	pbuf_free(p);
 }
@@ -19,11 +19,45 @@
  *  @{
  */
 
+/* Number of buffers kept by each connection for re-use by sendBatch() */
+#ifndef UDP_SEND_POOL_SIZE
+#define UDP_SEND_POOL_SIZE 4
+#endif
+
+/* Size of each pooled send buffer. Larger datagrams are given a buffer of their own. */
+#ifndef UDP_SEND_POOL_BUFFER_SIZE
+#define UDP_SEND_POOL_BUFFER_SIZE 512
+#endif
+
+/* Most datagrams held for a batch receive handler. Further datagrams are dropped until the handler has run. */
+#ifndef UDP_RECEIVE_BATCH_SIZE
+#define UDP_RECEIVE_BATCH_SIZE 16
+#endif
+
 class UdpConnection;
 
 using UdpConnectionDataDelegate =
 	Delegate<void(UdpConnection& connection, char* data, int size, IpAddress remoteIP, uint16_t remotePort)>;
 
+/**
+ * @brief A single datagram, as passed to `UdpConnection::sendBatch()` or a batch receive handler
+ */
+struct UdpDatagram {
+	const char* data{nullptr}; ///< Content, not NUL-terminated
+	uint16_t length{0};
+	IpAddress remoteIP;
+	uint16_t remotePort{0}; ///< For sending, use 0 to send to the connected remote host
+};
+
+/**
+ * @brief Handler for a batch of received datagrams
+ * @param connection
+ * @param datagrams Array of datagrams, in order of arrival. Data is only valid until the handler returns.
+ * @param count Number of datagrams, always at least 1
+ */
+using UdpConnectionBatchDelegate =
+	Delegate<void(UdpConnection& connection, const UdpDatagram* datagrams, unsigned count)>;
+
 class UdpConnection : public IpConnection
 {
 public:
@@ -44,6 +78,16 @@ public:
 
 	virtual bool listen(int port);
 	virtual bool connect(IpAddress ip, uint16_t port);
+
+	/**
+	 * @brief Connect to a host by name
+	 * @param host Host name, or address in dotted decimal form
+	 * @param port
+	 * @retval bool true if connected or lookup in progress
+	 * @note Host names are resolved using the shared DnsCache.
+	 * If the name is not cached, the connection is made once the lookup completes.
+	 */
+	bool connect(const String& host, uint16_t port);
 	virtual void close();
 
 	// After connect(..)
@@ -71,6 +115,51 @@ public:
 		return sendTo(remoteIP, remotePort, data.c_str(), data.length());
 	}
 
+	/**
+	 * @brief Send a number of datagrams
+	 * @param datagrams
+	 * @param count
+	 * @retval unsigned Number of datagrams sent. Sending stops at the first failure.
+	 *
+	 * Datagrams of up to UDP_SEND_POOL_BUFFER_SIZE bytes are copied into buffers which the connection
+	 * keeps for re-use, avoiding a heap allocation for each one. A buffer is only re-used once the
+	 * network stack has finished with it, so a fresh buffer is allocated if all are still in use.
+	 */
+	unsigned sendBatch(const UdpDatagram* datagrams, unsigned count);
+
+	/**
+	 * @brief Set a handler to receive datagrams in batches
+	 * @param handler Use nullptr to revert to receiving datagrams individually
+	 *
+	 * Incoming datagrams are queued, without copying, and passed to the handler together from a task callback.
+	 * This replaces the data callback and `onReceive()`.
+	 * Any datagrams still queued when the handler is removed are passed to `onReceive()` instead.
+	 * At most UDP_RECEIVE_BATCH_SIZE datagrams are queued: any more are dropped until the handler has run.
+	 */
+	void setBatchReceiveHandler(UdpConnectionBatchDelegate handler)
+	{
+		onBatchCallback = handler;
+	}
+
+	/**
+	 * @brief Get number of datagrams dropped because the batch receive queue was full
+	 */
+	unsigned getDroppedCount() const
+	{
+		return droppedCount;
+	}
+
+	/**
+	 * @brief Get number of buffers allocated by `sendBatch()`
+	 *
+	 * Pooled buffers are allocated once and then re-used, so this only increases further when
+	 * all pooled buffers are in use or datagrams are too large for them.
+	 */
+	unsigned getSendAllocCount() const
+	{
+		return sendAllocCount;
+	}
+
 	/**
 	 * @brief Sets the UDP multicast IP.
 	 * @param ip
@@ -99,9 +188,22 @@ protected:
 	bool initialize(udp_pcb* pcb = nullptr);
 	static void staticOnReceive(void* arg, struct udp_pcb* pcb, struct pbuf* p, LWIP_IP_ADDR_T* addr, u16_t port);
 
+private:
+	struct SendPool;
+	struct ReceiveQueue;
+
+	void queueReceive(pbuf* buf, IpAddress remoteIP, uint16_t remotePort);
+
 protected:
 	udp_pcb* udp = nullptr;
 	UdpConnectionDataDelegate onDataCallback = nullptr;
+
+private:
+	UdpConnectionBatchDelegate onBatchCallback;
+	SendPool* sendPool{nullptr};
+	ReceiveQueue* receiveQueue{nullptr};
+	unsigned droppedCount{0};
+	unsigned sendAllocCount{0};
 };
 
 /** @} */
@@ -22,22 +22,15 @@
  */
 int SerialBuffer::find(uint8_t c)
 {
-	size_t offset = readPos;
-	size_t pos = 0;
-	size_t avail = available();
-	while(pos < avail) {
-		if(buffer[offset + pos] == c) {
-			return pos;
-		}
-
-		pos++;
-		if(pos + offset == writePos) {
-			break;
-		}
-
-		if(pos + offset == size) {
-			offset = -pos;
+	uint8_t buf[32];
+	size_t offset = 0;
+	size_t count;
+	while((count = ring.peek(buf, sizeof(buf), offset)) != 0) {
+		auto p = static_cast<const uint8_t*>(memchr(buf, c, count));
+		if(p != nullptr) {
+			return offset + (p - buf);
 		}
+		offset += count;
 	}
 
 	return -1;
@@ -46,30 +39,24 @@ int SerialBuffer::find(uint8_t c)
 // Must be called with interrupts disabled
 size_t SerialBuffer::resize(size_t newSize)
 {
-	if(size == newSize) {
-		return size;
+	newSize = ring.roundSize(newSize);
+	if(getSize() == newSize) {
+		return newSize;
 	}
 
 #ifdef ARCH_ESP32
 	// Avoid allocating in SPIRAM
-	auto new_buf = static_cast<char*>(heap_caps_malloc(newSize, MALLOC_CAP_DEFAULT | MALLOC_CAP_INTERNAL));
+	auto new_buf = static_cast<uint8_t*>(heap_caps_malloc(newSize, MALLOC_CAP_DEFAULT | MALLOC_CAP_INTERNAL));
 #else
-	auto new_buf = new char[newSize];
+	auto new_buf = new uint8_t[newSize];
 #endif
 	if(new_buf == nullptr) {
-		return size;
-	}
-
-	size_t new_wpos = 0;
-	size_t avail = available();
-	while(avail-- && new_wpos < newSize) {
-		new_buf[new_wpos++] = readChar();
+		return getSize();
 	}
 
-	delete[] buffer;
-	buffer = new_buf;
-	size = newSize;
-	readPos = 0;
-	writePos = new_wpos;
-	return size;
+	auto count = ring.read(new_buf, newSize);
+	delete[] ring.getBuffer();
+	ring.setBuffer(new_buf, newSize);
+	ring.commitWrite(count);
+	return newSize;
 }
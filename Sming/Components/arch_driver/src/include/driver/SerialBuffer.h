@@ -15,22 +15,24 @@
 #include <cstddef>
 #include <cstdint>
 #include <sming_attr.h>
+#include <Data/Buffer/SpscRing.h>
 
 /** @brief FIFO buffer used for both receive and transmit data
  *  @note For receive operations, data is written via ISR and read via task
  *  	  For transmit operations, data is written via task and read via ISR
  *  Only routines marked with __forceinline or IRAM_ATTR may be called from interrupt context.
+ *  Buffer size is always a power of 2.
  */
 struct SerialBuffer {
 public:
 	~SerialBuffer()
 	{
-		delete[] buffer;
+		delete[] ring.getBuffer();
 	}
 
 	size_t getSize()
 	{
-		return size;
+		return ring.getSize();
 	}
 
 	/** @brief get number of bytes stored in the buffer
@@ -38,11 +40,7 @@ public:
 	 */
 	__forceinline size_t available()
 	{
-		int ret = writePos - readPos;
-		if(ret < 0) {
-			ret += size;
-		}
-		return ret;
+		return ring.available();
 	}
 
 	/** @brief get number of bytes of space available in this buffer
@@ -50,24 +48,17 @@ public:
 	 */
 	__forceinline size_t getFreeSpace()
 	{
-		if(buffer == nullptr) {
-			return 0;
-		}
-		int ret = readPos - writePos - 1;
-		if(ret < 0) {
-			ret += size;
-		}
-		return ret;
+		return ring.getFreeSpace();
 	}
 
 	__forceinline bool isEmpty()
 	{
-		return (buffer == nullptr) || (writePos == readPos);
+		return ring.isEmpty();
 	}
 
 	__forceinline bool isFull()
 	{
-		return getFreeSpace() == 0;
+		return ring.isFull();
 	}
 
 	/** @brief see if there's anything in the buffer
@@ -75,7 +66,8 @@ public:
 	 */
 	__forceinline int peekChar()
 	{
-		return isEmpty() ? -1 : buffer[readPos];
+		auto p = ring.peek();
+		return p ? *p : -1;
 	}
 
 	/*
@@ -83,30 +75,19 @@ public:
 	 */
 	__forceinline int peekLastChar()
 	{
-		return isEmpty() ? -1 : buffer[getPrevPos(writePos)];
+		auto p = ring.peekLast();
+		return p ? *p : -1;
 	}
 
 	__forceinline int readChar()
 	{
-		if(isEmpty()) {
-			return -1;
-		}
-
-		uint8_t c = buffer[readPos];
-		readPos = getNextPos(readPos);
-		return c;
+		uint8_t c;
+		return ring.pop(c) ? c : -1;
 	}
 
 	__forceinline size_t writeChar(uint8_t c)
 	{
-		size_t nextPos = getNextPos(writePos);
-		if(nextPos == readPos) {
-			return 0;
-		}
-
-		buffer[writePos] = c;
-		writePos = nextPos;
-		return 1;
+		return ring.push(c) ? 1 : 0;
 	}
 
 	/** @brief find a character in the buffer
@@ -115,12 +96,17 @@ public:
 	 */
 	int find(uint8_t c);
 
-	// Must be called with interrupts disabled
+	/**
+	 * @brief Change buffer size
+	 * @param newSize Requested size, rounded up to a power of 2
+	 * @retval size_t New buffer size
+	 * @note Must be called with interrupts disabled
+	 */
 	size_t resize(size_t newSize);
 
 	void clear()
 	{
-		readPos = writePos = 0;
+		ring.clear();
 	}
 
 	/** @brief Access data directly within buffer
@@ -129,9 +115,10 @@ public:
 	 */
 	__forceinline size_t getReadData(void*& data)
 	{
-		data = buffer + readPos;
-		auto wp = writePos; // Guard against ISR changing value
-		return (wp < readPos) ? size - readPos : wp - readPos;
+		uint8_t* p;
+		auto len = ring.getReadSpan(p);
+		data = p;
+		return len;
 	}
 
 	/** @brief Skip a number of chars starting at the given read position
@@ -140,29 +127,9 @@ public:
 	 */
 	__forceinline void skipRead(size_t length)
 	{
-		readPos += length;
-		if(readPos == size) {
-			readPos = 0;
-		}
-	}
-
-private:
-	/** @brief Get the offset for the position before the current one */
-	__forceinline size_t getNextPos(size_t pos)
-	{
-		size_t n = pos + 1;
-		return (n == size) ? 0 : n;
-	}
-
-	/** @brief Get the offset for the position after the current one */
-	__forceinline size_t getPrevPos(size_t pos)
-	{
-		return (pos != 0 ? pos : size) - 1;
+		ring.commitRead(length);
 	}
 
 private:
-	size_t size = 0;
-	size_t readPos = 0;
-	size_t writePos = 0;
-	char* buffer = nullptr;
+	SpscRing<uint8_t> ring;
 };
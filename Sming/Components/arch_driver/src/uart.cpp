@@ -16,7 +16,7 @@ bool smg_uart_realloc_buffer(SerialBuffer*& buffer, size_t new_size)
 		}
 		smg_uart_restore_interrupts();
 
-		return res == new_size;
+		return res >= new_size;
 	}
 
 	if(new_size == 0) {
@@ -30,7 +30,7 @@ bool smg_uart_realloc_buffer(SerialBuffer*& buffer, size_t new_size)
 #else
 	auto new_buf = new SerialBuffer;
 #endif
-	if(new_buf != nullptr && new_buf->resize(new_size) == new_size) {
+	if(new_buf != nullptr && new_buf->resize(new_size) >= new_size) {
 		buffer = new_buf;
 		return true;
 	}
@@ -11,6 +11,28 @@ are returned in a single line of text. Anything longer is still wrapped.
 */
 
 #include "cencode.h"
+#include <stdint.h>
+
+static const char encoding[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/*
+ * Encode whole groups of 3 input bytes straight to 4 output characters,
+ * avoiding the per-byte state handling of base64_encode_block().
+ */
+static char* encode_groups(const uint8_t* in, unsigned groups, char* out)
+{
+	for (; groups != 0; --groups)
+	{
+		uint32_t n = ((uint32_t)in[0] << 16) | ((uint32_t)in[1] << 8) | in[2];
+		out[0] = encoding[n >> 18];
+		out[1] = encoding[(n >> 12) & 0x3f];
+		out[2] = encoding[(n >> 6) & 0x3f];
+		out[3] = encoding[n & 0x3f];
+		in += 3;
+		out += 4;
+	}
+	return out;
+}
 
 void base64_init_encodestate(base64_encodestate* state_in, unsigned chars_per_line)
 {
@@ -22,7 +44,6 @@ void base64_init_encodestate(base64_encodestate* state_in, unsigned chars_per_li
 
 char base64_encode_value(char value_in)
 {
-	static const char* encoding = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 	if (value_in > 63) return '=';
 	return encoding[(int)value_in];
 }
@@ -42,6 +63,24 @@ unsigned base64_encode_block(const char* plaintext_in, int length_in, char* code
 		while (1)
 		{
 	case step_A:
+			/* Encode as many complete groups as possible, one line at a time */
+			while (plaintextend - plainchar >= 3)
+			{
+				unsigned groups = (plaintextend - plainchar) / 3;
+				if (state_in->steps_per_line != 0 && groups >= state_in->steps_per_line - state_in->stepcount)
+				{
+					groups = state_in->steps_per_line - state_in->stepcount;
+					codechar = encode_groups((const uint8_t*)plainchar, groups, codechar);
+					*codechar++ = '\n';
+					state_in->stepcount = 0;
+				}
+				else
+				{
+					codechar = encode_groups((const uint8_t*)plainchar, groups, codechar);
+					state_in->stepcount += groups;
+				}
+				plainchar += groups * 3;
+			}
 			if (plainchar == plaintextend)
 			{
 				state_in->result = result;
@@ -12,6 +12,11 @@ ifeq ($(ENABLE_MALLOC_COUNT),1)
 
 COMPONENT_CXXFLAGS += -DENABLE_MALLOC_COUNT=1
 
+# Number of call sites to track allocations for. Must be a power of 2, 0 to disable.
+COMPONENT_VARS += MALLOC_COUNT_SITES
+MALLOC_COUNT_SITES ?= 0
+COMPONENT_CXXFLAGS += -DMALLOC_COUNT_SITES=$(MALLOC_COUNT_SITES)
+
 # Hook all the memory allocation functions we need to monitor heap activity
 MC_WRAP_FUNCS := \
 	malloc \
@@ -30,6 +30,7 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <functional>
 
 namespace MallocCount
@@ -83,6 +84,98 @@ using Callback = std::function<void(size_t current)>;
  */
 void setCallback(Callback callback);
 
+/**
+ * @brief Get the number of blocks currently allocated
+ */
+size_t getBlockCount(void);
+
+/**
+ * @brief Allocation statistics for a single call site
+ */
+struct SiteInfo {
+	const void* caller; ///< Address of code which called malloc(), etc. nullptr for sites which didn't fit the table
+	size_t count;		///< Number of blocks currently allocated
+	size_t bytes;		///< Number of bytes currently allocated
+	size_t total;		///< Total number of allocations made
+};
+
+/**
+ * @brief Get allocation statistics by call site
+ * @param sites Buffer to receive information
+ * @param maxSites Number of entries in buffer
+ * @retval size_t Number of entries written, sorted by decreasing current allocation size.
+ * Always 0 unless built with MALLOC_COUNT_SITES set.
+ *
+ * Call sites are the immediate callers of the heap functions. On Host, addresses may be resolved
+ * using `addr2line`. On embedded devices, use `make decode-stacktrace` or look them up in the .map file.
+ */
+size_t getSites(SiteInfo* sites, size_t maxSites);
+
+/**
+ * @brief Print allocation sites with largest current usage
+ * @param maxSites Maximum number of sites to print (up to 16)
+ */
+void printSites(size_t maxSites = 10);
+
+/**
+ * @brief Describes free heap memory
+ *
+ * Free blocks are sorted into power-of-two sized buckets:
+ * `histogram[0]` counts blocks of less than 32 bytes, `histogram[1]` is 32 - 63 bytes, and so on.
+ * The final bucket includes all larger blocks.
+ */
+struct HeapSnapshot {
+	static constexpr unsigned bucketCount{16};
+
+	size_t freeBytes;				 ///< Total free memory found
+	size_t freeBlocks;				 ///< Number of free blocks found
+	size_t largestBlock;			 ///< Size of largest block which may be allocated
+	uint16_t histogram[bucketCount]; ///< Number of free blocks in each size bucket
+
+	/**
+	 * @brief Get smallest block size counted in a bucket
+	 */
+	static constexpr size_t getBucketSize(unsigned bucket)
+	{
+		return (bucket == 0) ? 0 : (16U << bucket);
+	}
+
+	/**
+	 * @brief Get heap fragmentation as a percentage
+	 * @retval unsigned 0 when all free memory is in a single block, approaching 100 as it fragments
+	 */
+	unsigned getFragmentation() const
+	{
+		return (freeBytes == 0) ? 0 : 100 - (largestBlock * 100 / freeBytes);
+	}
+};
+
+/**
+ * @brief Get the size of the largest block which may currently be allocated
+ *
+ * Determined by probing the underlying allocator, so takes some time.
+ */
+size_t getLargestFreeBlock(void);
+
+/**
+ * @brief Take a snapshot of free heap memory
+ * @param snapshot Receives results
+ *
+ * The heap allocator doesn't provide this information directly, so free blocks are found
+ * by repeatedly allocating the largest available block until none remain. All blocks are then released.
+ * This takes some time and temporarily exhausts the heap, so must not be called where interrupt handlers
+ * or other threads may allocate memory.
+ *
+ * Allocator overheads mean the total will be a little less than `system_get_free_heap_size()`.
+ * On Host, the heap is notional and will always appear as a single block.
+ */
+void getHeapSnapshot(HeapSnapshot& snapshot);
+
+/**
+ * @brief Print a heap snapshot
+ */
+void printHeapSnapshot(const HeapSnapshot& snapshot);
+
 /**
  * @brief Enable/disable logging
  */
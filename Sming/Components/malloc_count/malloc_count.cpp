@@ -40,6 +40,12 @@
 #include "include/malloc_count.h"
 #include <debug_progmem.h>
 #include <esp_attr.h>
+#include <esp_systemapi.h>
+#include <algorithm>
+
+#ifndef MALLOC_COUNT_SITES
+#define MALLOC_COUNT_SITES 0
+#endif
 
 // Names for the actual implementations
 #ifdef ARCH_ESP8266
@@ -75,11 +81,22 @@ namespace
 bool logEnabled{false};
 size_t logThreshold{256};
 
+/* output */
+#define PPREFIX "MC## "
+
 #ifdef ENABLE_MALLOC_COUNT
 
+/* bookkeeping data stored at the start of each allocation */
+struct Header {
+	size_t size; // Requested allocation size
+#if MALLOC_COUNT_SITES
+	size_t site; // Index into site table
+#endif
+};
+
 /* to each allocation additional data is added for bookkeeping. due to
  * alignment requirements, we can optionally add more than just one integer. */
-constexpr size_t alignment{16}; /* bytes (>= 2*sizeof(size_t)) */
+constexpr size_t alignment{std::max(size_t(16), (sizeof(Header) + sizeof(size_t) + 15) & ~size_t(15))};
 
 /* a sentinel value prefixed to each allocation */
 constexpr size_t sentinel{0xDEADC0DE};
@@ -96,9 +113,6 @@ size_t* getSentinel(void* ptr)
 	return offsetPointer<size_t*>(ptr, -sizeof(size_t));
 }
 
-/* output */
-#define PPREFIX "MC## "
-
 #define log(fmt, ...)                                                                                                  \
 	if(logEnabled) {                                                                                                   \
 		debug_i(PPREFIX fmt, ##__VA_ARGS__);                                                                           \
@@ -115,6 +129,7 @@ struct Stats {
 	size_t current; // Current memory allocated
 	size_t total;   // Cumulative memory allocated
 	size_t count;   // Number of allocations called
+	size_t blocks;  // Number of blocks currently allocated
 };
 
 Stats stats{};
@@ -134,6 +149,7 @@ void inc_count(size_t inc)
 		stats.peak = stats.current;
 	}
 	++stats.count;
+	++stats.blocks;
 
 	if(userCallback) {
 		userCallback(stats.current);
@@ -144,13 +160,148 @@ void inc_count(size_t inc)
 void dec_count(size_t dec)
 {
 	stats.current -= dec;
+	--stats.blocks;
 	if(userCallback) {
 		userCallback(stats.current);
 	}
 }
 
+#if MALLOC_COUNT_SITES
+
+static_assert((MALLOC_COUNT_SITES & (MALLOC_COUNT_SITES - 1)) == 0, "MALLOC_COUNT_SITES must be a power of 2");
+
+/* allocation statistics for each call site, in a hash table.
+ * The final entry collects allocations from sites which don't fit. */
+MallocCount::SiteInfo sites[MALLOC_COUNT_SITES + 1];
+
+size_t findSite(const void* caller)
+{
+	auto hash = (uint32_t(uintptr_t(caller) >> 2) * 2654435761U) >> 16;
+	for(unsigned i = 0; i < MALLOC_COUNT_SITES; ++i) {
+		auto index = (hash + i) & (MALLOC_COUNT_SITES - 1);
+		auto& site = sites[index];
+		if(site.caller == caller) {
+			return index;
+		}
+		if(site.caller == nullptr) {
+			site.caller = caller;
+			return index;
+		}
+	}
+	return MALLOC_COUNT_SITES;
+}
+
+#endif
+
+/* record allocation against call site */
+void addSite(Header& header, const void* caller)
+{
+#if MALLOC_COUNT_SITES
+	header.site = findSite(caller);
+	auto& site = sites[header.site];
+	++site.count;
+	site.bytes += header.size;
+	++site.total;
+#else
+	(void)header;
+	(void)caller;
+#endif
+}
+
+/* remove allocation from call site statistics */
+void removeSite(const Header& header)
+{
+#if MALLOC_COUNT_SITES
+	auto& site = sites[header.site];
+	--site.count;
+	site.bytes -= header.size;
+#else
+	(void)header;
+#endif
+}
+
+void* allocate(size_t size, const void* caller)
+{
+	if(size == 0) {
+		return nullptr;
+	}
+
+	if(allocationLimit != 0 && stats.current + size > allocationLimit) {
+		log("malloc(%u) -> exceeds maximum (current is %u bytes)", size, stats.current);
+		return nullptr;
+	}
+
+	/* call read malloc procedure in libc */
+	void* ret = REAL(F_MALLOC)(alignment + size);
+
+	if(ret == nullptr) {
+		log("malloc(%u) failed", size);
+		return ret;
+	}
+
+	/* prepend allocation size and check sentinel */
+	auto header = static_cast<Header*>(ret);
+	header->size = size;
+	addSite(*header, caller);
+	ret = offsetPointer(ret, alignment);
+	*getSentinel(ret) = sentinel;
+
+	inc_count(size);
+	if(size >= logThreshold) {
+		log("malloc(%u) = %p (cur %u)", size, ret, stats.current);
+	}
+
+	return ret;
+}
+
+void* zallocate(size_t size, const void* caller)
+{
+	auto ptr = allocate(size, caller);
+	if(ptr != nullptr) {
+		memset(ptr, 0, size);
+	}
+	return ptr;
+}
+
 #endif // ENABLE_MALLOC_COUNT
 
+/* allocate directly from heap, bypassing statistics */
+void* rawAlloc(size_t size)
+{
+#ifdef ENABLE_MALLOC_COUNT
+	return REAL(F_MALLOC)(size);
+#else
+	return malloc(size);
+#endif
+}
+
+void rawFree(void* ptr)
+{
+#ifdef ENABLE_MALLOC_COUNT
+	REAL(F_FREE)(ptr);
+#else
+	free(ptr);
+#endif
+}
+
+/* find the largest block which can be allocated, up to the given limit */
+size_t findLargestBlock(size_t limit)
+{
+	size_t low{0};
+	size_t high{limit};
+	while(low < high) {
+		auto size = low + (high - low + 1) / 2;
+		auto ptr = rawAlloc(size);
+		if(ptr == nullptr) {
+			high = size - 1;
+		} else {
+			rawFree(ptr);
+			low = size;
+		}
+	}
+	return low;
+}
+
 } // namespace
 
 namespace MallocCount
@@ -199,6 +350,117 @@ size_t getAllocCount()
 	return stats.count;
 }
 
+size_t getBlockCount()
+{
+	return stats.blocks;
+}
+
+size_t getSites(SiteInfo* list, size_t maxSites)
+{
+#if defined(ENABLE_MALLOC_COUNT) && MALLOC_COUNT_SITES
+	// Insertion sort into caller's buffer so we don't need to allocate memory
+	size_t count{0};
+	for(auto& site : sites) {
+		if(site.total == 0) {
+			continue;
+		}
+		size_t i = count;
+		while(i > 0 && list[i - 1].bytes < site.bytes) {
+			if(i < maxSites) {
+				list[i] = list[i - 1];
+			}
+			--i;
+		}
+		if(i < maxSites) {
+			list[i] = site;
+			if(count < maxSites) {
+				++count;
+			}
+		}
+	}
+	return count;
+#else
+	(void)list;
+	(void)maxSites;
+	return 0;
+#endif
+}
+
+void printSites(size_t maxSites)
+{
+	SiteInfo list[16];
+	auto count = getSites(list, std::min(maxSites, sizeof(list) / sizeof(list[0])));
+	for(unsigned i = 0; i < count; ++i) {
+		auto& site = list[i];
+		m_printf(PPREFIX "%p: %u bytes in %u blocks, %u allocations\r\n", site.caller, site.bytes, site.count,
+				 site.total);
+	}
+}
+
+size_t getLargestFreeBlock()
+{
+	return findLargestBlock(system_get_free_heap_size());
+}
+
+void getHeapSnapshot(HeapSnapshot& snapshot)
+{
+	snapshot = HeapSnapshot{};
+
+	// Allocated blocks are chained together, so no additional memory is required
+	struct Block {
+		Block* next;
+	};
+	Block* list{nullptr};
+
+	size_t remaining = system_get_free_heap_size();
+	size_t limit = remaining;
+	while(remaining >= sizeof(Block)) {
+		auto size = findLargestBlock(std::min(limit, remaining));
+		if(size < sizeof(Block)) {
+			break;
+		}
+		auto block = static_cast<Block*>(rawAlloc(size));
+		if(block == nullptr) {
+			break;
+		}
+		block->next = list;
+		list = block;
+
+		if(snapshot.freeBlocks == 0) {
+			snapshot.largestBlock = size;
+		}
+		++snapshot.freeBlocks;
+		snapshot.freeBytes += size;
+		unsigned bucket{0};
+		for(auto n = size >> 5; n != 0 && bucket < HeapSnapshot::bucketCount - 1; n >>= 1) {
+			++bucket;
+		}
+		if(snapshot.histogram[bucket] != UINT16_MAX) {
+			++snapshot.histogram[bucket];
+		}
+
+		limit = size;
+		remaining -= std::min(size, remaining);
+	}
+
+	while(list != nullptr) {
+		auto next = list->next;
+		rawFree(list);
+		list = next;
+	}
+}
+
+void printHeapSnapshot(const HeapSnapshot& snapshot)
+{
+	m_printf(PPREFIX "%u bytes free in %u blocks, largest %u, fragmentation %u%%\r\n", snapshot.freeBytes,
+			 snapshot.freeBlocks, snapshot.largestBlock, snapshot.getFragmentation());
+	for(unsigned i = 0; i < HeapSnapshot::bucketCount; ++i) {
+		if(snapshot.histogram[i] != 0) {
+			m_printf(PPREFIX "  >= %6u: %u\r\n", HeapSnapshot::getBucketSize(i), snapshot.histogram[i]);
+		}
+	}
+}
+
 /* sets the maximum available memory */
 void setAllocLimit(size_t maxBytes)
 {
@@ -219,43 +481,12 @@ void setCallback(Callback callback)
 
 extern "C" void* mc_malloc(size_t size)
 {
-	if(size == 0) {
-		return nullptr;
-	}
-
-	if(allocationLimit != 0 && stats.current + size > allocationLimit) {
-		log("malloc(%u) -> exceeds maximum (current is %u bytes)", size, stats.current);
-		return nullptr;
-	}
-
-	/* call read malloc procedure in libc */
-	void* ret = REAL(F_MALLOC)(alignment + size);
-
-	if(ret == nullptr) {
-		log("malloc(%u) failed", size);
-		return ret;
-	}
-
-	/* prepend allocation size and check sentinel */
-	*static_cast<size_t*>(ret) = size;
-	ret = offsetPointer(ret, alignment);
-	*getSentinel(ret) = sentinel;
-
-	inc_count(size);
-	if(size >= logThreshold) {
-		log("malloc(%u) = %p (cur %u)", size, ret, stats.current);
-	}
-
-	return ret;
+	return allocate(size, __builtin_return_address(0));
 }
 
 extern "C" void* mc_zalloc(size_t size)
 {
-	auto ptr = mc_malloc(size);
-	if(ptr != nullptr) {
-		memset(ptr, 0, size);
-	}
-	return ptr;
+	return zallocate(size, __builtin_return_address(0));
 }
 
 extern "C" void mc_free(void* ptr)
@@ -273,7 +504,9 @@ extern "C" void mc_free(void* ptr)
 		*p_sentinel = 0; // Clear sentinel to avoid false-positives
 		ptr = offsetPointer(ptr, -alignment);
 
-		size_t size = *static_cast<size_t*>(ptr);
+		auto header = static_cast<Header*>(ptr);
+		size_t size = header->size;
+		removeSite(*header);
 		dec_count(size);
 
 		if(size >= logThreshold) {
@@ -286,7 +519,7 @@ extern "C" void mc_free(void* ptr)
 
 extern "C" void* mc_calloc(size_t nmemb, size_t size)
 {
-	return mc_zalloc(nmemb * size);
+	return zallocate(nmemb * size, __builtin_return_address(0));
 }
 
 extern "C" void* mc_realloc(void* ptr, size_t size)
@@ -297,9 +530,11 @@ extern "C" void* mc_realloc(void* ptr, size_t size)
 		return nullptr;
 	}
 
+	auto caller = __builtin_return_address(0);
+
 	// special case ptr == 0 -> malloc()
 	if(ptr == nullptr) {
-		return mc_malloc(size);
+		return allocate(size, caller);
 	}
 
 	if(*getSentinel(ptr) != sentinel) {
@@ -316,7 +551,7 @@ extern "C" void* mc_realloc(void* ptr, size_t size)
 
 	ptr = offsetPointer(ptr, -alignment);
 
-	size_t oldsize = *static_cast<size_t*>(ptr);
+	size_t oldsize = static_cast<Header*>(ptr)->size;
 
 	void* newptr = REAL(F_REALLOC)(ptr, alignment + size);
 
@@ -325,7 +560,11 @@ extern "C" void* mc_realloc(void* ptr, size_t size)
 		return nullptr;
 	}
 
+	auto header = static_cast<Header*>(newptr);
+	removeSite(*header);
 	dec_count(oldsize);
+	header->size = size;
+	addSite(*header, caller);
 	inc_count(size);
 
 	if(size >= logThreshold) {
@@ -337,14 +576,24 @@ extern "C" void* mc_realloc(void* ptr, size_t size)
 		}
 	}
 
-	*static_cast<size_t*>(newptr) = size;
-
 	return offsetPointer(newptr, alignment);
 }
 
 static __attribute__((destructor)) void finish()
 {
 	log("exiting, total: %u, peak: %u, current: %u", stats.total, stats.peak, stats.current);
+
+#ifdef ARCH_HOST
+	// Leak report: includes anything with static storage which hasn't yet been destroyed
+	m_printf(PPREFIX "%u bytes in %u blocks still allocated\r\n", stats.current, stats.blocks);
+#if MALLOC_COUNT_SITES
+	for(auto& site : sites) {
+		if(site.count != 0) {
+			m_printf(PPREFIX "  %p: %u bytes in %u blocks\r\n", site.caller, site.bytes, site.count);
+		}
+	}
+#endif
+#endif
 }
 
 #endif // ENABLE_MALLOC_COUNT
@@ -382,22 +631,22 @@ extern "C" void WRAP(vPortFree)(void*) __attribute__((alias("mc_free")));
 
 void* operator new(size_t size)
 {
-	return mc_malloc(size);
+	return allocate(size, __builtin_return_address(0));
 }
 
 void* operator new(size_t size, const std::nothrow_t&) noexcept
 {
-	return mc_malloc(size);
+	return allocate(size, __builtin_return_address(0));
 }
 
 void* operator new[](size_t size)
 {
-	return mc_malloc(size);
+	return allocate(size, __builtin_return_address(0));
 }
 
 void* operator new[](size_t size, const std::nothrow_t&) noexcept
 {
-	return mc_malloc(size);
+	return allocate(size, __builtin_return_address(0));
 }
 
 void operator delete(void* ptr)
@@ -429,7 +678,7 @@ void operator delete[](void* ptr, size_t)
 extern "C" char* WRAP(strdup)(const char* s)
 {
 	auto len = strlen(s) + 1;
-	auto dup = static_cast<char*>(mc_malloc(len));
+	auto dup = static_cast<char*>(allocate(len, __builtin_return_address(0)));
 	memcpy(dup, s, len);
 	return dup;
 }
@@ -0,0 +1,457 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * Coroutine.h
+ *
+ *	Stackless coroutines scheduled via the system task queue.
+ *
+ *	Multi-step operations (read sensor, wait, post result, wait for response) can be written
+ *	as straight-line code instead of a hand-written state machine.
+ *
+ *	Two styles are supported:
+ *
+ *	- A `Coroutine` class whose `run()` method uses the `CO_BEGIN()`, `CO_AWAIT()`, etc. macros.
+ *	  This works with any C++ standard and requires no heap allocation.
+ *	- Where the toolchain supports C++20 coroutines, any function returning `Co::Routine`
+ *	  can `co_await` the same awaitable objects.
+ *
+ *	In both cases awaiting is allocation-free: a suspended coroutine is resumed by posting a
+ *	plain function callback via `System.queueCallback()`.
+ *
+ ****/
+
+#pragma once
+
+#include "Task.h"
+#include <HardwareSerial.h>
+#include <debug_progmem.h>
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define SMING_CPP_COROUTINES 1
+#endif
+#endif
+
+namespace Co
+{
+/**
+ * @brief Identifies a suspended coroutine and how to resume it
+ */
+struct Waiter {
+	TaskCallback callback;
+	void* param;
+
+	explicit operator bool() const
+	{
+		return callback != nullptr;
+	}
+};
+
+/**
+ * @brief Base class for objects which a coroutine can wait on
+ *
+ * Inherited classes call `signal()` when the event has occurred, which schedules
+ * resumption of any waiting coroutine. Each awaitable supports a single waiter.
+ *
+ * @note For `Coroutine` classes, awaitables must persist across suspension points
+ * so are normally class members.
+ */
+class Awaitable
+{
+public:
+	Awaitable() = default;
+	Awaitable(const Awaitable&) = delete;
+	Awaitable& operator=(const Awaitable&) = delete;
+
+	/**
+	 * @brief Determine if the awaited event has occurred
+	 */
+	bool isReady() const
+	{
+		return ready;
+	}
+
+	/**
+	 * @brief Clear ready state so the object can be awaited again
+	 */
+	void reset()
+	{
+		ready = false;
+	}
+
+	/**
+	 * @brief Register a coroutine to be resumed on signal
+	 * @note If the event has already occurred the waiter is resumed immediately
+	 */
+	void setWaiter(Waiter w)
+	{
+		waiter = w;
+		if(ready) {
+			wake();
+		}
+	}
+
+#ifdef SMING_CPP_COROUTINES
+	auto operator co_await()
+	{
+		struct Awaiter {
+			Awaitable& awaitable;
+
+			bool await_ready() const
+			{
+				return awaitable.isReady();
+			}
+
+			void await_suspend(std::coroutine_handle<> handle)
+			{
+				awaitable.setWaiter({resumeHandle, handle.address()});
+			}
+
+			void await_resume()
+			{
+			}
+		};
+
+		return Awaiter{*this};
+	}
+#endif
+
+protected:
+	/**
+	 * @brief Mark event as having occurred and schedule any waiting coroutine
+	 */
+	void signal()
+	{
+		ready = true;
+		wake();
+	}
+
+private:
+	void wake()
+	{
+		auto w = waiter;
+		waiter = {};
+		if(w) {
+			w.callback(w.param);
+		}
+	}
+
+#ifdef SMING_CPP_COROUTINES
+	static void resumeHandle(void* address)
+	{
+		auto resume = [](void* address) { std::coroutine_handle<>::from_address(address).resume(); };
+
+		// Resume from the task queue, not from within the signalling code, unless the queue is full
+		if(!System.queueCallback(resume, address)) {
+			debug_w("[CO] Task queue full, resuming immediately");
+			resume(address);
+		}
+	}
+#endif
+
+	Waiter waiter{};
+	bool ready{false};
+};
+
+/**
+ * @brief General-purpose event which application code signals directly
+ */
+class Event : public Awaitable
+{
+public:
+	using Awaitable::signal;
+};
+
+/**
+ * @brief Awaitable which becomes ready after a given interval
+ */
+class Timer : public Awaitable
+{
+public:
+	Timer() = default;
+
+	/**
+	 * @brief Construct and start timer
+	 */
+	explicit Timer(unsigned intervalMs)
+	{
+		start(intervalMs);
+	}
+
+	void start(unsigned intervalMs)
+	{
+		reset();
+		timer.initializeMs(
+			intervalMs, [](void* param) { static_cast<Timer*>(param)->signal(); }, this);
+		timer.startOnce();
+	}
+
+	void stop()
+	{
+		timer.stop();
+	}
+
+private:
+	SimpleTimer timer;
+};
+
+/**
+ * @brief Awaitable which becomes ready when serial data is available
+ * @note The serial port data received callback is used whilst waiting,
+ * and cleared once the requested amount of data has arrived.
+ */
+class SerialData : public Awaitable
+{
+public:
+	explicit SerialData(HardwareSerial& serial) : serial(serial)
+	{
+	}
+
+	/**
+	 * @brief Construct and start waiting for data
+	 */
+	SerialData(HardwareSerial& serial, size_t count) : serial(serial)
+	{
+		start(count);
+	}
+
+	/**
+	 * @brief Start waiting
+	 * @param count Number of characters required
+	 */
+	void start(size_t count = 1)
+	{
+		reset();
+		required = count;
+		if(size_t(serial.available()) >= required) {
+			signal();
+			return;
+		}
+		serial.onDataReceived([this](Stream&, char, uint16_t availableCharsCount) {
+			if(availableCharsCount < required) {
+				return;
+			}
+			// Delegate is destroyed here so don't access any captured values afterwards
+			auto self = this;
+			self->serial.onDataReceived(nullptr);
+			self->signal();
+		});
+	}
+
+private:
+	HardwareSerial& serial;
+	size_t required{0};
+};
+
+#ifdef SMING_CPP_COROUTINES
+
+/**
+ * @brief Return type for C++20 coroutines scheduled via the task queue
+ *
+ * Coroutines start executing immediately and run until their first suspension point.
+ * The coroutine frame is allocated once when the coroutine is called; awaiting does not allocate.
+ *
+ * Example:
+ *
+ * 		Co::Routine blink()
+ * 		{
+ * 			for(;;) {
+ * 				digitalWrite(LED_PIN, HIGH);
+ * 				co_await Co::Timer(500);
+ * 				digitalWrite(LED_PIN, LOW);
+ * 				co_await Co::Timer(500);
+ * 			}
+ * 		}
+ */
+struct Routine {
+	struct promise_type {
+		Routine get_return_object()
+		{
+			return {};
+		}
+
+		std::suspend_never initial_suspend() noexcept
+		{
+			return {};
+		}
+
+		std::suspend_never final_suspend() noexcept
+		{
+			return {};
+		}
+
+		void return_void()
+		{
+		}
+
+		void unhandled_exception()
+		{
+			abort();
+		}
+	};
+};
+
+#endif
+
+} // namespace Co
+
+/**
+ * @brief Stackless coroutine implemented as a Task
+ *
+ * Override `run()` using the `CO_xxx` macros:
+ *
+ * 		class Sensor : public Coroutine
+ * 		{
+ * 		protected:
+ * 			void run() override
+ * 			{
+ * 				CO_BEGIN();
+ * 				for(;;) {
+ * 					startConversion();
+ * 					CO_SLEEP(750);
+ * 					readResult();
+ * 					response.send(client, createRequest());
+ * 					CO_AWAIT(response);
+ * 					CO_SLEEP(60000);
+ * 				}
+ * 				CO_END();
+ * 			}
+ * 		};
+ *
+ * Call `resume()` to start the coroutine.
+ *
+ * @note Local variables are not preserved across suspension points: use class members.
+ * `switch` statements must not contain suspension points, and only one CO_xxx macro may appear on each line.
+ * Do not delete the coroutine from within `onFinished()`.
+ */
+class Coroutine : public Task
+{
+public:
+	/**
+	 * @brief Determine if coroutine has run to completion
+	 */
+	bool isFinished() const
+	{
+		return coLine == finishedLine;
+	}
+
+	/**
+	 * @brief Reset coroutine so it runs from the beginning when next resumed
+	 */
+	void restart()
+	{
+		coLine = 0;
+	}
+
+protected:
+	/**
+	 * @brief Inherited classes implement the coroutine body here
+	 */
+	virtual void run() = 0;
+
+	/**
+	 * @brief Called when coroutine completes
+	 */
+	virtual void onFinished()
+	{
+	}
+
+	/*
+	 * Used by CO_AWAIT
+	 */
+	bool checkAwait(Co::Awaitable& awaitable)
+	{
+		if(awaitable.isReady()) {
+			return true;
+		}
+		suspend();
+		awaitable.setWaiter({resumeWaiter, this});
+		return false;
+	}
+
+	/*
+	 * Used by CO_END
+	 */
+	void finish()
+	{
+		coLine = finishedLine;
+		suspend();
+		onFinished();
+	}
+
+	uint16_t coLine{0}; ///< Resumption point, used by CO_xxx macros
+
+private:
+	static constexpr uint16_t finishedLine{0xffff};
+
+	static void resumeWaiter(void* param)
+	{
+		auto coroutine = static_cast<Coroutine*>(param);
+		// Task queue is full, so try again shortly
+		if(!coroutine->resume()) {
+			coroutine->sleep(1);
+		}
+	}
+
+	void loop() override
+	{
+		if(!isFinished()) {
+			run();
+		}
+	}
+};
+
+/**
+ * @brief Start of coroutine body
+ */
+#define CO_BEGIN()                                                                                                     \
+	switch(coLine) {                                                                                                   \
+	case 0:
+
+/**
+ * @brief Suspend until awaitable object is ready
+ * @param awaitable The `Co::Awaitable` object, which must already have been started
+ * @note The argument is evaluated on every resumption so must not have side-effects
+ */
+#define CO_AWAIT(awaitable)                                                                                            \
+	do {                                                                                                               \
+		coLine = __LINE__;                                                                                             \
+		[[fallthrough]];                                                                                               \
+	case __LINE__:                                                                                                     \
+		if(!checkAwait(awaitable)) {                                                                                   \
+			return;                                                                                                    \
+		}                                                                                                              \
+	} while(0)
+
+/**
+ * @brief Allow other tasks to run, then continue
+ */
+#define CO_YIELD()                                                                                                     \
+	do {                                                                                                               \
+		coLine = __LINE__;                                                                                             \
+		return;                                                                                                        \
+	case __LINE__:;                                                                                                    \
+	} while(0)
+
+/**
+ * @brief Suspend for a period of time
+ * @param ms Time in milliseconds
+ */
+#define CO_SLEEP(ms)                                                                                                   \
+	do {                                                                                                               \
+		coLine = __LINE__;                                                                                             \
+		sleep(ms);                                                                                                     \
+		return;                                                                                                        \
+	case __LINE__:;                                                                                                    \
+	} while(0)
+
+/**
+ * @brief End of coroutine body
+ */
+#define CO_END()                                                                                                       \
+	}                                                                                                                  \
+	finish()
@@ -17,19 +17,7 @@
 
 uint16_t CircularBuffer::readMemoryBlock(char* data, int bufSize)
 {
-	size_t bytesAvailable = available();
-	size_t sizeToRead = (size_t(bufSize) < bytesAvailable) ? bufSize : bytesAvailable;
-	size_t sizeRead = sizeToRead;
-	char* start = readPos;
-	if(writePos < readPos && sizeToRead > (size_t)((buffer + size) - readPos)) {
-		size_t topSize = (buffer + size) - readPos;
-		memcpy(data, readPos, topSize);
-		start = buffer;
-		sizeToRead -= topSize;
-		data += topSize;
-	}
-	memcpy(data, start, sizeToRead);
-	return sizeRead;
+	return ring.peek(data, bufSize);
 }
 
 bool CircularBuffer::seek(int len)
@@ -39,58 +27,6 @@ bool CircularBuffer::seek(int len)
 		return false;
 	}
 
-	if(readPos < writePos) {
-		readPos += len;
-	} else if(readPos + len > buffer + size) {
-		readPos = buffer + (len - (buffer + size - readPos));
-	} else {
-		readPos += len;
-	}
-
+	ring.commitRead(len);
 	return true;
 }
-
-int CircularBuffer::available()
-{
-	if(writePos >= readPos) {
-		return writePos - readPos;
-	}
-	return size - (readPos - writePos);
-}
-
-size_t CircularBuffer::room() const
-{
-	if(writePos >= readPos) {
-		return size - (writePos - readPos) - 1;
-	}
-	return readPos - writePos - 1;
-}
-
-size_t CircularBuffer::write(uint8_t charToWrite)
-{
-	if(room() == 0) {
-		return 0;
-	}
-
-	*writePos = charToWrite;
-	writePos = wrap(writePos + 1);
-
-	return 1;
-}
-
-size_t CircularBuffer::write(const uint8_t* data, size_t bufSize)
-{
-	size_t space = room();
-	size_t sizeToWrite = (bufSize < space) ? bufSize : space;
-	size_t sizeWritten = sizeToWrite;
-	if(writePos >= readPos && sizeToWrite > (size_t)(buffer + size - writePos)) {
-		size_t topSize = buffer + size - writePos;
-		memcpy(writePos, data, topSize);
-		writePos = buffer;
-		sizeToWrite -= topSize;
-		data += topSize;
-	}
-	memcpy(writePos, data, sizeToWrite);
-	writePos = wrap(writePos + sizeToWrite);
-	return sizeWritten;
-}
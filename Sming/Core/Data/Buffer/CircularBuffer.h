@@ -16,6 +16,7 @@
 #pragma once
 
 #include "Data/Stream/ReadWriteStream.h"
+#include "SpscRing.h"
 
 /**
  * @brief      Circular stream class
@@ -28,13 +29,21 @@
 class CircularBuffer : public ReadWriteStream
 {
 public:
-	CircularBuffer(int size) : buffer(new char[size]), readPos(buffer), writePos(buffer), size(size)
+	/**
+	 * @brief Constructor
+	 * @param size Requested buffer size, rounded up to a power of 2
+	 * @note Writing to the buffer and reading from it may be done in different contexts,
+	 * such as an interrupt handler and a task, without locking.
+	 */
+	CircularBuffer(int size)
 	{
+		auto ringSize = ring.roundSize(size);
+		ring.setBuffer(new char[ringSize], ringSize);
 	}
 
 	~CircularBuffer()
 	{
-		delete[] buffer;
+		delete[] ring.getBuffer();
 	}
 
 	/** @brief  Get the stream type
@@ -72,7 +81,10 @@ public:
 	 * @brief Return the total length of the stream
 	 * @retval int -1 is returned when the size cannot be determined
 	 */
-	int available() override;
+	int available() override
+	{
+		return ring.available();
+	}
 
 	/**
 	 * @brief Returns unique id of the resource.
@@ -80,41 +92,54 @@ public:
 	 */
 	String id() const override
 	{
-		return String(reinterpret_cast<uintptr_t>(&buffer), HEX);
+		return String(reinterpret_cast<uintptr_t>(ring.getBuffer()), HEX);
 	}
 
-	size_t write(uint8_t charToWrite) override;
+	size_t write(uint8_t charToWrite) override
+	{
+		return ring.push(charToWrite) ? 1 : 0;
+	}
 
 	/** @brief  Write chars to stream
      *  @param  data Pointer to buffer to write to the stream
      *  @param  size Quantity of chars to written
      *  @retval size_t Quantity of chars written to stream
      */
-	size_t write(const uint8_t* data, size_t size) override;
+	size_t write(const uint8_t* data, size_t size) override
+	{
+		return ring.write(reinterpret_cast<const char*>(data), size);
+	}
 
 	/** @brief Get the maximum number of bytes for which write() will succeed
 		@retval size_t
 	*/
-	size_t room() const;
+	size_t room() const
+	{
+		return ring.getFreeSpace();
+	}
 
 	// Stream::flush()
 	void flush() override
 	{
-		readPos = buffer;
-		writePos = buffer;
+		ring.clear();
 	}
 
-private:
-	inline char* wrap(char* ptr) const
+	/**
+	 * @brief Get contiguous data for direct reading, such as writing to a TCP connection
+	 * @param data OUT: Start of data
+	 * @retval size_t Number of bytes available at `data`
+	 * @note Call `seek()` to consume data
+	 */
+	size_t getReadSpan(const char*& data) const
 	{
-		return (ptr == buffer + size) ? buffer : ptr;
+		char* p;
+		auto len = ring.getReadSpan(p);
+		data = p;
+		return len;
 	}
 
 private:
-	char* buffer = nullptr;
-	char* readPos = nullptr;
-	char* writePos = nullptr;
-	int size = 0;
+	SpscRing<char> ring;
 };
 
 /** @} */
@@ -0,0 +1,341 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * SpscRing.h - Lock-free single-producer, single-consumer ring buffer
+ *
+ ****/
+
+#pragma once
+
+#include <sming_attr.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @brief Lock-free ring buffer for passing data between one producer and one consumer
+ * @tparam T Element type, must be trivially copyable
+ *
+ * Typically the producer is an interrupt handler and the consumer a task, or vice versa.
+ * No locking or interrupt masking is required provided that:
+ *
+ * - Producer methods (`push`, `write`, `getWriteSpan`, `commitWrite`) are only called from one context
+ * - Consumer methods (`pop`, `read`, `peek`, `getReadSpan`, `commitRead`, `clear`) are only called
+ *   from one other context
+ *
+ * Status methods such as `available()` may be called from either context.
+ *
+ * Read and write positions run freely and are masked on access, so the size must be a power of 2
+ * and the full capacity of the buffer is usable.
+ *
+ * All methods are inline and use only `memcpy`, so may be called from IRAM code.
+ *
+ * Storage is provided by the caller. For example:
+ *
+ * 		uint8_t storage[256];
+ * 		SpscRing<uint8_t> ring(storage, sizeof(storage));
+ *
+ * The span methods allow data to be passed directly to or from DMA or network buffers without copying:
+ *
+ * 		uint8_t* data;
+ * 		size_t len;
+ * 		while((len = ring.getReadSpan(data)) != 0) {
+ * 			len = send(data, len);
+ * 			ring.commitRead(len);
+ * 		}
+ */
+template <typename T> class SpscRing
+{
+	static_assert(std::is_trivially_copyable<T>::value, "SpscRing requires a trivially copyable type");
+
+public:
+	SpscRing() = default;
+
+	/**
+	 * @brief Construct ring using the given storage
+	 * @param buffer Storage for elements
+	 * @param size Number of elements in buffer, must be a power of 2
+	 */
+	SpscRing(T* buffer, size_t size)
+	{
+		setBuffer(buffer, size);
+	}
+
+	SpscRing(const SpscRing&) = delete;
+	SpscRing& operator=(const SpscRing&) = delete;
+
+	/**
+	 * @brief Assign storage and discard any content
+	 * @param buffer Storage for elements
+	 * @param size Number of elements in buffer, must be a power of 2
+	 * @retval bool false if size is not a power of 2
+	 * @note Must not be called whilst producer or consumer are active
+	 */
+	bool setBuffer(T* buffer, size_t size)
+	{
+		if(!isPowerOfTwo(size)) {
+			return false;
+		}
+		this->buffer = buffer;
+		capacity = (buffer == nullptr) ? 0 : size;
+		writeIndex.store(0, std::memory_order_relaxed);
+		readIndex.store(0, std::memory_order_relaxed);
+		return true;
+	}
+
+	T* getBuffer() const
+	{
+		return buffer;
+	}
+
+	/**
+	 * @brief Get the number of elements the ring can hold
+	 */
+	size_t getSize() const
+	{
+		return capacity;
+	}
+
+	/**
+	 * @brief Get number of elements stored in the ring
+	 */
+	__forceinline size_t available() const
+	{
+		return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * @brief Get number of elements which can be written
+	 */
+	__forceinline size_t getFreeSpace() const
+	{
+		return capacity - available();
+	}
+
+	__forceinline bool isEmpty() const
+	{
+		return available() == 0;
+	}
+
+	__forceinline bool isFull() const
+	{
+		return getFreeSpace() == 0;
+	}
+
+	/**
+	 * @name Producer methods
+	 * @{
+	 */
+
+	/**
+	 * @brief Append a single element
+	 * @retval bool false if ring is full
+	 */
+	__forceinline bool push(const T& item)
+	{
+		auto wi = writeIndex.load(std::memory_order_relaxed);
+		if(wi - readIndex.load(std::memory_order_acquire) == capacity) {
+			return false;
+		}
+		buffer[wi & (capacity - 1)] = item;
+		writeIndex.store(wi + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @brief Append multiple elements
+	 * @retval size_t Number of elements written, less than `count` if ring is full
+	 */
+	__forceinline size_t write(const T* data, size_t count)
+	{
+		auto wi = writeIndex.load(std::memory_order_relaxed);
+		auto space = capacity - (wi - readIndex.load(std::memory_order_acquire));
+		if(count > space) {
+			count = space;
+		}
+		copyIn(wi, data, count);
+		writeIndex.store(wi + count, std::memory_order_release);
+		return count;
+	}
+
+	/**
+	 * @brief Get contiguous free space for direct writing
+	 * @param data OUT: Where to write data
+	 * @retval size_t Number of elements which may be written
+	 * @note After writing, call `commitWrite()`. The total free space may be larger than the span
+	 * if it wraps around the end of the buffer.
+	 */
+	__forceinline size_t getWriteSpan(T*& data)
+	{
+		auto wi = writeIndex.load(std::memory_order_relaxed);
+		auto space = capacity - (wi - readIndex.load(std::memory_order_acquire));
+		auto offset = wi & (capacity - 1);
+		data = buffer + offset;
+		return std::min(space, capacity - offset);
+	}
+
+	/**
+	 * @brief Make elements written directly into buffer available to the consumer
+	 * @param count Must not exceed value returned from `getWriteSpan()`
+	 */
+	__forceinline void commitWrite(size_t count)
+	{
+		writeIndex.store(writeIndex.load(std::memory_order_relaxed) + count, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Get the most recently written element
+	 * @retval const T* nullptr if ring is empty
+	 */
+	__forceinline const T* peekLast() const
+	{
+		return isEmpty() ? nullptr : &buffer[(writeIndex.load(std::memory_order_relaxed) - 1) & (capacity - 1)];
+	}
+
+	/** @} */
+
+	/**
+	 * @name Consumer methods
+	 * @{
+	 */
+
+	/**
+	 * @brief Remove a single element
+	 * @retval bool false if ring is empty
+	 */
+	__forceinline bool pop(T& item)
+	{
+		auto ri = readIndex.load(std::memory_order_relaxed);
+		if(writeIndex.load(std::memory_order_acquire) == ri) {
+			return false;
+		}
+		item = buffer[ri & (capacity - 1)];
+		readIndex.store(ri + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @brief Get the next element without removing it
+	 * @retval const T* nullptr if ring is empty
+	 */
+	__forceinline const T* peek() const
+	{
+		auto ri = readIndex.load(std::memory_order_relaxed);
+		if(writeIndex.load(std::memory_order_acquire) == ri) {
+			return nullptr;
+		}
+		return &buffer[ri & (capacity - 1)];
+	}
+
+	/**
+	 * @brief Copy elements without removing them
+	 * @param data Destination
+	 * @param count Maximum number of elements to copy
+	 * @param offset Number of elements to skip
+	 * @retval size_t Number of elements copied
+	 */
+	__forceinline size_t peek(T* data, size_t count, size_t offset = 0) const
+	{
+		auto ri = readIndex.load(std::memory_order_relaxed);
+		auto avail = writeIndex.load(std::memory_order_acquire) - ri;
+		if(offset >= avail) {
+			return 0;
+		}
+		avail -= offset;
+		if(count > avail) {
+			count = avail;
+		}
+		copyOut(ri + offset, data, count);
+		return count;
+	}
+
+	/**
+	 * @brief Remove multiple elements
+	 * @retval size_t Number of elements read
+	 */
+	__forceinline size_t read(T* data, size_t count)
+	{
+		count = peek(data, count);
+		commitRead(count);
+		return count;
+	}
+
+	/**
+	 * @brief Get contiguous data for direct reading
+	 * @param data OUT: Start of data
+	 * @retval size_t Number of elements available at `data`
+	 * @note After reading, call `commitRead()`. More data may be available if it wraps around
+	 * the end of the buffer.
+	 */
+	__forceinline size_t getReadSpan(T*& data) const
+	{
+		auto ri = readIndex.load(std::memory_order_relaxed);
+		auto avail = writeIndex.load(std::memory_order_acquire) - ri;
+		auto offset = ri & (capacity - 1);
+		data = buffer + offset;
+		return std::min(avail, capacity - offset);
+	}
+
+	/**
+	 * @brief Discard elements which have been read
+	 * @param count Must not exceed value returned from `available()`
+	 */
+	__forceinline void commitRead(size_t count)
+	{
+		readIndex.store(readIndex.load(std::memory_order_relaxed) + count, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Discard all content
+	 */
+	__forceinline void clear()
+	{
+		readIndex.store(writeIndex.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+	/** @} */
+
+	static constexpr bool isPowerOfTwo(size_t size)
+	{
+		return (size & (size - 1)) == 0;
+	}
+
+	/**
+	 * @brief Round a requested size up to the nearest valid ring size
+	 */
+	static constexpr size_t roundSize(size_t size)
+	{
+		size_t n = 1;
+		while(n < size) {
+			n <<= 1;
+		}
+		return n;
+	}
+
+private:
+	__forceinline void copyIn(size_t index, const T* data, size_t count)
+	{
+		auto offset = index & (capacity - 1);
+		auto len = std::min(count, capacity - offset);
+		memcpy(&buffer[offset], data, len * sizeof(T));
+		memcpy(buffer, data + len, (count - len) * sizeof(T));
+	}
+
+	__forceinline void copyOut(size_t index, T* data, size_t count) const
+	{
+		auto offset = index & (capacity - 1);
+		auto len = std::min(count, capacity - offset);
+		memcpy(data, &buffer[offset], len * sizeof(T));
+		memcpy(data + len, buffer, (count - len) * sizeof(T));
+	}
+
+	T* buffer{nullptr};
+	size_t capacity{0};
+	std::atomic<size_t> writeIndex{0}; ///< Updated only by producer
+	std::atomic<size_t> readIndex{0};  ///< Updated only by consumer
+};
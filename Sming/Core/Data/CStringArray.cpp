@@ -53,14 +53,26 @@ bool CStringArray::add(const char* str, int length)
 
 int CStringArray::indexOf(const char* str, bool ignoreCase) const
 {
-	for(auto it = begin(); it != end(); ++it) {
-		if(ignoreCase) {
-			if(it.equalsIgnoreCase(str)) {
-				return it.index();
+	if(str == nullptr) {
+		return -1;
+	}
+
+	// Locate each terminating NUL directly so entries of the wrong length are skipped without comparison
+	auto strLength = strlen(str);
+	auto buf = cbuffer();
+	auto len = length();
+	int index = 0;
+	for(size_t offset = 0; offset < len; ++index) {
+		auto entry = buf + offset;
+		auto entryEnd = static_cast<const char*>(memchr_fast(entry, '\0', len - offset));
+		size_t entryLength = entryEnd ? entryEnd - entry : len - offset;
+		if(entryLength == strLength) {
+			int cmp = ignoreCase ? memicmp(entry, str, strLength) : memcmp(entry, str, strLength);
+			if(cmp == 0) {
+				return index;
 			}
-		} else if(it.equals(str)) {
-			return it.index();
 		}
+		offset += entryLength + 1;
 	}
 
 	return -1;
@@ -0,0 +1,158 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * InternedString.cpp
+ *
+ ****/
+
+#include "InternedString.h"
+#include "PerfectHash.h"
+
+/*
+ * Each entry is stored as a 16-bit length followed by the NUL-terminated string content.
+ * The hash table points at the content, so the length is found just before it.
+ */
+namespace
+{
+constexpr size_t entryHeaderSize{sizeof(uint16_t)};
+constexpr size_t initialTableSize{16};
+
+size_t getEntryLength(const char* entry)
+{
+	auto p = reinterpret_cast<const uint8_t*>(entry) - entryHeaderSize;
+	return p[0] | (p[1] << 8);
+}
+
+uint32_t getHash(const char* str, size_t length)
+{
+	return PerfectHash::hash(str, length, 0, false);
+}
+
+} // namespace
+
+StringPool::~StringPool()
+{
+	while(head != nullptr) {
+		auto next = head->next;
+		free(head);
+		head = next;
+	}
+	free(table);
+}
+
+StringPool& StringPool::global()
+{
+	static StringPool pool;
+	return pool;
+}
+
+int StringPool::findSlot(const char* str, size_t length, uint32_t hash) const
+{
+	auto mask = tableSize - 1;
+	for(auto i = hash & mask;; i = (i + 1) & mask) {
+		auto entry = table[i];
+		if(entry == nullptr) {
+			return -int(i) - 1;
+		}
+		if(getEntryLength(entry) == length && memcmp(entry, str, length) == 0) {
+			return i;
+		}
+	}
+}
+
+const char* StringPool::find(const char* str, size_t length) const
+{
+	if(tableSize == 0 || str == nullptr) {
+		return nullptr;
+	}
+	int slot = findSlot(str, length, getHash(str, length));
+	return (slot >= 0) ? table[slot] : nullptr;
+}
+
+const char* StringPool::intern(const char* str, size_t length)
+{
+	if(str == nullptr || length > UINT16_MAX) {
+		return nullptr;
+	}
+
+	// Keep load factor below 75%
+	if((entryCount + 1) * 4 > tableSize * 3 && !grow()) {
+		return nullptr;
+	}
+
+	int slot = findSlot(str, length, getHash(str, length));
+	if(slot >= 0) {
+		return table[slot];
+	}
+
+	auto entry = store(str, length);
+	if(entry == nullptr) {
+		return nullptr;
+	}
+	table[-slot - 1] = entry;
+	++entryCount;
+	return entry;
+}
+
+char* StringPool::store(const char* str, size_t length)
+{
+	size_t required = entryHeaderSize + length + 1;
+
+	Block* block = head;
+	if(block == nullptr || block->size - block->used < required) {
+		size_t size = (required > blockSize) ? required : blockSize;
+		block = static_cast<Block*>(malloc(sizeof(Block) + size));
+		if(block == nullptr) {
+			return nullptr;
+		}
+		block->size = size;
+		block->used = 0;
+		memoryUsed += sizeof(Block) + size;
+		// Oversized blocks go behind the current one so its free space can still be used
+		if(head != nullptr && size > blockSize) {
+			block->next = head->next;
+			head->next = block;
+		} else {
+			block->next = head;
+			head = block;
+		}
+	}
+
+	auto p = block->data() + block->used;
+	block->used += required;
+	p[0] = length & 0xff;
+	p[1] = length >> 8;
+	p += entryHeaderSize;
+	memcpy(p, str, length);
+	p[length] = '\0';
+	return p;
+}
+
+bool StringPool::grow()
+{
+	auto newSize = tableSize ? tableSize * 2 : initialTableSize;
+	auto newTable = static_cast<const char**>(calloc(newSize, sizeof(const char*)));
+	if(newTable == nullptr) {
+		return false;
+	}
+
+	auto oldTable = table;
+	auto oldSize = tableSize;
+	table = newTable;
+	tableSize = newSize;
+	for(size_t i = 0; i < oldSize; ++i) {
+		auto entry = oldTable[i];
+		if(entry != nullptr) {
+			auto length = getEntryLength(entry);
+			int slot = findSlot(entry, length, getHash(entry, length));
+			table[-slot - 1] = entry;
+		}
+	}
+	free(oldTable);
+
+	memoryUsed += (newSize - oldSize) * sizeof(const char*);
+	return true;
+}
@@ -0,0 +1,217 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * InternedString.h - Shared storage for frequently repeated strings
+ *
+ ****/
+
+#pragma once
+
+#include <WString.h>
+
+/**
+ * @brief Stores a single copy of each distinct string
+ *
+ * String content is packed into fixed-size blocks allocated from the heap, and is never released
+ * until the pool is destroyed. Use for strings drawn from a limited set which recur throughout the
+ * life of the program, such as header names, JSON keys or topic names.
+ * Don't use it for arbitrary user-supplied content, as the pool would grow without limit.
+ *
+ * Most applications should use the global pool via `InternedString`.
+ */
+class StringPool
+{
+public:
+	static constexpr uint16_t defaultBlockSize{256};
+
+	/**
+	 * @brief Constructor
+	 * @param blockSize Size of each storage block. Longer strings are allocated individually.
+	 */
+	StringPool(uint16_t blockSize = defaultBlockSize) : blockSize(blockSize)
+	{
+	}
+
+	~StringPool();
+
+	StringPool(const StringPool&) = delete;
+	StringPool& operator=(const StringPool&) = delete;
+
+	/**
+	 * @brief Get the pooled copy of a string, adding it if required
+	 * @param str
+	 * @param length Up to 65535 characters
+	 * @retval const char* NUL-terminated copy of the string, nullptr if memory is exhausted
+	 */
+	const char* intern(const char* str, size_t length);
+
+	/**
+	 * @brief Find the pooled copy of a string without adding it
+	 * @retval const char* nullptr if string is not in the pool
+	 */
+	const char* find(const char* str, size_t length) const;
+
+	/**
+	 * @brief Get number of distinct strings stored
+	 */
+	size_t count() const
+	{
+		return entryCount;
+	}
+
+	/**
+	 * @brief Get total heap memory used by the pool, including index
+	 */
+	size_t getMemoryUsed() const
+	{
+		return memoryUsed;
+	}
+
+	/**
+	 * @brief The pool used by `InternedString`
+	 */
+	static StringPool& global();
+
+private:
+	struct Block {
+		Block* next;
+		uint32_t size;
+		uint32_t used;
+
+		char* data()
+		{
+			return reinterpret_cast<char*>(this + 1);
+		}
+	};
+
+	int findSlot(const char* str, size_t length, uint32_t hash) const;
+	char* store(const char* str, size_t length);
+	bool grow();
+
+	Block* head{nullptr};
+	const char** table{nullptr}; ///< Open-addressed hash table of stored strings
+	size_t tableSize{0};
+	size_t entryCount{0};
+	size_t memoryUsed{0};
+	uint16_t blockSize;
+};
+
+/**
+ * @brief Handle to a string stored in a StringPool
+ *
+ * Equal strings from the same pool always share the same storage, so comparing two handles
+ * is a pointer comparison. Handles are small and trivially copyable, so may be stored contiguously
+ * in a `ContiguousVector` or `SmallMap` with no heap allocation per entry.
+ * They also work as `HashMap` keys, but the default `HashMap` allocates each key and value separately.
+ *
+ * Example:
+ *
+ * 		SmallMap<InternedString, String, 8> vars;	// Up to 8 entries without using the heap
+ * 		vars[InternedString("title")] = "Hello";
+ *
+ * 		InternedString key("title");	// No allocation: existing pool entry found
+ * 		String& value = vars[key];	// Compares pointers, not content
+ *
+ * @note Comparison by identity only works for handles from the same pool.
+ */
+class InternedString
+{
+public:
+	InternedString() = default;
+
+	InternedString(const char* str, size_t length, StringPool& pool = StringPool::global())
+		: data(pool.intern(str, length)), len(data ? length : 0)
+	{
+	}
+
+	InternedString(const char* str, StringPool& pool = StringPool::global())
+		: InternedString(str, str ? strlen(str) : 0, pool)
+	{
+	}
+
+	InternedString(const String& str, StringPool& pool = StringPool::global())
+		: InternedString(str.c_str(), str.length(), pool)
+	{
+	}
+
+	/**
+	 * @brief Get handle for a string only if it has already been interned
+	 * @retval InternedString Invalid if string is not in the pool
+	 *
+	 * Use when looking up keys from external input, so unknown values don't grow the pool.
+	 */
+	static InternedString find(const char* str, size_t length, const StringPool& pool = StringPool::global())
+	{
+		InternedString s;
+		s.data = pool.find(str, length);
+		s.len = s.data ? length : 0;
+		return s;
+	}
+
+	static InternedString find(const String& str, const StringPool& pool = StringPool::global())
+	{
+		return find(str.c_str(), str.length(), pool);
+	}
+
+	explicit operator bool() const
+	{
+		return data != nullptr;
+	}
+
+	const char* c_str() const
+	{
+		return data ?: "";
+	}
+
+	size_t length() const
+	{
+		return len;
+	}
+
+	bool operator==(const InternedString& other) const
+	{
+		return data == other.data;
+	}
+
+	bool operator!=(const InternedString& other) const
+	{
+		return data != other.data;
+	}
+
+	bool equals(const char* str, size_t length) const
+	{
+		return length == len && memcmp(c_str(), str, length) == 0;
+	}
+
+	bool operator==(const char* str) const
+	{
+		return equals(str, str ? strlen(str) : 0);
+	}
+
+	bool operator==(const String& str) const
+	{
+		return equals(str.c_str(), str.length());
+	}
+
+	String toString() const
+	{
+		return String(c_str(), len);
+	}
+
+	operator String() const
+	{
+		return toString();
+	}
+
+private:
+	const char* data{nullptr};
+	uint16_t len{0};
+};
+
+inline String toString(const InternedString& str)
+{
+	return str.toString();
+}
@@ -0,0 +1,341 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * PerfectHash.h - Compile-time perfect hash lookup tables
+ *
+ ****/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <sys/pgmspace.h>
+
+/**
+ * @defgroup perfect_hash Perfect hash tables
+ * @brief Compile-time lookup tables for fixed sets of strings
+ * @{
+ */
+
+namespace PerfectHash
+{
+/**
+ * @brief Hash a string, optionally ignoring case
+ *
+ * Uses FNV-1a with a seed, followed by a final mix so the low bits are well distributed.
+ */
+constexpr uint32_t hash(const char* str, size_t length, uint32_t seed, bool ignoreCase)
+{
+	uint32_t h = 2166136261U ^ (seed * 0x9E3779B9U);
+	for(size_t i = 0; i < length; ++i) {
+		auto c = uint8_t(str[i]);
+		if(ignoreCase && c >= 'A' && c <= 'Z') {
+			c += 'a' - 'A';
+		}
+		h = (h ^ c) * 16777619U;
+	}
+	h ^= h >> 16;
+	h *= 0x85EBCA6BU;
+	h ^= h >> 13;
+	return h;
+}
+
+constexpr size_t stringLength(const char* str)
+{
+	size_t len = 0;
+	while(str[len] != '\0') {
+		++len;
+	}
+	return len;
+}
+
+/**
+ * @brief Get total length of a set of keys
+ */
+template <size_t keyCount> constexpr size_t getDataSize(const char* const (&keys)[keyCount])
+{
+	size_t size = 0;
+	for(auto key : keys) {
+		size += stringLength(key);
+	}
+	return size;
+}
+
+/**
+ * @brief Get table size for a given number of keys: a power of 2 with at least twice as many slots
+ */
+constexpr size_t getTableSize(size_t keyCount)
+{
+	size_t size = 4;
+	while(size < keyCount * 2) {
+		size <<= 1;
+	}
+	return size;
+}
+
+/**
+ * @brief Get number of displacement buckets for a table, averaging two keys per bucket
+ */
+constexpr size_t getBucketCount(size_t tableSize)
+{
+	return tableSize / 4;
+}
+
+// Not constexpr, so using this in a constant expression fails compilation
+inline void seedNotFound()
+{
+}
+
+/**
+ * @brief Perfect hash map from a fixed set of string keys to their index
+ * @tparam keyCount Number of keys, up to 254
+ * @tparam dataSize Total length of all keys
+ * @tparam ignoreCase true for case-insensitive matching
+ * @tparam tableSize Number of hash slots, a power of 2
+ *
+ * The table is generated entirely at compile time using hash and displace (CHD).
+ * Keys are hashed into small buckets, and each bucket gets a displacement value which places
+ * all its keys in free slots. Largest buckets are placed first, whilst the table is emptiest.
+ * Lookup therefore needs just one hash calculation, one displacement read and one key comparison.
+ *
+ * Keys are stored within the map, so the source array of string literals is not required at runtime.
+ * Where a key appears more than once, the first index is returned, as with `Vector::indexOf()`.
+ *
+ * Define maps using `DEFINE_PERFECT_HASH_MAP` so they are stored in flash.
+ * All reads are aligned so are safe for flash memory.
+ */
+template <size_t keyCount, size_t dataSize, bool ignoreCase = true, size_t tableSize = getTableSize(keyCount)>
+class Map
+{
+	static_assert(keyCount < 255, "Too many keys");
+	static_assert(dataSize < 0x10000, "Keys too long");
+	static_assert((tableSize & (tableSize - 1)) == 0, "Table size must be a power of 2");
+
+	static constexpr size_t bucketCount{getBucketCount(tableSize)};
+	static_assert(bucketCount != 0, "Table too small");
+
+public:
+	static constexpr uint8_t emptySlot{0xff};
+
+	constexpr Map(const char* const (&keys)[keyCount])
+	{
+		size_t pos = 0;
+		for(size_t i = 0; i < keyCount; ++i) {
+			offsets[i] = pos;
+			for(auto s = keys[i]; *s != '\0'; ++s) {
+				data[pos++] = *s;
+			}
+		}
+		offsets[keyCount] = pos;
+
+		// Duplicates are skipped so first occurrence is found
+		bool duplicate[keyCount]{};
+		for(size_t i = 1; i < keyCount; ++i) {
+			for(size_t j = 0; j < i && !duplicate[i]; ++j) {
+				duplicate[i] = keyEquals(i, j);
+			}
+		}
+
+		// A different seed is only needed if keys have identical hashes
+		while(!tryBuild(duplicate)) {
+			if(++seed == 0x100) {
+				seedNotFound();
+			}
+		}
+	}
+
+	/**
+	 * @brief Find a key
+	 * @param key
+	 * @param length
+	 * @retval int Index of key, or -1 if not found
+	 */
+	int indexOf(const char* key, size_t length) const
+	{
+		if(key == nullptr) {
+			return -1;
+		}
+		auto h = hash(key, length, pgm_read_dword(&seed), ignoreCase);
+		uint16_t displacement = pgm_read_word(&displacements[h & (bucketCount - 1)]);
+		auto index = pgm_read_byte(&slots[getSlot(h, displacement)]);
+		if(index == emptySlot) {
+			return -1;
+		}
+		size_t offset = pgm_read_word(&offsets[index]);
+		if(pgm_read_word(&offsets[index + 1]) - offset != length) {
+			return -1;
+		}
+		return matches(offset, key, length) ? index : -1;
+	}
+
+	int indexOf(const char* key) const
+	{
+		return key ? indexOf(key, strlen(key)) : -1;
+	}
+
+	static constexpr size_t count()
+	{
+		return keyCount;
+	}
+
+	uint32_t getSeed() const
+	{
+		return pgm_read_dword(&seed);
+	}
+
+private:
+	static constexpr char toLower(char c)
+	{
+		return (c >= 'A' && c <= 'Z') ? c + 'a' - 'A' : c;
+	}
+
+	constexpr bool keyEquals(size_t i, size_t j) const
+	{
+		size_t len = offsets[i + 1] - offsets[i];
+		if(size_t(offsets[j + 1] - offsets[j]) != len) {
+			return false;
+		}
+		for(size_t n = 0; n < len; ++n) {
+			auto c1 = data[offsets[i] + n];
+			auto c2 = data[offsets[j] + n];
+			if(ignoreCase ? toLower(c1) != toLower(c2) : c1 != c2) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/*
+	 * Bucket is taken from the low bits of the hash, slot position and step from higher bits.
+	 * The step is odd so the first part of the displacement can reach every slot.
+	 */
+	static constexpr size_t getSlot(uint32_t hash, uint16_t displacement)
+	{
+		uint32_t base = hash >> 16;
+		uint32_t step = (hash >> 7) | 1;
+		return (base + (displacement % tableSize) * step + displacement / tableSize) & (tableSize - 1);
+	}
+
+	constexpr bool tryBuild(const bool (&duplicate)[keyCount])
+	{
+		for(auto& slot : slots) {
+			slot = emptySlot;
+		}
+		for(auto& d : displacements) {
+			d = 0;
+		}
+
+		// Hash each key once and group keys by bucket
+		uint32_t hashes[keyCount]{};
+		uint8_t bucketKeys[keyCount]{};
+		uint16_t bucketStart[bucketCount + 1]{};
+		for(size_t i = 0; i < keyCount; ++i) {
+			if(!duplicate[i]) {
+				hashes[i] = hash(&data[offsets[i]], offsets[i + 1] - offsets[i], seed, ignoreCase);
+				++bucketStart[(hashes[i] & (bucketCount - 1)) + 1];
+			}
+		}
+		size_t maxBucketSize = 0;
+		for(size_t b = 0; b < bucketCount; ++b) {
+			if(bucketStart[b + 1] > maxBucketSize) {
+				maxBucketSize = bucketStart[b + 1];
+			}
+			bucketStart[b + 1] += bucketStart[b];
+		}
+		uint16_t fill[bucketCount]{};
+		for(size_t i = 0; i < keyCount; ++i) {
+			if(!duplicate[i]) {
+				auto b = hashes[i] & (bucketCount - 1);
+				bucketKeys[bucketStart[b] + fill[b]++] = i;
+			}
+		}
+
+		for(size_t size = maxBucketSize; size != 0; --size) {
+			for(size_t b = 0; b < bucketCount; ++b) {
+				if(size_t(bucketStart[b + 1] - bucketStart[b]) != size) {
+					continue;
+				}
+				if(!placeBucket(b, &bucketKeys[bucketStart[b]], size, hashes)) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	constexpr bool placeBucket(size_t bucket, const uint8_t* keys, size_t keyCountInBucket,
+							   const uint32_t (&hashes)[keyCount])
+	{
+		constexpr uint32_t maxDisplacement = (tableSize * tableSize < 0x10000) ? tableSize * tableSize : 0x10000;
+		for(uint32_t d = 0; d < maxDisplacement; ++d) {
+			size_t placed = 0;
+			while(placed < keyCountInBucket) {
+				auto& slot = slots[getSlot(hashes[keys[placed]], d)];
+				if(slot != emptySlot) {
+					break;
+				}
+				slot = keys[placed++];
+			}
+			if(placed == keyCountInBucket) {
+				displacements[bucket] = d;
+				return true;
+			}
+			while(placed != 0) {
+				slots[getSlot(hashes[keys[--placed]], d)] = emptySlot;
+			}
+		}
+		return false;
+	}
+
+	/*
+	 * Compare stored key with a string in RAM, reading flash a word at a time
+	 */
+	bool matches(size_t offset, const char* key, size_t length) const
+	{
+		auto base = reinterpret_cast<uintptr_t>(data);
+		uint32_t word = 0;
+		for(size_t i = 0; i < length; ++i) {
+			auto addr = base + offset + i;
+			if(i == 0 || (addr & 3) == 0) {
+				word = pgm_read_dword(reinterpret_cast<const void*>(addr & ~uintptr_t(3)));
+			}
+			char c1 = word >> ((addr & 3) * 8);
+			char c2 = key[i];
+			if(ignoreCase ? toLower(c1) != toLower(c2) : c1 != c2) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	uint32_t seed{0};
+	uint16_t offsets[keyCount + 1]{};
+	uint8_t slots[tableSize]{};
+	uint16_t displacements[bucketCount]{};
+	alignas(4) char data[dataSize + 1]{};
+};
+
+} // namespace PerfectHash
+
+/**
+ * @brief Define a perfect hash map in flash
+ * @param name Name for the map variable
+ * @param keys constexpr array of string literals
+ * @param ignoreCase true for case-insensitive matching
+ *
+ * Example:
+ *
+ * 		constexpr const char* colourNames[]{"red", "green", "blue"};
+ * 		DEFINE_PERFECT_HASH_MAP(colourMap, colourNames, true);
+ *
+ * 		int i = colourMap.indexOf("Green"); // 1
+ */
+#define DEFINE_PERFECT_HASH_MAP(name, keys, ignoreCase)                                                                \
+	static constexpr PerfectHash::Map<sizeof(keys) / sizeof(keys[0]), PerfectHash::getDataSize(keys), ignoreCase>      \
+		name PROGMEM(keys)
+
+/** @} */
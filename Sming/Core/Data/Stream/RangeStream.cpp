@@ -0,0 +1,51 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * RangeStream.cpp
+ *
+ ****/
+
+#include "RangeStream.h"
+
+uint16_t RangeStream::readMemoryBlock(char* data, int bufSize)
+{
+	if(!source || bufSize <= 0 || pos >= length) {
+		return 0;
+	}
+
+	int offset = start + pos;
+	if(source->seekFrom(offset, SeekOrigin::Start) != offset) {
+		return 0;
+	}
+
+	size_t count = std::min(size_t(bufSize), size_t(length - pos));
+	return source->readMemoryBlock(data, count);
+}
+
+int RangeStream::seekFrom(int offset, SeekOrigin origin)
+{
+	int newPos;
+	switch(origin) {
+	case SeekOrigin::Start:
+		newPos = offset;
+		break;
+	case SeekOrigin::Current:
+		newPos = int(pos) + offset;
+		break;
+	case SeekOrigin::End:
+		newPos = int(length) + offset;
+		break;
+	default:
+		return -1;
+	}
+
+	if(newPos < 0 || newPos > int(length)) {
+		return -1;
+	}
+
+	pos = newPos;
+	return pos;
+}
@@ -0,0 +1,66 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * RangeStream.h
+ *
+ ****/
+
+#pragma once
+
+#include "DataSourceStream.h"
+#include <memory>
+
+/**
+ * @brief Read-only stream presenting part of a source stream
+ * @ingroup stream data
+ *
+ * The source must support random seeking. It may be shared by several RangeStream objects
+ * provided they are read one at a time, as each read seeks the source to the required position.
+ */
+class RangeStream : public IDataSourceStream
+{
+public:
+	/**
+	 * @brief Constructor
+	 * @param source Stream containing the data
+	 * @param start Position of the range within the source
+	 * @param length Number of bytes in the range
+	 */
+	RangeStream(std::shared_ptr<IDataSourceStream> source, uint32_t start, uint32_t length)
+		: source(source), start(start), length(length)
+	{
+	}
+
+	bool isValid() const override
+	{
+		return source && source->isValid();
+	}
+
+	int available() override
+	{
+		return length - pos;
+	}
+
+	uint16_t readMemoryBlock(char* data, int bufSize) override;
+
+	int seekFrom(int offset, SeekOrigin origin) override;
+
+	bool isFinished() override
+	{
+		return pos >= length;
+	}
+
+	String getName() const override
+	{
+		return source ? source->getName() : nullptr;
+	}
+
+private:
+	std::shared_ptr<IDataSourceStream> source;
+	uint32_t start;
+	uint32_t length;
+	uint32_t pos{0};
+};
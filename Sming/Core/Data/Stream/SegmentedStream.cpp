@@ -0,0 +1,127 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * SegmentedStream.cpp
+ *
+ ****/
+
+#include "SegmentedStream.h"
+#include <debug_progmem.h>
+
+SegmentedStream::Segment* SegmentedStream::allocateSegment()
+{
+	auto size = getBlockSize();
+	void* mem = allocator ? allocator->allocate(size) : malloc(size);
+	if(mem == nullptr) {
+		debug_e("SegmentedStream: failed to allocate %u bytes", size);
+		return nullptr;
+	}
+
+	auto segment = static_cast<Segment*>(mem);
+	segment->next = nullptr;
+	segment->length = 0;
+	if(tail == nullptr) {
+		head = segment;
+	} else {
+		tail->next = segment;
+	}
+	tail = segment;
+	++segmentCount;
+	return segment;
+}
+
+void SegmentedStream::releaseHead()
+{
+	auto segment = head;
+	head = segment->next;
+	if(head == nullptr) {
+		tail = nullptr;
+	}
+	headOffset = 0;
+	--segmentCount;
+	if(allocator) {
+		allocator->release(segment);
+	} else {
+		free(segment);
+	}
+}
+
+void SegmentedStream::clear()
+{
+	while(head != nullptr) {
+		releaseHead();
+	}
+	readPos = 0;
+	writePos = 0;
+}
+
+size_t SegmentedStream::write(const uint8_t* buffer, size_t size)
+{
+	size_t written = 0;
+	while(written < size) {
+		auto segment = tail;
+		if(segment == nullptr || segment->length == segmentSize) {
+			segment = allocateSegment();
+			if(segment == nullptr) {
+				break;
+			}
+		}
+		auto len = std::min(size - written, size_t(segmentSize - segment->length));
+		memcpy(segment->data() + segment->length, buffer + written, len);
+		segment->length += len;
+		written += len;
+	}
+
+	writePos += written;
+	return written;
+}
+
+uint16_t SegmentedStream::readMemoryBlock(char* data, int bufSize)
+{
+	size_t count = 0;
+	size_t offset = headOffset;
+	for(auto segment = head; segment != nullptr && count < size_t(bufSize); segment = segment->next) {
+		auto len = std::min(size_t(bufSize) - count, segment->length - offset);
+		memcpy(data + count, segment->data() + offset, len);
+		count += len;
+		offset = 0;
+	}
+	return count;
+}
+
+int SegmentedStream::seekFrom(int offset, SeekOrigin origin)
+{
+	size_t newPos;
+	switch(origin) {
+	case SeekOrigin::Start:
+		newPos = offset;
+		break;
+	case SeekOrigin::Current:
+		newPos = readPos + offset;
+		break;
+	case SeekOrigin::End:
+		newPos = writePos + offset;
+		break;
+	default:
+		return -1;
+	}
+
+	if(newPos < readPos || newPos > writePos) {
+		return -1;
+	}
+
+	auto count = newPos - readPos;
+	while(count != 0) {
+		auto len = std::min(count, size_t(head->length - headOffset));
+		headOffset += len;
+		count -= len;
+		if(headOffset == head->length) {
+			releaseHead();
+		}
+	}
+	readPos = newPos;
+	return readPos;
+}
@@ -0,0 +1,167 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * SegmentedStream.h
+ *
+ ****/
+
+#pragma once
+
+#include "ReadWriteStream.h"
+
+/**
+ * @brief Write-once, read-once memory stream built from a chain of fixed-size segments
+ *
+ * Intended for composing large responses (JSON, HTML, etc.) with `Print` methods or `<<`.
+ * Content is never stored contiguously so appending does not reallocate or copy existing data,
+ * and the largest single allocation is one segment regardless of the total size.
+ *
+ * Segments are released as they are read, so the stream may be passed directly to
+ * `HttpResponse::sendDataStream()` and the memory is returned as content is sent.
+ * Because the total size is known the response carries a `Content-Length` header.
+ *
+ * Example:
+ *
+ * 		auto stream = new SegmentedStream;
+ * 		*stream << '[';
+ * 		for(auto& item : items) {
+ * 			*stream << item.toJson() << ',';
+ * 		}
+ * 		*stream << ']';
+ * 		response.sendDataStream(stream, MIME_JSON);
+ *
+ * @ingroup stream
+ */
+class SegmentedStream : public ReadWriteStream
+{
+public:
+	/**
+	 * @brief Interface to provide segment memory from a custom source, such as a pool
+	 */
+	class Allocator
+	{
+	public:
+		virtual ~Allocator()
+		{
+		}
+
+		/**
+		 * @brief Obtain a block of memory
+		 * @param size Number of bytes required
+		 * @retval void* nullptr if no memory is available
+		 */
+		virtual void* allocate(size_t size) = 0;
+
+		/**
+		 * @brief Return a block obtained via `allocate()`
+		 */
+		virtual void release(void* ptr) = 0;
+	};
+
+	static constexpr uint16_t defaultSegmentSize{256};
+
+	/**
+	 * @brief Constructor
+	 * @param segmentSize Number of content bytes in each segment. 0 selects the default.
+	 * @param allocator If provided, used to allocate segments instead of the heap.
+	 * Each allocation is for `getBlockSize()` bytes.
+	 */
+	SegmentedStream(uint16_t segmentSize = defaultSegmentSize, Allocator* allocator = nullptr)
+		: allocator(allocator), segmentSize(segmentSize ?: defaultSegmentSize)
+	{
+	}
+
+	~SegmentedStream()
+	{
+		clear();
+	}
+
+	StreamType getStreamType() const override
+	{
+		return eSST_Memory;
+	}
+
+	int available() override
+	{
+		return writePos - readPos;
+	}
+
+	using ReadWriteStream::write;
+
+	/**
+	 * @brief Append data to the stream
+	 * @retval size_t Number of bytes written, less than `size` if memory is exhausted
+	 */
+	size_t write(const uint8_t* buffer, size_t size) override;
+
+	/**
+	 * @brief Read content, which may span several segments
+	 */
+	uint16_t readMemoryBlock(char* data, int bufSize) override;
+
+	/**
+	 * @brief Advance read position and release any segments which have been fully read
+	 * @note Seeking backwards is not supported
+	 */
+	int seekFrom(int offset, SeekOrigin origin) override;
+
+	bool isFinished() override
+	{
+		return readPos >= writePos;
+	}
+
+	/**
+	 * @brief Release all segments and reset stream
+	 */
+	void clear();
+
+	/**
+	 * @brief Get total number of bytes written to stream
+	 */
+	size_t getSize() const
+	{
+		return writePos;
+	}
+
+	/**
+	 * @brief Get number of segments currently allocated
+	 */
+	unsigned getSegmentCount() const
+	{
+		return segmentCount;
+	}
+
+	/**
+	 * @brief Get size of memory block required for each segment, including header
+	 */
+	size_t getBlockSize() const
+	{
+		return sizeof(Segment) + segmentSize;
+	}
+
+private:
+	struct Segment {
+		Segment* next;
+		uint16_t length; ///< Number of content bytes stored
+
+		char* data()
+		{
+			return reinterpret_cast<char*>(this + 1);
+		}
+	};
+
+	Segment* allocateSegment();
+	void releaseHead();
+
+	Allocator* allocator;
+	Segment* head{nullptr};
+	Segment* tail{nullptr};
+	size_t readPos{0};		///< Absolute read position
+	size_t writePos{0};		///< Absolute write position, i.e. total bytes written
+	uint16_t headOffset{0}; ///< Read offset within head segment
+	uint16_t segmentSize;
+	unsigned segmentCount{0};
+};
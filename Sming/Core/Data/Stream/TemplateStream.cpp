@@ -10,6 +10,7 @@
 
 #include "TemplateStream.h"
 #include <debug_progmem.h>
+#include <stringutil.h>
 
 String TemplateStream::evaluate(char*& expr)
 {
@@ -67,20 +68,25 @@ uint16_t TemplateStream::readMemoryBlock(char* data, int bufSize)
 		return 0;
 	}
 
-	auto findStartTag = [this](char* buf) -> char* {
+	auto start = data;
+	size_t datalen = stream->readMemoryBlock(data, bufSize - 1);
+
+	auto findStartTag = [&](char* buf) -> char* {
+		auto end = data + datalen;
+		if(buf >= end) {
+			return nullptr;
+		}
 		if(doubleBraces) {
-			return strstr(buf, "{{");
+			return static_cast<char*>(memmem_fast(buf, end - buf, "{{", 2));
 		}
 
 		char* p = buf;
-		while((p = strchr(p, '{')) != nullptr && (p[1] <= ' ' || p[1] == '"')) {
+		while((p = static_cast<char*>(memchr_fast(p, '{', end - p))) != nullptr && (p[1] <= ' ' || p[1] == '"')) {
 			++p;
 		}
 		return p;
 	};
 
-	auto start = data;
-	size_t datalen = stream->readMemoryBlock(data, bufSize - 1);
 	if(datalen != 0) {
 		data[datalen] = '\0'; // Terminate buffer to mitigate overflow risk
 		auto tagStart = findStartTag(data);
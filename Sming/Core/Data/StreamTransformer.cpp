@@ -21,7 +21,7 @@ uint16_t StreamTransformer::readMemoryBlock(char* data, int bufSize)
 	}
 
 	if(tempStream == nullptr) {
-		tempStream.reset(new CircularBuffer(NETWORK_SEND_BUFFER_SIZE + 10));
+		tempStream.reset(new CircularBuffer(NETWORK_SEND_BUFFER_SIZE));
 	}
 
 	// Use provided buffer as a temporary store for this operation
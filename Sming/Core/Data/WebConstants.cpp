@@ -12,6 +12,7 @@
 #include <FakePgmSpace.h>
 #include <FlashString/Vector.hpp>
 #include <stringutil.h>
+#include "PerfectHash.h"
 
 namespace
 {
@@ -24,14 +25,16 @@ MIME_TYPE_MAP(XX)
 DEFINE_FSTR_VECTOR(contentTypeStrings, FlashString, MIME_TYPE_MAP(XX))
 #undef XX
 
-// File extensions
-#define XX(name, ext, mime) DEFINE_FSTR_LOCAL(str_ext_##name, ext)
-MIME_TYPE_MAP(XX)
+// Lookup tables, generated at compile time
+#define XX(name, ext, mime) mime,
+constexpr const char* contentTypeKeys[]{MIME_TYPE_MAP(XX)};
 #undef XX
+DEFINE_PERFECT_HASH_MAP(contentTypeMap, contentTypeKeys, true);
 
-#define XX(name, ext, mime) &str_ext_##name,
-DEFINE_FSTR_VECTOR(extensionStrings, FlashString, MIME_TYPE_MAP(XX))
+#define XX(name, ext, mime) ext,
+constexpr const char* extensionKeys[]{MIME_TYPE_MAP(XX)};
 #undef XX
+DEFINE_PERFECT_HASH_MAP(extensionMap, extensionKeys, true);
 } // namespace
 
 String toString(MimeType m)
@@ -47,13 +50,17 @@ namespace ContentType
 {
 MimeType fromFileExtension(const char* extension, MimeType unknown)
 {
+	int i = extensionMap.indexOf(extension);
+	if(i >= 0) {
+		return MimeType(i);
+	}
+
 	// We accept 'htm' or 'html', but the latter is preferred
 	if(strcasecmp(extension, _F("htm")) == 0) {
 		return MIME_HTML;
 	}
 
-	int i = extensionStrings.indexOf(extension);
-	return (i < 0) ? unknown : MimeType(i);
+	return unknown;
 }
 
 String fromFileExtension(const char* extension)
@@ -69,7 +76,7 @@ String fromFileExtension(const char* extension)
 
 MimeType fromString(const char* str)
 {
-	int i = contentTypeStrings.indexOf(str);
+	int i = contentTypeMap.indexOf(str);
 	if(i < 0) {
 		if(strcasecmp(str, _F("application/xml")) == 0) {
 			return MIME_XML;
@@ -266,6 +266,25 @@ char* uri_unescape_inplace(char* str)
 	return str;
 }
 
+size_t uri_unescape_inplace(char* buffer, size_t length)
+{
+	auto src = buffer;
+	auto end = buffer + length;
+	auto dest = buffer;
+	while(src < end) {
+		if(*src == '%' && end - src >= 3 && ishex(src + 1)) {
+			*dest++ = char(unhex(src + 1));
+			src += 3;
+		} else if(*src == '+') {
+			*dest++ = ' ';
+			++src;
+		} else {
+			*dest++ = *src++;
+		}
+	}
+	return dest - buffer;
+}
+
 String& uri_unescape_inplace(String& str)
 {
 	if(str) {
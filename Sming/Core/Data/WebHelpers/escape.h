@@ -45,6 +45,14 @@ void html_escape(char* dest, size_t len, const char* s);
  */
 char* uri_unescape_inplace(char* str);
 
+/** @brief Unescape a buffer in place
+ *  @param buffer text to un-escape, need not be nul-terminated
+ *  @param length number of characters in buffer
+ *  @retval size_t length of unescaped text
+ *  @note No nul terminator is written, and the result may contain nul characters
+ */
+size_t uri_unescape_inplace(char* buffer, size_t length);
+
 /** @brief escape the given URI string
  *  @param src
  *  @param src_len
@@ -15,14 +15,32 @@
 #pragma once
 
 #include <functional>
+#include "InplaceDelegate.h"
 using namespace std::placeholders;
 
 /**
  * @brief  Delegate class, encapsulates a std::function
  * Added constructor template implements lambda callback which is more efficient than std::bind.
+ * @note If ENABLE_INPLACE_DELEGATE is set then InplaceDelegate is used instead, which never allocates heap memory.
  */
 template <typename> class Delegate; /* undefined */
 
+#if ENABLE_INPLACE_DELEGATE
+
+template <typename ReturnType, typename... ParamTypes>
+class Delegate<ReturnType(ParamTypes...)> : public InplaceDelegate<ReturnType(ParamTypes...)>
+{
+	using Base = InplaceDelegate<ReturnType(ParamTypes...)>;
+
+public:
+	using Base::Base;
+	using Base::operator=;
+
+	Delegate() = default;
+};
+
+#else
+
 /** @brief  Delegate class
 */
 template <typename ReturnType, typename... ParamTypes>
@@ -46,4 +64,6 @@ public:
 	}
 };
 
+#endif
+
 /** @} */
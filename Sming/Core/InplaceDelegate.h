@@ -0,0 +1,246 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * InplaceDelegate.h
+ *
+ ****/
+
+/** @addtogroup   delegate
+ *  @{
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Default capture storage for InplaceDelegate, in bytes
+ * @note Sufficient for a bound class method (method pointer plus object pointer) on all architectures.
+ */
+#ifndef INPLACE_DELEGATE_SIZE
+#define INPLACE_DELEGATE_SIZE (4 * sizeof(void*))
+#endif
+
+template <typename, size_t capacity = INPLACE_DELEGATE_SIZE> class InplaceDelegate; /* undefined */
+
+/**
+ * @brief Delegate class which stores its target within a fixed-size buffer
+ * @tparam capacity Size of capture buffer, in bytes
+ *
+ * Provides the same interface as Delegate but never allocates heap memory.
+ * Attempting to store a callable object larger than `capacity` fails at compile time.
+ */
+template <typename ReturnType, typename... ParamTypes, size_t capacity>
+class InplaceDelegate<ReturnType(ParamTypes...), capacity>
+{
+	template <typename F, typename Result = decltype(std::declval<std::decay_t<F>&>()(std::declval<ParamTypes>()...))>
+	using EnableIfCallable =
+		std::enable_if_t<!std::is_base_of<InplaceDelegate, std::decay_t<F>>::value &&
+						 (std::is_void<ReturnType>::value || std::is_convertible<Result, ReturnType>::value)>;
+
+public:
+	InplaceDelegate() = default;
+
+	InplaceDelegate(std::nullptr_t)
+	{
+	}
+
+	/**
+	 * @brief Store any callable object, such as a lambda or function pointer
+	 */
+	template <typename F, typename = EnableIfCallable<F>> InplaceDelegate(F&& func)
+	{
+		assign(std::forward<F>(func));
+	}
+
+	/**
+	 * @brief Delegate a class method
+	 * @param m Method declaration to delegate
+	 * @param c Pointer to the class type
+	 */
+	template <class ClassType>
+	InplaceDelegate(ReturnType (ClassType::*m)(ParamTypes...), ClassType* c)
+		: InplaceDelegate([m, c](ParamTypes... params) -> ReturnType { return (c->*m)(params...); })
+	{
+	}
+
+	InplaceDelegate(const InplaceDelegate& other)
+	{
+		copyFrom(other);
+	}
+
+	InplaceDelegate(InplaceDelegate&& other) noexcept
+	{
+		moveFrom(other);
+	}
+
+	~InplaceDelegate()
+	{
+		clear();
+	}
+
+	InplaceDelegate& operator=(const InplaceDelegate& other)
+	{
+		if(this != &other) {
+			clear();
+			copyFrom(other);
+		}
+		return *this;
+	}
+
+	InplaceDelegate& operator=(InplaceDelegate&& other) noexcept
+	{
+		if(this != &other) {
+			clear();
+			moveFrom(other);
+		}
+		return *this;
+	}
+
+	InplaceDelegate& operator=(std::nullptr_t)
+	{
+		clear();
+		return *this;
+	}
+
+	template <typename F, typename = EnableIfCallable<F>> InplaceDelegate& operator=(F&& func)
+	{
+		clear();
+		assign(std::forward<F>(func));
+		return *this;
+	}
+
+	explicit operator bool() const
+	{
+		return invoker != nullptr;
+	}
+
+	bool operator==(std::nullptr_t) const
+	{
+		return invoker == nullptr;
+	}
+
+	bool operator!=(std::nullptr_t) const
+	{
+		return invoker != nullptr;
+	}
+
+	/**
+	 * @brief Invoke the target
+	 * @note Calling an empty delegate is a programming error and aborts, as for `std::function`
+	 */
+	ReturnType operator()(ParamTypes... params) const
+	{
+		if(invoker == nullptr) {
+			abort();
+		}
+		return invoker(&storage, std::forward<ParamTypes>(params)...);
+	}
+
+	/**
+	 * @brief Compile-time check for whether a callable type can be stored
+	 */
+	template <typename F> static constexpr bool canStore()
+	{
+		return sizeof(F) <= capacity && alignof(F) <= alignof(Storage);
+	}
+
+private:
+	using Storage = std::aligned_storage_t<capacity>;
+	using Invoker = ReturnType (*)(void* storage, ParamTypes&&... params);
+	enum class Operation { copy, move, destroy };
+	using Manager = void (*)(Operation op, void* dst, void* src);
+
+	template <typename F> void assign(F&& func)
+	{
+		using Fn = std::decay_t<F>;
+		static_assert(sizeof(Fn) <= capacity, "Callable too large for InplaceDelegate: increase capacity");
+		static_assert(alignof(Fn) <= alignof(Storage), "Callable alignment not supported by InplaceDelegate");
+
+		if constexpr(std::is_pointer<std::remove_reference_t<F>>::value) {
+			if(func == nullptr) {
+				return;
+			}
+		}
+
+		new(&storage) Fn(std::forward<F>(func));
+		invoker = [](void* storage, ParamTypes&&... params) -> ReturnType {
+			return static_cast<ReturnType>((*static_cast<Fn*>(storage))(std::forward<ParamTypes>(params)...));
+		};
+		// Trivial objects are copied by value and need no management
+		if constexpr(!std::is_trivially_copyable<Fn>::value || !std::is_trivially_destructible<Fn>::value) {
+			manager = [](Operation op, void* dst, void* src) {
+				switch(op) {
+				case Operation::copy:
+					new(dst) Fn(*static_cast<const Fn*>(src));
+					break;
+				case Operation::move:
+					new(dst) Fn(std::move(*static_cast<Fn*>(src)));
+					static_cast<Fn*>(src)->~Fn();
+					break;
+				case Operation::destroy:
+					static_cast<Fn*>(dst)->~Fn();
+					break;
+				}
+			};
+		}
+	}
+
+	void copyFrom(const InplaceDelegate& other)
+	{
+		if(other.manager != nullptr) {
+			other.manager(Operation::copy, &storage, &other.storage);
+		} else {
+			memcpy(&storage, &other.storage, sizeof(storage));
+		}
+		invoker = other.invoker;
+		manager = other.manager;
+	}
+
+	void moveFrom(InplaceDelegate& other)
+	{
+		if(other.manager != nullptr) {
+			other.manager(Operation::move, &storage, &other.storage);
+		} else {
+			memcpy(&storage, &other.storage, sizeof(storage));
+		}
+		invoker = other.invoker;
+		manager = other.manager;
+		other.invoker = nullptr;
+		other.manager = nullptr;
+	}
+
+	void clear()
+	{
+		if(manager != nullptr) {
+			manager(Operation::destroy, &storage, nullptr);
+		}
+		invoker = nullptr;
+		manager = nullptr;
+	}
+
+	mutable Storage storage;
+	Invoker invoker{nullptr};
+	Manager manager{nullptr};
+};
+
+template <typename ReturnType, typename... ParamTypes, size_t capacity>
+bool operator==(std::nullptr_t, const InplaceDelegate<ReturnType(ParamTypes...), capacity>& delegate)
+{
+	return delegate == nullptr;
+}
+
+template <typename ReturnType, typename... ParamTypes, size_t capacity>
+bool operator!=(std::nullptr_t, const InplaceDelegate<ReturnType(ParamTypes...), capacity>& delegate)
+{
+	return delegate != nullptr;
+}
+
+/** @} */
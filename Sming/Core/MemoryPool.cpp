@@ -0,0 +1,156 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * MemoryPool.cpp
+ *
+ ****/
+
+#include "MemoryPool.h"
+#include <debug_progmem.h>
+
+namespace MemoryPool
+{
+Pool::List Pool::pools;
+
+Pool::Pool(const char* name, void* storage, size_t blockSize, size_t blockCount)
+	: name(name), storage(static_cast<uint8_t*>(storage))
+{
+	blockSize = (blockSize + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+	if(blockSize > UINT16_MAX || blockCount > UINT16_MAX) {
+		debug_e("[POOL] '%s' block size %u or count %u out of range", name ?: "pool", unsigned(blockSize),
+				unsigned(blockCount));
+		blockCount = 0;
+	}
+	this->blockSize = blockSize;
+	this->blockCount = blockCount;
+
+	// Build free list in address order
+	auto block = this->storage + this->blockSize * blockCount;
+	for(unsigned i = 0; i < blockCount; ++i) {
+		block -= this->blockSize;
+		auto fb = reinterpret_cast<FreeBlock*>(block);
+		fb->next = freeList;
+		freeList = fb;
+	}
+
+	pools.add(this);
+}
+
+Pool::~Pool()
+{
+	pools.remove(this);
+}
+
+void* IRAM_ATTR Pool::allocate()
+{
+	auto level = noInterrupts();
+	auto block = freeList;
+	if(block == nullptr) {
+		++stats.failCount;
+	} else {
+		freeList = block->next;
+		++stats.allocCount;
+		++stats.used;
+		if(stats.used > stats.highWater) {
+			stats.highWater = stats.used;
+		}
+	}
+	restoreInterrupts(level);
+	return block;
+}
+
+void IRAM_ATTR Pool::release(void* ptr)
+{
+	if(ptr == nullptr) {
+		return;
+	}
+
+	auto block = static_cast<FreeBlock*>(ptr);
+	auto level = noInterrupts();
+	block->next = freeList;
+	freeList = block;
+	--stats.used;
+	restoreInterrupts(level);
+}
+
+void Pool::resetStats()
+{
+	auto level = noInterrupts();
+	stats.highWater = stats.used;
+	stats.allocCount = 0;
+	stats.failCount = 0;
+	restoreInterrupts(level);
+}
+
+void Pool::printStats(Print& p) const
+{
+	p << (name ?: "pool") << '[' << blockSize << " x " << blockCount << "]: used " << stats.used << ", high "
+	  << stats.highWater << ", allocs " << stats.allocCount << ", failed " << stats.failCount << endl;
+}
+
+void* SizeClassAllocator::allocate(size_t size)
+{
+	for(unsigned i = 0; i < count; ++i) {
+		auto pool = pools[i];
+		if(size > pool->getBlockSize()) {
+			continue;
+		}
+		auto ptr = pool->allocate();
+		if(ptr != nullptr) {
+			return ptr;
+		}
+	}
+
+	++heapCount;
+	return malloc(size);
+}
+
+void SizeClassAllocator::release(void* ptr)
+{
+	for(unsigned i = 0; i < count; ++i) {
+		auto pool = pools[i];
+		if(pool->contains(ptr)) {
+			pool->release(ptr);
+			return;
+		}
+	}
+
+	free(ptr);
+}
+
+size_t getUsed()
+{
+	size_t used{0};
+	for(auto& pool : Pool::getPools()) {
+		used += pool.getStats().used;
+	}
+	return used;
+}
+
+size_t getFailCount()
+{
+	size_t count{0};
+	for(auto& pool : Pool::getPools()) {
+		count += pool.getStats().failCount;
+	}
+	return count;
+}
+
+void resetStats()
+{
+	for(auto& pool : Pool::getPools()) {
+		pool.resetStats();
+	}
+}
+
+void printStats(Print& p)
+{
+	for(auto& pool : Pool::getPools()) {
+		pool.printStats(p);
+	}
+}
+
+} // namespace MemoryPool
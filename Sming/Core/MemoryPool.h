@@ -0,0 +1,274 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * MemoryPool.h - Fixed-block memory pools
+ *
+ *	Objects which are frequently created and destroyed can fragment the heap over long periods of uptime.
+ *	Allocating them from a dedicated pool of fixed-size blocks avoids this, and is also faster than
+ *	a general heap allocation.
+ *
+ ****/
+
+#pragma once
+
+#include <Data/LinkedObjectList.h>
+#include <Print.h>
+#include <esp_systemapi.h>
+
+namespace MemoryPool
+{
+/**
+ * @brief Pool usage statistics
+ */
+struct Stats {
+	uint16_t used;		 ///< Blocks currently allocated
+	uint16_t highWater;  ///< Maximum value of `used`
+	uint32_t allocCount; ///< Successful allocations
+	uint32_t failCount;  ///< Allocations which failed because pool was exhausted
+};
+
+/**
+ * @brief A pool of fixed-size memory blocks
+ *
+ * Free blocks are kept in a singly-linked list, so allocation and release take constant time.
+ * All pools are registered in a global list so their statistics can be reported.
+ */
+class Pool : public LinkedObjectTemplate<Pool>
+{
+public:
+	using List = LinkedObjectListTemplate<Pool>;
+
+	/**
+	 * @brief Construct a pool using the given storage
+	 * @param name Identifies pool in statistics. Must remain valid for the lifetime of the pool. May be nullptr.
+	 * @param storage Memory for blocks, suitably aligned
+	 * @param blockSize Size of each block, rounded up to a multiple of pointer size
+	 * @param blockCount Number of blocks in storage
+	 * @note Block size and count are limited to 65535. If either is larger the pool is left empty.
+	 */
+	Pool(const char* name, void* storage, size_t blockSize, size_t blockCount);
+
+	~Pool();
+
+	Pool(const Pool&) = delete;
+	Pool& operator=(const Pool&) = delete;
+
+	/**
+	 * @brief Allocate a block
+	 * @retval void* nullptr if pool is exhausted
+	 * @note May be called from interrupt context
+	 */
+	void* allocate();
+
+	/**
+	 * @brief Return a block to the pool
+	 * @param ptr Block obtained from `allocate()`
+	 * @note May be called from interrupt context
+	 */
+	void release(void* ptr);
+
+	/**
+	 * @brief Determine if a pointer refers to a block within this pool
+	 */
+	bool contains(const void* ptr) const
+	{
+		auto p = static_cast<const uint8_t*>(ptr);
+		return p >= storage && p < storage + blockSize * blockCount;
+	}
+
+	const char* getName() const
+	{
+		return name;
+	}
+
+	size_t getBlockSize() const
+	{
+		return blockSize;
+	}
+
+	size_t getBlockCount() const
+	{
+		return blockCount;
+	}
+
+	size_t getFreeCount() const
+	{
+		return blockCount - stats.used;
+	}
+
+	const Stats& getStats() const
+	{
+		return stats;
+	}
+
+	/**
+	 * @brief Reset counters. High-water mark is set to current usage.
+	 */
+	void resetStats();
+
+	void printStats(Print& p) const;
+
+	/**
+	 * @brief Get list of all pools
+	 */
+	static List& getPools()
+	{
+		return pools;
+	}
+
+private:
+	struct FreeBlock {
+		FreeBlock* next;
+	};
+
+	static List pools;
+
+	const char* name;
+	uint8_t* storage;
+	uint16_t blockSize;
+	uint16_t blockCount;
+	FreeBlock* freeList{nullptr};
+	Stats stats{};
+};
+
+/**
+ * @brief Pool with statically-allocated storage
+ * @tparam size Size of each block
+ * @tparam count Number of blocks
+ */
+template <size_t size, size_t count> class StaticPool : public Pool
+{
+public:
+	StaticPool(const char* name) : Pool(name, buffer, size, count)
+	{
+	}
+
+private:
+	static constexpr size_t alignedSize = (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+	static_assert(alignedSize <= UINT16_MAX && count <= UINT16_MAX, "Pool block size or count too large");
+	alignas(void*) uint8_t buffer[alignedSize * count];
+};
+
+/**
+ * @brief Allocator using a set of pools with different block sizes
+ *
+ * Each request is satisfied from the smallest pool with large enough blocks available.
+ * Requests which no pool can satisfy fall back to the heap.
+ *
+ * Example:
+ *
+ * 		StaticPool<32, 16> pool32("small");
+ * 		StaticPool<128, 8> pool128("medium");
+ * 		Pool* pools[]{&pool32, &pool128};
+ * 		SizeClassAllocator allocator(pools, ARRAY_SIZE(pools));
+ */
+class SizeClassAllocator
+{
+public:
+	/**
+	 * @brief Constructor
+	 * @param pools Array of pools, in order of increasing block size
+	 * @param count Number of pools
+	 */
+	SizeClassAllocator(Pool* const* pools, size_t count) : pools(pools), count(count)
+	{
+	}
+
+	/**
+	 * @brief Allocate memory, using heap if no suitable pool block is available
+	 */
+	void* allocate(size_t size);
+
+	/**
+	 * @brief Release memory obtained from `allocate()`
+	 * @note May only be called from interrupt context for blocks allocated from a pool
+	 */
+	void release(void* ptr);
+
+	/**
+	 * @brief Number of allocations which fell back to the heap
+	 */
+	uint32_t getHeapCount() const
+	{
+		return heapCount;
+	}
+
+private:
+	Pool* const* pools;
+	size_t count;
+	uint32_t heapCount{0};
+};
+
+/**
+ * @brief Base class to allocate objects from a dedicated pool
+ * @tparam ObjectType The derived class
+ * @tparam count Number of blocks in the pool
+ *
+ * Usage:
+ *
+ * 		class Message : public MemoryPool::Pooled<Message, 8>
+ * 		{
+ * 			...
+ * 		};
+ *
+ * `new Message` then uses the pool, falling back to the heap when the pool is exhausted.
+ * Pool storage is allocated statically and the pool is registered on first use.
+ * Objects must not be created or deleted in interrupt context.
+ */
+template <class ObjectType, size_t count> class Pooled
+{
+public:
+	static void* operator new(size_t size)
+	{
+		void* ptr{nullptr};
+		// Derived classes may be larger
+		if(size <= sizeof(ObjectType)) {
+			ptr = getPool().allocate();
+		}
+		if(ptr == nullptr) {
+			ptr = ::operator new(size);
+		}
+		return ptr;
+	}
+
+	static void operator delete(void* ptr)
+	{
+		auto& pool = getPool();
+		if(pool.contains(ptr)) {
+			pool.release(ptr);
+		} else {
+			::operator delete(ptr);
+		}
+	}
+
+	static Pool& getPool()
+	{
+		static StaticPool<sizeof(ObjectType), count> pool(nullptr);
+		return pool;
+	}
+};
+
+/**
+ * @brief Get total number of blocks currently allocated across all pools
+ */
+size_t getUsed();
+
+/**
+ * @brief Get total number of failed allocations across all pools
+ */
+size_t getFailCount();
+
+/**
+ * @brief Reset statistics for all pools
+ */
+void resetStats();
+
+/**
+ * @brief Print statistics for all pools
+ */
+void printStats(Print& p);
+
+} // namespace MemoryPool
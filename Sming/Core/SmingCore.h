@@ -40,6 +40,7 @@
 #include "Platform/AccessPoint.h"
 #endif
 
+#include "Network/DnsCache.h"
 #include "Network/DnsServer.h"
 #include "Network/HttpClient.h"
 #include "Network/MqttClient.h"
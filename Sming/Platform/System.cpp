@@ -10,40 +10,301 @@
 
 #include "Platform/System.h"
 #include "Timer.h"
+#include "Clock.h"
 
 SystemClass System;
 SystemState SystemClass::state = eSS_None;
 
 #ifdef TASK_QUEUE_LENGTH
 static_assert(TASK_QUEUE_LENGTH >= 8, "Task queue too small");
+static_assert(TASK_QUEUE_LENGTH <= 255, "Task queue too large");
 #else
-/** @brief default number of tasks in global queue
+/** @brief default number of tasks in each priority lane
  *  @note tasks are usually short-lived and executed very promptly, so a large queue is
- *  normally un-necessry. If queue overrun is suspected, check `SystemClass::getMaxTaskCount()`.
+ *  normally un-necessry. If queue overrun is suspected, check `SystemClass::getTaskStats()`.
  */
 #define TASK_QUEUE_LENGTH 10
 #endif
 
-os_event_t SystemClass::taskQueue[TASK_QUEUE_LENGTH];
+/*
+ * The OS queue is only used to schedule taskHandler, so doesn't need to be large
+ */
+#define OS_TASK_QUEUE_LENGTH 4
+
+os_event_t SystemClass::taskQueue[OS_TASK_QUEUE_LENGTH];
 
+namespace
+{
+struct TaskEntry {
+	TaskCallback callback;
+	void* param;
 #ifdef ENABLE_TASK_COUNT
-volatile uint8_t SystemClass::taskCount;
-volatile uint8_t SystemClass::maxTaskCount;
+	uint32_t queueTime;
 #endif
+};
+
+struct SpillEntry : public TaskEntry {
+	SpillEntry* next;
+};
 
-/** @brief OS calls this function which invokes user-defined callback
- *  @note callback function pointer is placed in event->sig, with parameter in event->par.
+/*
+ * Fixed-size ring buffer for a single priority lane, with an overflow list for
+ * Delegate callbacks. Spilled entries are moved into the ring as space becomes available.
+ * All methods must be called with interrupts disabled.
  */
-void SystemClass::taskHandler(os_event_t* event)
+class TaskLane
+{
+public:
+	__forceinline bool isFull() const
+	{
+		return count == TASK_QUEUE_LENGTH;
+	}
+
+	__forceinline bool push(const TaskEntry& entry)
+	{
+		if(isFull()) {
+			return false;
+		}
+		entries[(read + count) % TASK_QUEUE_LENGTH] = entry;
+		++count;
+		updateCount(1);
+		return true;
+	}
+
+	void spill(SpillEntry* entry)
+	{
+		entry->next = nullptr;
+		if(spillTail == nullptr) {
+			spillHead = entry;
+		} else {
+			spillTail->next = entry;
+		}
+		spillTail = entry;
+		++stats.spillCount;
+		if(stats.spillCount > stats.maxSpill) {
+			stats.maxSpill = stats.spillCount;
+		}
+		updateCount(1);
+	}
+
+	/*
+	 * If a spilled entry is moved into the ring it is returned via `released`,
+	 * and the caller must delete it after re-enabling interrupts.
+	 */
+	bool pop(TaskEntry& entry, SpillEntry*& released)
+	{
+		if(count == 0) {
+			return false;
+		}
+		entry = entries[read];
+		read = (read + 1) % TASK_QUEUE_LENGTH;
+		--count;
+		updateCount(-1);
+
+		released = spillHead;
+		if(released != nullptr) {
+			spillHead = released->next;
+			if(spillHead == nullptr) {
+				spillTail = nullptr;
+			}
+			--stats.spillCount;
+			entries[(read + count) % TASK_QUEUE_LENGTH] = *released;
+			++count;
+		}
+		return true;
+	}
+
+	TaskQueueStats stats{};
+
+private:
+	__forceinline void updateCount(int delta)
+	{
+		stats.count += delta;
+		if(stats.count > stats.maxCount) {
+			stats.maxCount = stats.count;
+		}
+	}
+
+	TaskEntry entries[TASK_QUEUE_LENGTH];
+	SpillEntry* spillHead{nullptr};
+	SpillEntry* spillTail{nullptr};
+	uint8_t read{0};
+	uint8_t count{0};
+};
+
+TaskLane taskLanes[TASK_PRIORITY_COUNT];
+volatile bool taskHandlerPending;
+
+void IRAM_ATTR kickTaskHandler()
+{
+	if(!system_os_post(USER_TASK_PRIO_1, 0, 0)) {
+		// Try again on next call to queueCallback
+		taskHandlerPending = false;
+	}
+}
+
+bool IRAM_ATTR queueEntry(TaskPriority priority, TaskCallback callback, void* param, bool allowSpill)
 {
+	if(callback == nullptr || unsigned(priority) >= TASK_PRIORITY_COUNT) {
+		return false;
+	}
+
+	auto& lane = taskLanes[unsigned(priority)];
+
+	TaskEntry entry{callback, param};
 #ifdef ENABLE_TASK_COUNT
+	entry.queueTime = system_get_time();
+#endif
+
+	// Only allocate if we might need it: never the case in interrupt context
+	SpillEntry* spill = (allowSpill && lane.isFull()) ? new SpillEntry{} : nullptr;
+
+	bool ok;
+	bool kick;
+	for(;;) {
+		auto level = noInterrupts();
+		ok = lane.push(entry);
+		if(!ok && spill != nullptr) {
+			static_cast<TaskEntry&>(*spill) = entry;
+			lane.spill(spill);
+			spill = nullptr;
+			ok = true;
+		}
+		if(!ok && allowSpill && spill == nullptr) {
+			// Lane filled up since we checked
+			restoreInterrupts(level);
+			spill = new SpillEntry{};
+			if(spill != nullptr) {
+				continue;
+			}
+			level = noInterrupts();
+		}
+		if(!ok) {
+			++lane.stats.failed;
+		}
+		kick = ok && !taskHandlerPending;
+		if(kick) {
+			taskHandlerPending = true;
+		}
+		restoreInterrupts(level);
+		break;
+	}
+
+	delete spill;
+
+	if(kick) {
+		kickTaskHandler();
+	}
+
+	return ok;
+}
+
+void delegateHandler(void* param)
+{
+	auto delegate = static_cast<TaskDelegate*>(param);
+	(*delegate)();
+	delete delegate;
+}
+
+/*
+ * Deferred callbacks are held in a list sorted by due time, serviced by a single timer
+ */
+struct DeferredEntry {
+	DeferredEntry* next;
+	uint32_t due; ///< millis()
+	TaskCallback callback;
+	void* param;
+	TaskPriority priority;
+};
+
+DeferredEntry* deferredList;
+SimpleTimer deferredTimer;
+
+void serviceDeferred(void*);
+
+void deferredTimerCallback(void*)
+{
+	// List is serviced in task context
+	if(!System.queueCallback(serviceDeferred, nullptr, TaskPriority::High)) {
+		deferredTimer.startOnce();
+	}
+}
+
+void armDeferredTimer()
+{
+	if(deferredList == nullptr) {
+		deferredTimer.stop();
+		return;
+	}
+
+	// Limit interval to keep within timer range; timer just gets re-armed
+	int remain = deferredList->due - millis();
+	remain = std::max(remain, 1);
+	remain = std::min(remain, 60000);
+	deferredTimer.initializeMs(remain, deferredTimerCallback).startOnce();
+}
+
+void serviceDeferred(void*)
+{
+	auto now = millis();
+	while(deferredList != nullptr && int(deferredList->due - now) <= 0) {
+		auto entry = deferredList;
+		if(!queueEntry(entry->priority, entry->callback, entry->param, true)) {
+			// Out of memory, try again shortly
+			break;
+		}
+		deferredList = entry->next;
+		delete entry;
+	}
+
+	armDeferredTimer();
+}
+
+} // namespace
+
+/** @brief OS calls this function which invokes user-defined callbacks
+ *  @note Callbacks are taken from the highest priority lane first.
+ *  Only the number of callbacks queued on entry are serviced so that other system tasks aren't starved.
+ */
+void SystemClass::taskHandler(os_event_t*)
+{
 	auto level = noInterrupts();
-	--taskCount;
+	taskHandlerPending = false;
+	unsigned count = 0;
+	for(auto& lane : taskLanes) {
+		count += lane.stats.count;
+	}
 	restoreInterrupts(level);
+
+	while(count-- != 0) {
+		TaskEntry entry;
+		SpillEntry* released{nullptr};
+		TaskLane* lane{nullptr};
+		level = noInterrupts();
+		for(auto& l : taskLanes) {
+			if(l.pop(entry, released)) {
+				lane = &l;
+				break;
+			}
+		}
+		restoreInterrupts(level);
+
+		if(lane == nullptr) {
+			break;
+		}
+
+		delete released;
+
+		auto& stats = lane->stats;
+		++stats.executed;
+#ifdef ENABLE_TASK_COUNT
+		stats.lastLatency = system_get_time() - entry.queueTime;
+		if(stats.lastLatency > stats.maxLatency) {
+			stats.maxLatency = stats.lastLatency;
+		}
 #endif
-	auto callback = reinterpret_cast<TaskCallback>(event->sig);
-	if(callback != nullptr) {
-		callback(reinterpret_cast<void*>(event->par));
+
+		entry.callback(entry.param);
 	}
 }
 
@@ -56,10 +317,16 @@ bool SystemClass::initialize()
 	state = eSS_Intializing;
 
 	// Initialise the global task queue
-	if(!system_os_task(taskHandler, USER_TASK_PRIO_1, taskQueue, TASK_QUEUE_LENGTH)) {
+	if(!system_os_task(taskHandler, USER_TASK_PRIO_1, taskQueue, OS_TASK_QUEUE_LENGTH)) {
 		return false;
 	}
 
+	// Handle anything queued before initialisation
+	if(getTaskCount() != 0) {
+		taskHandlerPending = true;
+		kickTaskHandler();
+	}
+
 #ifdef ARCH_ESP8266
 	system_init_done_cb([]() { state = eSS_Ready; });
 #else
@@ -69,23 +336,9 @@ bool SystemClass::initialize()
 	return true;
 }
 
-bool SystemClass::queueCallback(TaskCallback callback, void* param)
+bool SystemClass::queueCallback(TaskCallback callback, void* param, TaskPriority priority)
 {
-	if(callback == nullptr) {
-		return false;
-	}
-
-#ifdef ENABLE_TASK_COUNT
-	auto level = noInterrupts();
-	++taskCount;
-	if(taskCount > maxTaskCount) {
-		maxTaskCount = taskCount;
-	}
-	restoreInterrupts(level);
-#endif
-
-	return system_os_post(USER_TASK_PRIO_1, reinterpret_cast<os_signal_t>(callback),
-						  reinterpret_cast<os_param_t>(param));
+	return queueEntry(priority, callback, param, false);
 }
 
 bool SystemClass::queueCallback(InterruptCallback callback)
@@ -94,7 +347,7 @@ bool SystemClass::queueCallback(InterruptCallback callback)
 						 reinterpret_cast<void*>(callback));
 }
 
-bool SystemClass::queueCallback(TaskDelegate callback)
+bool SystemClass::queueCallback(TaskDelegate callback, TaskPriority priority)
 {
 	if(!callback) {
 		return false;
@@ -107,13 +360,52 @@ bool SystemClass::queueCallback(TaskDelegate callback)
 		return false;
 	}
 
-	auto delegateHandler = [](void* param) {
-		auto delegate = static_cast<TaskDelegate*>(param);
-		(*delegate)();
+	if(!queueEntry(priority, delegateHandler, delegate, true)) {
 		delete delegate;
-	};
+		return false;
+	}
+
+	return true;
+}
+
+bool SystemClass::queueDeferredCallback(uint32_t delayMs, TaskCallback callback, void* param, TaskPriority priority)
+{
+	if(callback == nullptr || unsigned(priority) >= TASK_PRIORITY_COUNT) {
+		return false;
+	}
+
+	auto entry = new DeferredEntry{nullptr, millis() + delayMs, callback, param, priority};
+	if(entry == nullptr) {
+		return false;
+	}
+
+	// Insert after any entries with the same due time so ordering is preserved
+	auto prev = &deferredList;
+	while(*prev != nullptr && int((*prev)->due - entry->due) <= 0) {
+		prev = &(*prev)->next;
+	}
+	entry->next = *prev;
+	*prev = entry;
+
+	if(entry == deferredList) {
+		armDeferredTimer();
+	}
+
+	return true;
+}
+
+bool SystemClass::queueDeferredCallback(uint32_t delayMs, TaskDelegate callback, TaskPriority priority)
+{
+	if(!callback) {
+		return false;
+	}
+
+	auto delegate = new TaskDelegate(std::move(callback));
+	if(delegate == nullptr) {
+		return false;
+	}
 
-	if(!queueCallback(delegateHandler, delegate)) {
+	if(!queueDeferredCallback(delayMs, delegateHandler, delegate, priority)) {
 		delete delegate;
 		return false;
 	}
@@ -121,6 +413,44 @@ bool SystemClass::queueCallback(TaskDelegate callback)
 	return true;
 }
 
+unsigned SystemClass::getTaskCount()
+{
+	unsigned count = 0;
+	for(auto& lane : taskLanes) {
+		count += lane.stats.count;
+	}
+	return count;
+}
+
+unsigned SystemClass::getMaxTaskCount()
+{
+	unsigned count = 0;
+	for(auto& lane : taskLanes) {
+		count += lane.stats.maxCount;
+	}
+	return count;
+}
+
+const TaskQueueStats& SystemClass::getTaskStats(TaskPriority priority)
+{
+	return taskLanes[std::min(unsigned(priority), TASK_PRIORITY_COUNT - 1)].stats;
+}
+
+void SystemClass::resetTaskStats()
+{
+	auto level = noInterrupts();
+	for(auto& lane : taskLanes) {
+		auto& stats = lane.stats;
+		stats.maxCount = stats.count;
+		stats.maxSpill = stats.spillCount;
+		stats.executed = 0;
+		stats.failed = 0;
+		stats.maxLatency = 0;
+		stats.lastLatency = 0;
+	}
+	restoreInterrupts(level);
+}
+
 void SystemClass::restart(unsigned deferMillis)
 {
 	if(deferMillis == 0) {
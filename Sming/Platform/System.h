@@ -49,6 +49,36 @@ using TaskDelegate = Delegate<void()>;
  */
 using SystemReadyDelegate = TaskDelegate;
 
+/**
+ * @brief Task queue priority lanes
+ *
+ * Callbacks in a higher priority lane are always executed before those in lower lanes.
+ */
+enum class TaskPriority : uint8_t {
+	High,	///< Latency-critical work, such as refilling I/O buffers
+	Normal, ///< Default for general callbacks
+	Low,	///< Background work which can tolerate delay
+};
+
+/**
+ * @brief Number of task queue priority lanes
+ */
+constexpr unsigned TASK_PRIORITY_COUNT{3};
+
+/**
+ * @brief Statistics for a task queue priority lane
+ */
+struct TaskQueueStats {
+	uint16_t count;		  ///< Number of callbacks currently queued, including spilled entries
+	uint16_t maxCount;	///< Maximum value of `count`
+	uint16_t spillCount;  ///< Number of callbacks currently held in the spill list
+	uint16_t maxSpill;	///< Maximum value of `spillCount`
+	uint32_t executed;	///< Total number of callbacks executed
+	uint32_t failed;	  ///< Number of callbacks which could not be queued
+	uint32_t maxLatency;  ///< Longest time between queueing and execution, in microseconds (requires ENABLE_TASK_COUNT)
+	uint32_t lastLatency; ///< Latency for most recently executed callback (requires ENABLE_TASK_COUNT)
+};
+
 /**
  * @brief Interface class implemented by classes to support on-ready callback
  */
@@ -195,7 +225,20 @@ public:
 	/**
 	 * @brief Queue a deferred callback, with optional void* parameter
 	 */
-	static bool IRAM_ATTR queueCallback(TaskCallback callback, void* param = nullptr);
+	static bool IRAM_ATTR queueCallback(TaskCallback callback, void* param = nullptr)
+	{
+		return queueCallback(callback, param, TaskPriority::Normal);
+	}
+
+	/**
+	 * @brief Queue a deferred callback in a specific priority lane
+	 * @param callback The function to be called
+	 * @param param Parameter passed to the callback
+	 * @param priority Lane to use
+	 * @retval bool false if lane is full
+	 * @note Safe to call from interrupt context
+	 */
+	static bool IRAM_ATTR queueCallback(TaskCallback callback, void* param, TaskPriority priority);
 
 	/**
 	 * @brief Queue a deferred callback with no callback parameter
@@ -210,44 +253,70 @@ public:
 	 * but requires heap allocation and not as fast as a function callback.
 	 * DO NOT use from interrupt context, use a Task/Interrupt callback.
 	 */
-	static bool queueCallback(TaskDelegate callback);
+	static bool queueCallback(TaskDelegate callback)
+	{
+		return queueCallback(std::move(callback), TaskPriority::Normal);
+	}
+
+	/**
+	 * @brief Queue a deferred Delegate callback in a specific priority lane
+	 * @param callback The Delegate to be called
+	 * @param priority Lane to use
+	 * @retval bool false if callback could not be queued
+	 * @note If the lane is full the callback is placed in a dynamically allocated spill list
+	 * which is drained, in order, as space becomes available.
+	 * DO NOT use from interrupt context.
+	 */
+	static bool queueCallback(TaskDelegate callback, TaskPriority priority);
+
+	/**
+	 * @brief Queue a callback to run after a delay
+	 * @param delayMs Minimum time to wait before callback is queued
+	 * @param callback The function to be called
+	 * @param param Parameter passed to the callback
+	 * @param priority Lane to use
+	 * @retval bool false if callback could not be queued
+	 * @note All deferred callbacks share a single system timer.
+	 * When due, the callback is placed in the requested lane so is subject to the usual queueing delays.
+	 * DO NOT use from interrupt context.
+	 */
+	static bool queueDeferredCallback(uint32_t delayMs, TaskCallback callback, void* param = nullptr,
+									  TaskPriority priority = TaskPriority::Normal);
+
+	/**
+	 * @brief Queue a Delegate callback to run after a delay
+	 */
+	static bool queueDeferredCallback(uint32_t delayMs, TaskDelegate callback,
+									  TaskPriority priority = TaskPriority::Normal);
 
 	/** @brief Get number of tasks currently on queue
-	 *  @retval unsigned
+	 *  @retval unsigned Total for all priority lanes
 	 */
-	static unsigned getTaskCount()
-	{
-#ifdef ENABLE_TASK_COUNT
-		return taskCount;
-#else
-		return 255;
-#endif
-	}
+	static unsigned getTaskCount();
 
 	/** @brief Get maximum number of tasks seen on queue at any one time
-	 *  @retval unsigned
+	 *  @retval unsigned Sum of the maximum for each priority lane
 	 *  @note If return value is higher than maximum task queue TASK_QUEUE_LENGTH then
-	 *  the queue has overflowed at some point and tasks have been left un-executed.
+	 *  at least one lane has overflowed at some point. Check `getTaskStats()` for details.
 	 */
-	static unsigned getMaxTaskCount()
-	{
-#ifdef ENABLE_TASK_COUNT
-		return maxTaskCount;
-#else
-		return 255;
-#endif
-	}
+	static unsigned getMaxTaskCount();
+
+	/**
+	 * @brief Get statistics for a task queue priority lane
+	 */
+	static const TaskQueueStats& getTaskStats(TaskPriority priority);
+
+	/**
+	 * @brief Reset maximum values and counters for all priority lanes
+	 */
+	static void resetTaskStats();
 
 private:
 	static void taskHandler(os_event_t* event);
 
 private:
 	static SystemState state;
-	static os_event_t taskQueue[]; ///< OS task queue
-#ifdef ENABLE_TASK_COUNT
-	static volatile uint8_t taskCount;	///< Number of tasks on queue
-	static volatile uint8_t maxTaskCount; ///< Profiling to establish appropriate queue size
-#endif
+	static os_event_t taskQueue[]; ///< OS task queue, used to schedule taskHandler
 };
 
 /**	@brief	Global instance of system object
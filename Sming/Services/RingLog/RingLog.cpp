@@ -0,0 +1,369 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * RingLog.cpp
+ *
+ ****/
+
+#include "RingLog.h"
+#include <debug_progmem.h>
+#include <algorithm>
+#include <cstddef>
+
+namespace Storage
+{
+namespace
+{
+constexpr uint32_t sectorMagic{0x474c4752}; // "RGLG"
+
+/*
+ * Standard (zlib-compatible) CRC32 using a 16-entry table to keep RAM usage down
+ */
+uint32_t crc32(uint32_t crc, const void* data, size_t length)
+{
+	static const uint32_t table[16]{
+		0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+		0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+	};
+
+	auto ptr = static_cast<const uint8_t*>(data);
+	crc = ~crc;
+	while(length-- != 0) {
+		crc ^= *ptr++;
+		crc = (crc >> 4) ^ table[crc & 0x0f];
+		crc = (crc >> 4) ^ table[crc & 0x0f];
+	}
+	return ~crc;
+}
+
+} // namespace
+
+/* RingLog::Iterator */
+
+RingLog::Iterator::Iterator(RingLog& log, Position pos) : log(&log)
+{
+	seek(pos);
+}
+
+void RingLog::Iterator::seek(Position pos)
+{
+	valid = false;
+	if(log->isEmpty()) {
+		return;
+	}
+
+	for(;;) {
+		if(pos.sequence < log->tailSequence) {
+			// Sector has been re-used since we last looked
+			pos = log->getStartPosition();
+		}
+		if(pos.sequence > log->headSequence) {
+			return;
+		}
+
+		auto nextSector = [&]() {
+			++pos.sequence;
+			pos.offset = sizeof(SectorHeader);
+		};
+
+		if(pos.offset == sizeof(SectorHeader)) {
+			uint32_t seq;
+			if(!log->readSector(pos.sequence % log->sectorCount, seq) || seq != pos.sequence) {
+				nextSector();
+				continue;
+			}
+		}
+
+		size_t limit = (pos.sequence == log->headSequence) ? log->dataEnd : log->sectorSize;
+		if(pos.offset + sizeof(RecordHeader) > limit || !log->readRecord(pos, record)) {
+			nextSector();
+			continue;
+		}
+
+		valid = true;
+		return;
+	}
+}
+
+void RingLog::Iterator::next()
+{
+	if(!valid) {
+		return;
+	}
+
+	auto pos = record.pos;
+	pos.offset = align(pos.offset + sizeof(RecordHeader) + record.length);
+	seek(pos);
+}
+
+/* RingLog */
+
+bool RingLog::mount(Partition part)
+{
+	unmount();
+	stats = {};
+
+	if(!part) {
+		return false;
+	}
+
+	auto blockSize = part.getBlockSize();
+	if(blockSize < 256 || blockSize > 0x8000) {
+		debug_e("[RingLog] Unsupported block size %u", unsigned(blockSize));
+		return false;
+	}
+
+	auto count = part.size() / blockSize;
+	if(count < 2 || count > 0xffff) {
+		debug_e("[RingLog] Partition '%s' requires at least 2 blocks", part.name().c_str());
+		return false;
+	}
+
+	partition = part;
+	sectorSize = blockSize;
+	sectorCount = count;
+	mounted = true;
+
+	empty = !findHead();
+	if(empty) {
+		writeOffset = dataEnd = sizeof(SectorHeader);
+	} else {
+		scanHead();
+	}
+
+	debug_i("[RingLog] Mounted '%s', %u sectors, head #%u, tail #%u, offset %u", partition.name().c_str(), sectorCount,
+			headSequence, tailSequence, writeOffset);
+	return true;
+}
+
+bool RingLog::format(Partition part)
+{
+	if(!part || !part.erase_range(0, part.size())) {
+		return false;
+	}
+
+	return mount(part);
+}
+
+size_t RingLog::getMaxRecordSize() const
+{
+	return mounted ? (sectorSize - sizeof(SectorHeader) - sizeof(RecordHeader)) : 0;
+}
+
+bool RingLog::readSector(uint16_t index, uint32_t& sequence)
+{
+	SectorHeader hdr;
+	if(!partition.read(storage_size_t(index) * sectorSize, hdr)) {
+		return false;
+	}
+	if(hdr.magic != sectorMagic || hdr.crc != crc32(0, &hdr, offsetof(SectorHeader, crc))) {
+		return false;
+	}
+	if(hdr.sequence % sectorCount != index) {
+		return false;
+	}
+
+	sequence = hdr.sequence;
+	return true;
+}
+
+bool RingLog::findHead()
+{
+	uint32_t seq0;
+	uint32_t seq;
+	if(readSector(0, seq0)) {
+		/*
+		 * Sectors [0, head] contain consecutive sequence numbers starting at seq0.
+		 * Any following sectors are either older or unused.
+		 */
+		unsigned lo = 0;
+		unsigned hi = sectorCount;
+		while(hi - lo > 1) {
+			auto mid = (lo + hi) / 2;
+			if(readSector(mid, seq) && seq == seq0 + mid) {
+				lo = mid;
+			} else {
+				hi = mid;
+			}
+		}
+		headSequence = seq0 + lo;
+	} else if(readSector(sectorCount - 1, seq)) {
+		// Log wrapped and sector #0 was being re-used when power was lost
+		headSequence = seq;
+	} else {
+		return false;
+	}
+
+	tailSequence = (headSequence >= sectorCount - 1U) ? (headSequence - sectorCount + 1) : 0;
+	while(tailSequence < headSequence) {
+		if(readSector(tailSequence % sectorCount, seq) && seq == tailSequence) {
+			break;
+		}
+		++tailSequence;
+	}
+
+	return true;
+}
+
+bool RingLog::readRecord(Position pos, Record& record)
+{
+	RecordHeader hdr;
+	if(!partition.read(getAddress(pos), hdr)) {
+		return false;
+	}
+	if(hdr.check != uint16_t(~hdr.length)) {
+		return false;
+	}
+	if(pos.offset + sizeof(RecordHeader) + hdr.length > sectorSize) {
+		return false;
+	}
+
+	record.pos = pos;
+	record.length = hdr.length;
+	record.crc = hdr.crc;
+	return true;
+}
+
+void RingLog::scanHead()
+{
+	Position pos{headSequence, sizeof(SectorHeader)};
+	bool closed{false};
+	while(pos.offset + sizeof(RecordHeader) <= sectorSize) {
+		RecordHeader hdr;
+		if(!partition.read(getAddress(pos), hdr)) {
+			closed = true;
+			break;
+		}
+		if(hdr.length == 0xffff && hdr.check == 0xffff && hdr.crc == 0xffffffff) {
+			// Free space
+			break;
+		}
+
+		Record record;
+		if(!readRecord(pos, record) || !verify(record)) {
+			debug_w("[RingLog] Incomplete record at #%u @ 0x%04x", pos.sequence, pos.offset);
+			invalidate(pos);
+			closed = true;
+			break;
+		}
+		pos.offset = align(pos.offset + sizeof(RecordHeader) + record.length);
+	}
+
+	dataEnd = std::min(size_t(pos.offset), sectorSize);
+	writeOffset = closed ? sectorSize : dataEnd;
+}
+
+void RingLog::invalidate(Position pos)
+{
+	/*
+	 * Clearing bits is always possible without an erase, and a zeroed header fails validation.
+	 * Iterators then skip the remainder of the sector.
+	 */
+	RecordHeader hdr{};
+	partition.write(getAddress(pos), &hdr, sizeof(hdr));
+}
+
+bool RingLog::openSector(uint32_t sequence)
+{
+	if(empty) {
+		tailSequence = sequence;
+	} else if(sequence - tailSequence >= sectorCount) {
+		// Oldest sector is about to be discarded
+		tailSequence = sequence - sectorCount + 1;
+	}
+
+	auto addr = storage_size_t(sequence % sectorCount) * sectorSize;
+	if(!partition.erase_range(addr, sectorSize)) {
+		return false;
+	}
+	++stats.sectorErases;
+
+	SectorHeader hdr{sectorMagic, sequence, 0};
+	hdr.crc = crc32(0, &hdr, offsetof(SectorHeader, crc));
+	if(!partition.write(addr, &hdr, sizeof(hdr))) {
+		return false;
+	}
+
+	empty = false;
+	headSequence = sequence;
+	writeOffset = dataEnd = sizeof(SectorHeader);
+	return true;
+}
+
+bool RingLog::append(const void* data, size_t length)
+{
+	if(!mounted || length > getMaxRecordSize()) {
+		++stats.appendFailures;
+		return false;
+	}
+
+	auto recordSize = sizeof(RecordHeader) + length;
+	if(empty || writeOffset + recordSize > sectorSize) {
+		if(!openSector(empty ? 0 : headSequence + 1)) {
+			++stats.appendFailures;
+			return false;
+		}
+	}
+
+	RecordHeader hdr{uint16_t(length), uint16_t(~length), crc32(0, data, length)};
+	auto addr = getAddress(getWritePosition());
+	bool ok = partition.write(addr, &hdr, sizeof(hdr));
+	if(ok && length != 0) {
+		ok = partition.write(addr + sizeof(hdr), data, length);
+	}
+	if(!ok) {
+		// Don't attempt to write anything else into this sector
+		invalidate(getWritePosition());
+		writeOffset = sectorSize;
+		++stats.appendFailures;
+		return false;
+	}
+
+	writeOffset = dataEnd = std::min(align(writeOffset + recordSize), sectorSize);
+	++stats.appendCount;
+	stats.appendBytes += length;
+	return true;
+}
+
+size_t RingLog::read(const Record& record, uint16_t offset, void* buffer, size_t length)
+{
+	if(!mounted || offset >= record.length) {
+		return 0;
+	}
+
+	length = std::min(length, size_t(record.length - offset));
+	auto addr = getAddress(record.pos) + sizeof(RecordHeader) + offset;
+	return partition.read(addr, buffer, length) ? length : 0;
+}
+
+String RingLog::getContent(const Record& record)
+{
+	String s;
+	if(!s.setLength(record.length)) {
+		return nullptr;
+	}
+	if(read(record, 0, s.begin(), record.length) != record.length) {
+		return nullptr;
+	}
+	return s;
+}
+
+bool RingLog::verify(const Record& record)
+{
+	uint8_t buffer[64];
+	uint32_t crc{0};
+	for(uint16_t offset = 0; offset < record.length;) {
+		auto len = read(record, offset, buffer, sizeof(buffer));
+		if(len == 0) {
+			return false;
+		}
+		crc = crc32(crc, buffer, len);
+		offset += len;
+	}
+	return crc == record.crc;
+}
+
+} // namespace Storage
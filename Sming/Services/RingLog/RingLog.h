@@ -0,0 +1,318 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * RingLog.h - Append-only record log stored directly in a flash partition
+ *
+ ****/
+
+#pragma once
+
+#include <Storage/Partition.h>
+#include <WString.h>
+#include <iterator>
+
+namespace Storage
+{
+/**
+ * @brief Append-only, power-safe record log operating directly on a partition
+ *
+ * The partition is treated as a ring of erase blocks (sectors). Each sector starts with a
+ * small header carrying a sequence number, followed by variable-length records.
+ * Sector with sequence `n` always lives at index `n % sectorCount`, so mounting only requires
+ * a binary search of sector headers plus a scan of the most recent sector.
+ *
+ * When the log is full the oldest sector is erased and re-used.
+ *
+ * Each record is protected by a CRC. A record interrupted by power loss is detected at mount time;
+ * the affected sector is closed and writing continues in the next sector.
+ */
+class RingLog
+{
+public:
+	/**
+	 * @brief Identifies a location within the log
+	 */
+	struct Position {
+		uint32_t sequence; ///< Sector sequence number
+		uint16_t offset;   ///< Offset from start of sector
+
+		bool operator==(const Position& other) const
+		{
+			return sequence == other.sequence && offset == other.offset;
+		}
+
+		bool operator!=(const Position& other) const
+		{
+			return !operator==(other);
+		}
+	};
+
+	/**
+	 * @brief Describes a single record
+	 */
+	struct Record {
+		Position pos;
+		uint16_t length; ///< Size of record payload in bytes
+		uint32_t crc;	///< CRC32 of payload
+	};
+
+	/**
+	 * @brief Usage statistics since mount
+	 */
+	struct Stats {
+		uint32_t appendCount;	///< Number of records successfully written
+		uint32_t appendBytes;	///< Total payload bytes written
+		uint32_t appendFailures; ///< Number of failed append calls
+		uint32_t sectorErases;   ///< Number of sectors erased
+	};
+
+	/**
+	 * @brief Forward iterator over records, oldest first
+	 */
+	class Iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Record;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const Record*;
+		using reference = const Record&;
+
+		Iterator(RingLog& log) : log(&log)
+		{
+		}
+
+		Iterator(RingLog& log, Position pos);
+
+		explicit operator bool() const
+		{
+			return valid;
+		}
+
+		Iterator operator++(int)
+		{
+			auto result = *this;
+			next();
+			return result;
+		}
+
+		Iterator& operator++()
+		{
+			next();
+			return *this;
+		}
+
+		bool operator==(const Iterator& other) const
+		{
+			return valid == other.valid && (!valid || record.pos == other.record.pos);
+		}
+
+		bool operator!=(const Iterator& other) const
+		{
+			return !operator==(other);
+		}
+
+		const Record& operator*() const
+		{
+			return record;
+		}
+
+		const Record* operator->() const
+		{
+			return &record;
+		}
+
+	private:
+		void seek(Position pos);
+		void next();
+
+		RingLog* log;
+		Record record{};
+		bool valid{false};
+	};
+
+	RingLog() = default;
+
+	RingLog(const RingLog&) = delete;
+	RingLog& operator=(const RingLog&) = delete;
+
+	/**
+	 * @brief Mount an existing log, creating an empty one if necessary
+	 * @param partition Partition to use. Size must be a multiple of the erase block size.
+	 * @retval bool true on success
+	 *
+	 * Existing content is never erased by mounting; unrecognised sectors are
+	 * treated as free space and erased when first required.
+	 */
+	bool mount(Partition partition);
+
+	/**
+	 * @brief Erase partition content and mount empty log
+	 */
+	bool format(Partition partition);
+
+	/**
+	 * @brief Detach from partition
+	 */
+	void unmount()
+	{
+		partition = Partition{};
+		mounted = false;
+	}
+
+	bool isMounted() const
+	{
+		return mounted;
+	}
+
+	/**
+	 * @brief Append a new record to the log
+	 * @param data Record payload
+	 * @param length Size of payload, must not exceed `getMaxRecordSize()`
+	 * @retval bool true on success
+	 *
+	 * Records never span sectors. If there is insufficient space in the current sector
+	 * then the next sector is erased first, discarding the oldest records if the log is full.
+	 */
+	bool append(const void* data, size_t length);
+
+	bool append(const String& s)
+	{
+		return append(s.c_str(), s.length());
+	}
+
+	/**
+	 * @brief Read part of a record payload
+	 * @param record Record obtained via iterator
+	 * @param offset Offset into the payload
+	 * @param buffer Destination
+	 * @param length Number of bytes to read
+	 * @retval size_t Number of bytes read
+	 */
+	size_t read(const Record& record, uint16_t offset, void* buffer, size_t length);
+
+	/**
+	 * @brief Get payload of a record as a String
+	 */
+	String getContent(const Record& record);
+
+	/**
+	 * @brief Read record payload and check it against the stored CRC
+	 */
+	bool verify(const Record& record);
+
+	Iterator begin()
+	{
+		return Iterator(*this, getStartPosition());
+	}
+
+	Iterator end()
+	{
+		return Iterator(*this);
+	}
+
+	/**
+	 * @brief Get position of oldest record in the log
+	 */
+	Position getStartPosition() const
+	{
+		return Position{tailSequence, sizeof(SectorHeader)};
+	}
+
+	/**
+	 * @brief Get position at which next record will be written
+	 *
+	 * If the current sector is full the next append will occur in a new sector.
+	 */
+	Position getWritePosition() const
+	{
+		return Position{headSequence, writeOffset};
+	}
+
+	/**
+	 * @brief Get partition offset corresponding to a given log position
+	 */
+	storage_size_t getAddress(Position pos) const
+	{
+		return storage_size_t(pos.sequence % sectorCount) * sectorSize + pos.offset;
+	}
+
+	/**
+	 * @brief Largest payload which can be stored in a single record
+	 */
+	size_t getMaxRecordSize() const;
+
+	uint16_t getSectorCount() const
+	{
+		return sectorCount;
+	}
+
+	size_t getSectorSize() const
+	{
+		return sectorSize;
+	}
+
+	/**
+	 * @brief Get number of sectors currently holding records
+	 */
+	uint16_t getUsedSectors() const
+	{
+		return isEmpty() ? 0 : 1 + headSequence - tailSequence;
+	}
+
+	bool isEmpty() const
+	{
+		return !mounted || empty;
+	}
+
+	const Stats& getStats() const
+	{
+		return stats;
+	}
+
+	Partition getPartition() const
+	{
+		return partition;
+	}
+
+private:
+	struct SectorHeader {
+		uint32_t magic;
+		uint32_t sequence;
+		uint32_t crc; ///< Covers magic and sequence
+	};
+
+	struct RecordHeader {
+		uint16_t length;
+		uint16_t check; ///< Inverse of length, detects partially written headers
+		uint32_t crc;	///< Covers payload
+	};
+
+	static constexpr size_t align(size_t size)
+	{
+		return (size + 3) & ~3U;
+	}
+
+	bool readSector(uint16_t index, uint32_t& sequence);
+	bool readRecord(Position pos, Record& record);
+	bool openSector(uint32_t sequence);
+	void invalidate(Position pos);
+	void scanHead();
+	bool findHead();
+
+	Partition partition;
+	size_t sectorSize{0};
+	uint16_t sectorCount{0};
+	uint32_t headSequence{0};
+	uint32_t tailSequence{0};
+	uint16_t writeOffset{0};
+	uint16_t dataEnd{0}; ///< End of valid records in head sector
+	bool mounted{false};
+	bool empty{true};
+	Stats stats{};
+};
+
+} // namespace Storage
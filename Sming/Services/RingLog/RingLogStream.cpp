@@ -0,0 +1,60 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * RingLogStream.cpp
+ *
+ ****/
+
+#include "RingLogStream.h"
+
+namespace Storage
+{
+void RingLogStream::skipEmpty()
+{
+	while(current && recordOffset >= current->length) {
+		++current;
+		recordOffset = 0;
+	}
+}
+
+uint16_t RingLogStream::readMemoryBlock(char* data, int bufSize)
+{
+	// Fill as much of the buffer as possible without changing stream position
+	auto it = current;
+	auto offset = recordOffset;
+	uint16_t count{0};
+	while(it && bufSize > 0) {
+		auto len = log.read(*it, offset, data, bufSize);
+		count += len;
+		data += len;
+		bufSize -= len;
+		offset += len;
+		if(offset < it->length) {
+			break;
+		}
+		++it;
+		offset = 0;
+	}
+	return count;
+}
+
+bool RingLogStream::seek(int len)
+{
+	if(len < 0) {
+		return false;
+	}
+
+	while(current && len > 0) {
+		auto n = std::min(len, current->length - recordOffset);
+		recordOffset += n;
+		len -= n;
+		skipEmpty();
+	}
+
+	return len == 0;
+}
+
+} // namespace Storage
@@ -0,0 +1,71 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * RingLogStream.h
+ *
+ ****/
+
+#pragma once
+
+#include <Data/Stream/DataSourceStream.h>
+#include "RingLog.h"
+
+namespace Storage
+{
+/**
+ * @brief Read-only stream presenting record payloads from a RingLog as contiguous data
+ *
+ * Records are read oldest first. No separators are inserted between records,
+ * so applications typically terminate each record with a newline.
+ *
+ * @ingroup stream
+ */
+class RingLogStream : public IDataSourceStream
+{
+public:
+	/**
+	 * @brief Stream entire log content
+	 */
+	RingLogStream(RingLog& log) : RingLogStream(log, log.getStartPosition())
+	{
+	}
+
+	/**
+	 * @brief Stream log content starting at a given record position
+	 */
+	RingLogStream(RingLog& log, RingLog::Position start) : log(log), current(log, start)
+	{
+		skipEmpty();
+	}
+
+	StreamType getStreamType() const override
+	{
+		return eSST_User;
+	}
+
+	uint16_t readMemoryBlock(char* data, int bufSize) override;
+
+	bool seek(int len) override;
+
+	bool isFinished() override
+	{
+		return !current;
+	}
+
+	MimeType getMimeType() const override
+	{
+		return MIME_TEXT;
+	}
+
+private:
+	void skipEmpty();
+
+	RingLog& log;
+	RingLog::Iterator current;
+	uint16_t recordOffset{0}; ///< Read position within current record
+};
+
+} // namespace Storage
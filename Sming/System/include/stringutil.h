@@ -20,6 +20,7 @@ extern "C" {
 #endif
 
 #include "stddef.h"
+#include <string.h>
 
 /** @brief Return pointer to occurrence of substring in string. Case insensitive.
    * @param[in] pString string to work with
@@ -50,9 +51,69 @@ void* memrchr(const void* s, int c, size_t n);
 
 /**
  * @brief Compare block of memory without case sensitivity
+ * @note Only ASCII characters are folded, as with `tolower()` in the C locale
  */
 int memicmp(const void* buf1, const void* buf2, size_t len);
 
+/**
+ * @name Word-at-a-time search functions
+ *
+ * These examine four bytes per iteration instead of one, which is considerably faster than the
+ * byte-by-byte loops in the toolchain libraries for most of our targets.
+ * Use the `_fast` variants which select the best implementation for the architecture.
+ *
+ * @{
+ */
+
+/**
+ * @brief Find first occurrence of a character in a block of memory
+ */
+void* memchr_swar(const void* s, int c, size_t n);
+
+/**
+ * @brief Find first occurrence of a block of memory within another
+ * @retval void* `NULL` if not found
+ */
+void* memmem_swar(const void* haystack, size_t haystacklen, const void* needle, size_t needlelen);
+
+/**
+ * @brief Case-insensitive version of `memmem()`
+ * @retval void* `NULL` if not found
+ */
+void* memmemi(const void* haystack, size_t haystacklen, const void* needle, size_t needlelen);
+
+/*
+ * The GNU C library has vectorised implementations of these functions, so we use those on Host.
+ * The SWAR versions don't need any particular instruction set so are used everywhere else.
+ */
+#ifndef STRING_SEARCH_USE_LIBC
+#if defined(ARCH_HOST) && defined(__GLIBC__)
+#define STRING_SEARCH_USE_LIBC 1
+#else
+#define STRING_SEARCH_USE_LIBC 0
+#endif
+#endif
+
+static inline void* memchr_fast(const void* s, int c, size_t n)
+{
+#if STRING_SEARCH_USE_LIBC
+	return (void*)memchr(s, c, n);
+#else
+	return memchr_swar(s, c, n);
+#endif
+}
+
+static inline void* memmem_fast(const void* haystack, size_t haystacklen, const void* needle, size_t needlelen)
+{
+#if STRING_SEARCH_USE_LIBC
+	return memmem(haystack, haystacklen, needle, needlelen);
+#else
+	return memmem_swar(haystack, haystacklen, needle, needlelen);
+#endif
+}
+
+/** @} */
+
 /**
  * @brief Return hex character corresponding to given value
  * @param c Value from 0-15, others are invalid
@@ -0,0 +1,211 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * stringsearch.cpp
+ *
+ *  Word-at-a-time (SWAR, 'SIMD within a register') string search and compare functions.
+ *
+ *  Memory is only read a word at a time from aligned addresses: unaligned accesses fault on Xtensa
+ *  and are slow elsewhere. Leading and trailing bytes are handled individually.
+ *
+ ****/
+
+#include "stringutil.h"
+#include <cstdint>
+
+namespace
+{
+using word_t = uint32_t;
+
+constexpr word_t repeat(uint8_t c)
+{
+	return c * 0x01010101U;
+}
+
+constexpr word_t lowBits{repeat(0x01)};
+constexpr word_t highBits{repeat(0x80)};
+
+bool isAligned(const void* p)
+{
+	return (uintptr_t(p) & (sizeof(word_t) - 1)) == 0;
+}
+
+word_t readWord(const uint8_t* p)
+{
+	word_t w;
+	memcpy(&w, __builtin_assume_aligned(p, sizeof(word_t)), sizeof(w));
+	return w;
+}
+
+/*
+ * Non-zero if any byte in the word is zero.
+ * Bytes following a zero byte may be flagged incorrectly, so don't use this to locate the byte.
+ */
+word_t hasZeroByte(word_t v)
+{
+	return (v - lowBits) & ~v & highBits;
+}
+
+uint8_t toLower(uint8_t c)
+{
+	return (c >= 'A' && c <= 'Z') ? c + 'a' - 'A' : c;
+}
+
+/*
+ * Convert ASCII upper-case characters in a word to lower case
+ */
+word_t toLower(word_t w)
+{
+	word_t heptets = w & ~highBits;
+	// Each byte gets top bit set if >= 'A', and if > 'Z'
+	word_t geA = heptets + repeat(0x80 - 'A');
+	word_t gtZ = heptets + repeat(0x80 - 'Z' - 1);
+	word_t isUpper = geA & ~gtZ & ~w & highBits;
+	return w | (isUpper >> 2);
+}
+
+/*
+ * Find first occurrence of either of two characters
+ */
+const uint8_t* findEither(const uint8_t* p, uint8_t c1, uint8_t c2, size_t n)
+{
+	while(n != 0 && !isAligned(p)) {
+		if(*p == c1 || *p == c2) {
+			return p;
+		}
+		++p;
+		--n;
+	}
+
+	auto pattern1 = repeat(c1);
+	auto pattern2 = repeat(c2);
+	while(n >= sizeof(word_t)) {
+		auto w = readWord(p);
+		if(hasZeroByte(w ^ pattern1) | hasZeroByte(w ^ pattern2)) {
+			break;
+		}
+		p += sizeof(word_t);
+		n -= sizeof(word_t);
+	}
+
+	for(; n != 0; ++p, --n) {
+		if(*p == c1 || *p == c2) {
+			return p;
+		}
+	}
+	return nullptr;
+}
+
+} // namespace
+
+void* memchr_swar(const void* s, int c, size_t n)
+{
+	auto p = static_cast<const uint8_t*>(s);
+	uint8_t ch = c;
+	while(n != 0 && !isAligned(p)) {
+		if(*p == ch) {
+			return const_cast<uint8_t*>(p);
+		}
+		++p;
+		--n;
+	}
+
+	auto pattern = repeat(ch);
+	while(n >= sizeof(word_t) && !hasZeroByte(readWord(p) ^ pattern)) {
+		p += sizeof(word_t);
+		n -= sizeof(word_t);
+	}
+
+	for(; n != 0; ++p, --n) {
+		if(*p == ch) {
+			return const_cast<uint8_t*>(p);
+		}
+	}
+	return nullptr;
+}
+
+void* memmem_swar(const void* haystack, size_t haystacklen, const void* needle, size_t needlelen)
+{
+	auto p = static_cast<const uint8_t*>(haystack);
+	if(needlelen == 0) {
+		return const_cast<uint8_t*>(p);
+	}
+	if(haystacklen < needlelen) {
+		return nullptr;
+	}
+
+	auto str = static_cast<const uint8_t*>(needle);
+	auto end = p + haystacklen - needlelen + 1;
+	while((p = static_cast<const uint8_t*>(memchr_swar(p, str[0], end - p))) != nullptr) {
+		if(memcmp(p + 1, str + 1, needlelen - 1) == 0) {
+			return const_cast<uint8_t*>(p);
+		}
+		++p;
+	}
+	return nullptr;
+}
+
+void* memmemi(const void* haystack, size_t haystacklen, const void* needle, size_t needlelen)
+{
+	auto p = static_cast<const uint8_t*>(haystack);
+	if(needlelen == 0) {
+		return const_cast<uint8_t*>(p);
+	}
+	if(haystacklen < needlelen) {
+		return nullptr;
+	}
+
+	auto str = static_cast<const uint8_t*>(needle);
+	uint8_t lower = toLower(str[0]);
+	uint8_t upper = (lower >= 'a' && lower <= 'z') ? lower + 'A' - 'a' : lower;
+	auto end = p + haystacklen - needlelen + 1;
+	while((p = findEither(p, lower, upper, end - p)) != nullptr) {
+		if(memicmp(p + 1, str + 1, needlelen - 1) == 0) {
+			return const_cast<uint8_t*>(p);
+		}
+		++p;
+	}
+	return nullptr;
+}
+
+int memicmp(const void* buf1, const void* buf2, size_t len)
+{
+	auto p1 = static_cast<const uint8_t*>(buf1);
+	auto p2 = static_cast<const uint8_t*>(buf2);
+
+	if(p1 == p2) {
+		return 0;
+	}
+
+	// Word comparison only possible if both buffers have the same alignment
+	if(((uintptr_t(p1) ^ uintptr_t(p2)) & (sizeof(word_t) - 1)) == 0) {
+		for(; len != 0 && !isAligned(p1); --len) {
+			int result = toLower(*p1++) - toLower(*p2++);
+			if(result != 0) {
+				return result;
+			}
+		}
+		while(len >= sizeof(word_t)) {
+			auto w1 = readWord(p1);
+			auto w2 = readWord(p2);
+			if(w1 != w2 && toLower(w1) != toLower(w2)) {
+				break;
+			}
+			p1 += sizeof(word_t);
+			p2 += sizeof(word_t);
+			len -= sizeof(word_t);
+		}
+	}
+
+	for(; len != 0; --len) {
+		int result = toLower(*p1++) - toLower(*p2++);
+		if(result != 0) {
+			return result;
+		}
+	}
+
+	return 0;
+}
@@ -36,9 +36,15 @@
 
 /**
  * @brief HashMap class template
+ * @tparam K Key type
+ * @tparam V Value type
+ * @tparam KeyList Storage for keys
+ * @tparam ValueList Storage for values
  * @ingroup wiring
  */
-template <typename K, typename V> class HashMap
+template <typename K, typename V, typename KeyList = wiring_private::List<K>,
+		  typename ValueList = wiring_private::List<V>>
+class HashMap
 {
 public:
 	template <bool is_const> struct BaseElement {
@@ -384,7 +390,7 @@ public:
 		currentIndex = 0;
 	}
 
-	void setMultiple(const HashMap<K, V>& map)
+	template <class MapType> void setMultiple(const MapType& map)
 	{
 		for(auto e : map) {
 			(*this)[e.key()] = e.value();
@@ -417,9 +423,6 @@ public:
 	}
 
 protected:
-	using KeyList = wiring_private::List<K>;
-	using ValueList = wiring_private::List<V>;
-
 	KeyList keys;
 	ValueList values;
 	Comparator cb_comparator{nullptr};
@@ -427,11 +430,12 @@ protected:
 	V nil{};
 
 private:
-	HashMap(const HashMap<K, V>& that);
+	HashMap(const HashMap& that);
 	HashMap& operator=(const HashMap& that);
 };
 
-template <typename K, typename V> V& HashMap<K, V>::operator[](const K& key)
+template <typename K, typename V, typename KeyList, typename ValueList>
+V& HashMap<K, V, KeyList, ValueList>::operator[](const K& key)
 {
 	int i = indexOf(key);
 	if(i >= 0) {
@@ -446,7 +450,8 @@ template <typename K, typename V> V& HashMap<K, V>::operator[](const K& key)
 	return values[currentIndex - 1];
 }
 
-template <typename K, typename V> void HashMap<K, V>::sort(SortCompare compare)
+template <typename K, typename V, typename KeyList, typename ValueList>
+void HashMap<K, V, KeyList, ValueList>::sort(SortCompare compare)
 {
 	auto n = count();
 	for(unsigned i = 0; i < n - 1; ++i) {
@@ -460,3 +465,17 @@ template <typename K, typename V> void HashMap<K, V>::sort(SortCompare compare)
 		}
 	}
 }
+
+/**
+ * @brief HashMap with inline storage for a small number of entries
+ * @tparam K Key type
+ * @tparam V Value type
+ * @tparam inlineCount Number of entries which may be stored without using the heap
+ *
+ * Keys and values are stored contiguously so must be default-constructible
+ * and satisfy `wiring_private::is_relocatable`.
+ *
+ * @ingroup wiring
+ */
+template <typename K, typename V, size_t inlineCount>
+using SmallMap = HashMap<K, V, wiring_private::SmallList<K, inlineCount>, wiring_private::SmallList<V, inlineCount>>;
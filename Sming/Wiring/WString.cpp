@@ -591,7 +591,7 @@ bool String::equalsIgnoreCase(const char* cstr) const
 	if(buf == cstr) {
 		return true;
 	}
-	return strcasecmp(cstr, buf) == 0;
+	return strlen(cstr) == len && memicmp(buf, cstr, len) == 0;
 }
 
 bool String::equalsIgnoreCase(const char* cstr, size_t length) const
@@ -693,7 +693,7 @@ int String::indexOf(char ch, size_t fromIndex) const
 		return -1;
 	}
 	auto buf = cbuffer();
-	auto temp = memchr(buf + fromIndex, ch, len - fromIndex);
+	auto temp = memchr_fast(buf + fromIndex, ch, len - fromIndex);
 	if(temp == nullptr) {
 		return -1;
 	}
@@ -707,7 +707,7 @@ int String::indexOf(const char* s2_buf, size_t fromIndex, size_t s2_len) const
 		return -1;
 	}
 	auto buf = cbuffer();
-	auto found = memmem(buf + fromIndex, len - fromIndex, s2_buf, s2_len);
+	auto found = memmem_fast(buf + fromIndex, len - fromIndex, s2_buf, s2_len);
 	if(found == nullptr) {
 		return -1;
 	}
@@ -761,7 +761,7 @@ int String::lastIndexOf(const char* s2_buf, size_t fromIndex, size_t s2_len) con
 	}
 	int found = -1;
 	for(auto p = buf; p <= buf + fromIndex; p++) {
-		p = static_cast<const char*>(memmem(p, buf + len - p, s2_buf, s2_len));
+		p = static_cast<const char*>(memmem_fast(p, buf + len - p, s2_buf, s2_len));
 		if(!p) {
 			break;
 		}
@@ -819,7 +819,7 @@ bool String::replace(const char* find_buf, size_t find_len, const char* replace_
 	const char* end = buf + len;
 	char* foundAt;
 	if(diff == 0) {
-		while((foundAt = (char*)memmem(readFrom, end - readFrom, find_buf, find_len)) != nullptr) {
+		while((foundAt = (char*)memmem_fast(readFrom, end - readFrom, find_buf, find_len)) != nullptr) {
 			if(replace_len) {
 				memcpy(foundAt, replace_buf, replace_len);
 			}
@@ -827,7 +827,7 @@ bool String::replace(const char* find_buf, size_t find_len, const char* replace_
 		}
 	} else if(diff < 0) {
 		char* writeTo = buf;
-		while((foundAt = (char*)memmem(readFrom, end - readFrom, find_buf, find_len)) != nullptr) {
+		while((foundAt = (char*)memmem_fast(readFrom, end - readFrom, find_buf, find_len)) != nullptr) {
 			size_t n = foundAt - readFrom;
 			memmove(writeTo, readFrom, n);
 			writeTo += n;
@@ -842,7 +842,7 @@ bool String::replace(const char* find_buf, size_t find_len, const char* replace_
 		setlen(len);
 	} else {
 		size_t size = len; // compute size needed for result
-		while((foundAt = (char*)memmem(readFrom, end - readFrom, find_buf, find_len)) != nullptr) {
+		while((foundAt = (char*)memmem_fast(readFrom, end - readFrom, find_buf, find_len)) != nullptr) {
 			readFrom = foundAt + find_len;
 			size += diff;
 		}
@@ -26,9 +26,13 @@
 
 /**
  * @brief Vector class template
+ * @tparam Element Type of object stored in vector
+ * @tparam ElementList Storage implementation. By default, objects are allocated individually
+ * and the vector stores pointers to them. See `ContiguousVector`.
  * @ingroup wiring
  */
-template <typename Element> class Vector : public Countable<Element>
+template <typename Element, typename ElementList = wiring_private::List<Element>>
+class Vector : public Countable<Element>
 {
 public:
 	using Comparer = int (*)(const Element& lhs, const Element& rhs);
@@ -101,6 +105,13 @@ public:
 		unsigned index{0};
 	};
 
+	/**
+	 * @brief Constructor
+	 * @param initialCapacity Number of elements to allocate initially
+	 * @param capacityIncrement Number of additional elements allocated when vector is full.
+	 * Use 0 for geometric growth, where capacity is increased by half each time.
+	 * This greatly reduces the number of reallocations when adding many elements.
+	 */
 	Vector(unsigned int initialCapacity = 10, unsigned int capacityIncrement = 10) : _increment(capacityIncrement)
 	{
 		_data.allocate(initialCapacity);
@@ -170,9 +181,29 @@ public:
 		return addElement(obj);
 	}
 
+	/**
+	 * @brief Add an element using move semantics
+	 */
+	bool add(Element&& obj)
+	{
+		return emplace(std::move(obj));
+	}
+
 	bool addElement(const Element& obj);
 	bool addElement(Element* objp);
 
+	bool addElement(Element&& obj)
+	{
+		return emplace(std::move(obj));
+	}
+
+	/**
+	 * @brief Construct a new element in-place at the end of the vector
+	 * @param params Arguments passed to element constructor
+	 * @retval bool false on memory allocation failure
+	 */
+	template <typename... ParamTypes> bool emplace(ParamTypes&&... params);
+
 	void clear()
 	{
 		removeAllElements();
@@ -246,7 +277,7 @@ public:
 		return _data[index];
 	}
 
-	Vector<Element>& operator=(const Vector<Element>& rhv)
+	Vector& operator=(const Vector& rhv)
 	{
 		if(this != &rhv) {
 			copyFrom(rhv);
@@ -254,7 +285,7 @@ public:
 		return *this;
 	}
 
-	Vector<Element>& operator=(Vector<Element>&& other) noexcept // move assignment
+	Vector& operator=(Vector&& other) noexcept // move assignment
 	{
 		clear();
 		_increment = 0;
@@ -290,14 +321,12 @@ protected:
 	void copyFrom(const Vector& rhv);
 
 protected:
-	using ElementList = wiring_private::List<Element>;
-
 	unsigned int _size{0};
 	unsigned int _increment{0};
 	ElementList _data;
 };
 
-template <class Element> void Vector<Element>::copyFrom(const Vector<Element>& rhv)
+template <class Element, typename ElementList> void Vector<Element, ElementList>::copyFrom(const Vector& rhv)
 {
 	_data.clear();
 	if(!_data.allocate(rhv._data.size)) {
@@ -313,7 +342,7 @@ template <class Element> void Vector<Element>::copyFrom(const Vector<Element>& r
 	}
 }
 
-template <class Element> void Vector<Element>::copyInto(Element* array) const
+template <class Element, typename ElementList> void Vector<Element, ElementList>::copyInto(Element* array) const
 {
 	if(array == nullptr) {
 		return;
@@ -324,7 +353,9 @@ template <class Element> void Vector<Element>::copyInto(Element* array) const
 	}
 }
 
-template <class Element> template <typename T> int Vector<Element>::indexOf(const T& elem) const
+template <class Element, typename ElementList>
+template <typename T>
+int Vector<Element, ElementList>::indexOf(const T& elem) const
 {
 	for(unsigned int i = 0; i < _size; i++) {
 		if(_data[i] == elem) {
@@ -335,7 +366,9 @@ template <class Element> template <typename T> int Vector<Element>::indexOf(cons
 	return -1;
 }
 
-template <class Element> template <typename T> int Vector<Element>::lastIndexOf(const T& elem) const
+template <class Element, typename ElementList>
+template <typename T>
+int Vector<Element, ElementList>::lastIndexOf(const T& elem) const
 {
 	// check for empty vector
 	if(_size == 0) {
@@ -354,7 +387,7 @@ template <class Element> template <typename T> int Vector<Element>::lastIndexOf(
 	return -1;
 }
 
-template <class Element> bool Vector<Element>::addElement(const Element& obj)
+template <class Element, typename ElementList> bool Vector<Element, ElementList>::addElement(const Element& obj)
 {
 	if(!ensureCapacity(_size + 1)) {
 		return false;
@@ -363,7 +396,7 @@ template <class Element> bool Vector<Element>::addElement(const Element& obj)
 	return true;
 }
 
-template <class Element> bool Vector<Element>::addElement(Element* objp)
+template <class Element, typename ElementList> bool Vector<Element, ElementList>::addElement(Element* objp)
 {
 	if(!ensureCapacity(_size + 1)) {
 		return false;
@@ -372,17 +405,33 @@ template <class Element> bool Vector<Element>::addElement(Element* objp)
 	return true;
 }
 
-template <class Element> bool Vector<Element>::ensureCapacity(size_t minCapacity)
+template <class Element, typename ElementList>
+template <typename... ParamTypes>
+bool Vector<Element, ElementList>::emplace(ParamTypes&&... params)
+{
+	if(!ensureCapacity(_size + 1)) {
+		return false;
+	}
+	if(!_data.emplace(_size, std::forward<ParamTypes>(params)...)) {
+		return false;
+	}
+	++_size;
+	return true;
+}
+
+template <class Element, typename ElementList> bool Vector<Element, ElementList>::ensureCapacity(size_t minCapacity)
 {
 	if(_data.size >= minCapacity) {
 		return true;
 	}
 
-	auto newCapacity = std::max(minCapacity, _data.size + _increment);
+	auto increment = (_increment == 0) ? std::max(_data.size / 2, size_t(4)) : _increment;
+	auto newCapacity = std::max(minCapacity, _data.size + increment);
 	return _data.allocate(newCapacity);
 }
 
-template <class Element> bool Vector<Element>::insertElementAt(const Element& obj, unsigned int index)
+template <class Element, typename ElementList>
+bool Vector<Element, ElementList>::insertElementAt(const Element& obj, unsigned int index)
 {
 	if(index == _size) {
 		return addElement(obj);
@@ -403,7 +452,7 @@ template <class Element> bool Vector<Element>::insertElementAt(const Element& ob
 	return true;
 }
 
-template <class Element> bool Vector<Element>::removeElementAt(unsigned int index)
+template <class Element, typename ElementList> bool Vector<Element, ElementList>::removeElementAt(unsigned int index)
 {
 	// check for valid index
 	if(index >= _size) {
@@ -415,7 +464,8 @@ template <class Element> bool Vector<Element>::removeElementAt(unsigned int inde
 	return true;
 }
 
-template <class Element> bool Vector<Element>::setElementAt(const Element& obj, unsigned int index)
+template <class Element, typename ElementList>
+bool Vector<Element, ElementList>::setElementAt(const Element& obj, unsigned int index)
 {
 	// check for valid index
 	if(index >= _size) {
@@ -425,7 +475,7 @@ template <class Element> bool Vector<Element>::setElementAt(const Element& obj,
 	return true;
 }
 
-template <class Element> bool Vector<Element>::setSize(unsigned int newSize)
+template <class Element, typename ElementList> bool Vector<Element, ElementList>::setSize(unsigned int newSize)
 {
 	if(!ensureCapacity(newSize)) {
 		return false;
@@ -436,18 +486,48 @@ template <class Element> bool Vector<Element>::setSize(unsigned int newSize)
 	return true;
 }
 
-template <class Element> void Vector<Element>::sort(Comparer compareFunction)
+template <class Element, typename ElementList> void Vector<Element, ElementList>::sort(Comparer compareFunction)
 {
-	// Start with 1 (not 0)
+	// Insertion sort: start with 1 (not 0)
 	for(unsigned j = 1; j < _size; j++) {
-		auto key = _data.values[j];
-		Element& keyRef = _data[j];
 		// Smaller values move up
-		int i;
-		for(i = int(j) - 1; (i >= 0) && compareFunction(_data[i], keyRef) > 0; i--) {
-			_data.values[i + 1] = _data.values[i];
+		for(unsigned i = j; i > 0 && compareFunction(_data[i - 1], _data[i]) > 0; i--) {
+			std::swap(_data.values[i - 1], _data.values[i]);
 		}
-		// Put key into its proper location
-		_data.values[i + 1] = key;
 	}
 }
+
+/**
+ * @brief Vector which stores elements contiguously
+ *
+ * Avoids a separate heap allocation for every element. Elements are relocated in memory
+ * as the vector grows, so references to elements are invalidated by insertion or removal.
+ * Element type must be default-constructible and satisfy `wiring_private::is_relocatable`.
+ *
+ * @ingroup wiring
+ */
+template <typename Element> using ContiguousVector = Vector<Element, wiring_private::ValueList<Element>>;
+
+/**
+ * @brief Vector with inline storage for a small number of elements
+ * @tparam Element Type of object stored in vector
+ * @tparam inlineCount Number of elements which may be stored without using the heap
+ *
+ * Elements are stored contiguously, as for `ContiguousVector`.
+ * When the vector grows beyond `inlineCount` elements they are moved to the heap.
+ *
+ * @ingroup wiring
+ */
+template <typename Element, size_t inlineCount>
+class SmallVector : public Vector<Element, wiring_private::SmallList<Element, inlineCount>>
+{
+public:
+	/**
+	 * @brief Constructor
+	 * @param capacityIncrement Number of additional elements allocated when vector is full, 0 for geometric growth
+	 */
+	SmallVector(unsigned int capacityIncrement = 0)
+		: Vector<Element, wiring_private::SmallList<Element, inlineCount>>(inlineCount, capacityIncrement)
+	{
+	}
+};
@@ -4,16 +4,32 @@
  * http://github.com/SmingHub/Sming
  * All files of the Sming Core are provided under the LGPL v3 license.
  *
- * WiringList.h - Private class templates used by HashMap
+ * WiringList.h - Private class templates used by HashMap and Vector
  *
  ****/
 
 #pragma once
 
 #include <algorithm>
+#include <new>
+#include <type_traits>
+
+class String;
 
 namespace wiring_private
 {
+/**
+ * @brief Determine whether objects of a given type may be moved in memory using `memmove`
+ *
+ * Such types contain no pointers to themselves and do not register their address elsewhere.
+ * Specialise for any further types which satisfy this requirement.
+ */
+template <typename T> struct is_relocatable : std::is_trivially_copyable<T> {
+};
+
+template <> struct is_relocatable<String> : std::true_type {
+};
+
 /**
  * @brief List of scalar values
  */
@@ -24,9 +40,18 @@ template <typename T> struct ScalarList {
 	ScalarList() = default;
 
 	ScalarList(const ScalarList&) = delete;
-	ScalarList(ScalarList&&) = default;
+	ScalarList(ScalarList&& other) noexcept : values(other.values), size(other.size)
+	{
+		other.values = nullptr;
+		other.size = 0;
+	}
 	ScalarList& operator=(const ScalarList&) = delete;
-	ScalarList& operator=(ScalarList&&) = default;
+	ScalarList& operator=(ScalarList&& other) noexcept
+	{
+		std::swap(values, other.values);
+		std::swap(size, other.size);
+		return *this;
+	}
 
 	~ScalarList()
 	{
@@ -44,11 +69,17 @@ template <typename T> struct ScalarList {
 
 	bool insert(unsigned index, T value)
 	{
-		memmove(&values[index + 1], &values[index], size - index - 1);
+		memmove(&values[index + 1], &values[index], (size - index - 1) * sizeof(T));
 		values[index] = value;
 		return true;
 	}
 
+	template <typename... ParamTypes> bool emplace(unsigned index, ParamTypes&&... params)
+	{
+		values[index] = T(std::forward<ParamTypes>(params)...);
+		return true;
+	}
+
 	void remove(unsigned index)
 	{
 		memmove(&values[index], &values[index + 1], (size - index - 1) * sizeof(T));
@@ -60,6 +91,11 @@ template <typename T> struct ScalarList {
 			return;
 		}
 
+		if(newSize == 0) {
+			clear();
+			return;
+		}
+
 		auto newmem = realloc(values, sizeof(T) * newSize);
 		if(newmem == nullptr) {
 			return;
@@ -138,6 +174,17 @@ template <typename T> struct ObjectList : public ScalarList<T*> {
 		return ScalarList<T*>::insert(index, el);
 	}
 
+	template <typename... ParamTypes> bool emplace(unsigned index, ParamTypes&&... params)
+	{
+		auto el = new T(std::forward<ParamTypes>(params)...);
+		if(el == nullptr) {
+			return false;
+		}
+		delete this->values[index];
+		this->values[index] = el;
+		return true;
+	}
+
 	void remove(unsigned index)
 	{
 		delete this->values[index];
@@ -166,6 +213,228 @@ template <typename T> struct ObjectList : public ScalarList<T*> {
 	}
 };
 
+/**
+ * @brief List of objects stored contiguously
+ *
+ * All allocated entries hold a valid (possibly default-constructed) object.
+ * Objects are relocated using `realloc` and `memmove` so must satisfy `is_relocatable`.
+ */
+template <typename T> struct ValueList {
+	static_assert(is_relocatable<T>::value, "ValueList requires a relocatable type");
+
+	T* values{nullptr};
+	size_t size{0};
+
+	ValueList() = default;
+
+	ValueList(const ValueList&) = delete;
+	ValueList(ValueList&& other) noexcept : values(other.values), size(other.size)
+	{
+		other.values = nullptr;
+		other.size = 0;
+	}
+	ValueList& operator=(const ValueList&) = delete;
+	ValueList& operator=(ValueList&& other) noexcept
+	{
+		std::swap(values, other.values);
+		std::swap(size, other.size);
+		return *this;
+	}
+
+	~ValueList()
+	{
+		clear();
+	}
+
+	bool allocate(size_t newSize);
+
+	void clear()
+	{
+		for(unsigned i = 0; i < size; ++i) {
+			values[i].~T();
+		}
+		free(values);
+		values = nullptr;
+		size = 0;
+	}
+
+	bool insert(unsigned index, const T& value)
+	{
+		// Take a copy first in case value refers to an existing element
+		T tmp(value);
+		// Last entry is unused: discard it and relocate entries above index
+		values[size - 1].~T();
+		memmove(static_cast<void*>(&values[index + 1]), &values[index], (size - index - 1) * sizeof(T));
+		new(&values[index]) T(std::move(tmp));
+		return true;
+	}
+
+	template <typename... ParamTypes> bool emplace(unsigned index, ParamTypes&&... params)
+	{
+		values[index] = T(std::forward<ParamTypes>(params)...);
+		return true;
+	}
+
+	void remove(unsigned index)
+	{
+		values[index].~T();
+		memmove(static_cast<void*>(&values[index]), &values[index + 1], (size - index - 1) * sizeof(T));
+		new(&values[size - 1]) T{};
+	}
+
+	void trim(size_t newSize, bool reallocate);
+
+	T& operator[](unsigned index)
+	{
+		return values[index];
+	}
+
+	const T& operator[](unsigned index) const
+	{
+		return values[index];
+	}
+};
+
+/**
+ * @brief List of objects with storage for a fixed number of entries held inline
+ * @tparam T Object type
+ * @tparam inlineCount Number of entries stored within the list itself
+ *
+ * Behaves as ValueList, but the heap is only used when capacity exceeds `inlineCount`.
+ * Trimming back to `inlineCount` or fewer entries returns to inline storage.
+ */
+template <typename T, size_t inlineCount> struct SmallList {
+	static_assert(is_relocatable<T>::value, "SmallList requires a relocatable type");
+	static_assert(inlineCount != 0, "SmallList requires inline storage");
+
+	T* values;
+	size_t size{inlineCount};
+
+	SmallList() : values(getInline())
+	{
+		constructInline();
+	}
+
+	SmallList(const SmallList&) = delete;
+	SmallList(SmallList&& other) noexcept : values(getInline())
+	{
+		take(other);
+	}
+	SmallList& operator=(const SmallList&) = delete;
+	SmallList& operator=(SmallList&& other) noexcept
+	{
+		if(this != &other) {
+			release();
+			take(other);
+		}
+		return *this;
+	}
+
+	~SmallList()
+	{
+		release();
+	}
+
+	/**
+	 * @brief Determine if entries are currently stored inline, rather than on the heap
+	 */
+	bool isInline() const
+	{
+		return values == getInline();
+	}
+
+	bool allocate(size_t newSize);
+
+	void clear()
+	{
+		release();
+		values = getInline();
+		size = inlineCount;
+		constructInline();
+	}
+
+	bool insert(unsigned index, const T& value)
+	{
+		T tmp(value);
+		values[size - 1].~T();
+		memmove(static_cast<void*>(&values[index + 1]), &values[index], (size - index - 1) * sizeof(T));
+		new(&values[index]) T(std::move(tmp));
+		return true;
+	}
+
+	template <typename... ParamTypes> bool emplace(unsigned index, ParamTypes&&... params)
+	{
+		values[index] = T(std::forward<ParamTypes>(params)...);
+		return true;
+	}
+
+	void remove(unsigned index)
+	{
+		values[index].~T();
+		memmove(static_cast<void*>(&values[index]), &values[index + 1], (size - index - 1) * sizeof(T));
+		new(&values[size - 1]) T{};
+	}
+
+	void trim(size_t newSize, bool reallocate);
+
+	T& operator[](unsigned index)
+	{
+		return values[index];
+	}
+
+	const T& operator[](unsigned index) const
+	{
+		return values[index];
+	}
+
+private:
+	T* getInline()
+	{
+		return reinterpret_cast<T*>(buffer);
+	}
+
+	const T* getInline() const
+	{
+		return reinterpret_cast<const T*>(buffer);
+	}
+
+	void constructInline()
+	{
+		for(unsigned i = 0; i < inlineCount; ++i) {
+			new(&getInline()[i]) T{};
+		}
+	}
+
+	// Destroy all entries and free any heap storage
+	void release()
+	{
+		for(unsigned i = 0; i < size; ++i) {
+			values[i].~T();
+		}
+		if(!isInline()) {
+			free(values);
+		}
+	}
+
+	// Take content from another list, leaving it empty
+	void take(SmallList& other)
+	{
+		if(other.isInline()) {
+			memcpy(static_cast<void*>(buffer), other.buffer, sizeof(buffer));
+			values = getInline();
+			size = inlineCount;
+		} else {
+			values = other.values;
+			size = other.size;
+		}
+		other.values = other.getInline();
+		other.size = inlineCount;
+		other.constructInline();
+	}
+
+	alignas(T) uint8_t buffer[inlineCount * sizeof(T)];
+};
+
 template <typename T> bool ScalarList<T>::allocate(size_t newSize)
 {
 	if(newSize <= size) {
@@ -193,6 +462,123 @@ template <typename T> bool ObjectList<T>::allocate(size_t newSize)
 	return true;
 }
 
+template <typename T> bool ValueList<T>::allocate(size_t newSize)
+{
+	if(newSize <= size) {
+		return true;
+	}
+
+	auto newmem = realloc(static_cast<void*>(values), sizeof(T) * newSize);
+	if(newmem == nullptr) {
+		return false;
+	}
+
+	values = static_cast<T*>(newmem);
+	for(unsigned i = size; i < newSize; ++i) {
+		new(&values[i]) T{};
+	}
+	size = newSize;
+	return true;
+}
+
+template <typename T> void ValueList<T>::trim(size_t newSize, bool reallocate)
+{
+	if(!reallocate) {
+		for(unsigned i = newSize; i < size; ++i) {
+			values[i] = T{};
+		}
+		return;
+	}
+
+	if(newSize == 0) {
+		clear();
+		return;
+	}
+
+	for(unsigned i = newSize; i < size; ++i) {
+		values[i].~T();
+	}
+
+	auto newmem = realloc(static_cast<void*>(values), sizeof(T) * newSize);
+	if(newmem == nullptr) {
+		// Existing block retained so restore discarded entries
+		for(unsigned i = newSize; i < size; ++i) {
+			new(&values[i]) T{};
+		}
+		return;
+	}
+
+	values = static_cast<T*>(newmem);
+	size = newSize;
+}
+
+template <typename T, size_t inlineCount> bool SmallList<T, inlineCount>::allocate(size_t newSize)
+{
+	if(newSize <= size) {
+		return true;
+	}
+
+	void* newmem;
+	if(isInline()) {
+		newmem = malloc(sizeof(T) * newSize);
+		if(newmem == nullptr) {
+			return false;
+		}
+		memcpy(newmem, static_cast<void*>(values), sizeof(T) * size);
+	} else {
+		newmem = realloc(static_cast<void*>(values), sizeof(T) * newSize);
+		if(newmem == nullptr) {
+			return false;
+		}
+	}
+
+	values = static_cast<T*>(newmem);
+	for(unsigned i = size; i < newSize; ++i) {
+		new(&values[i]) T{};
+	}
+	size = newSize;
+	return true;
+}
+
+template <typename T, size_t inlineCount> void SmallList<T, inlineCount>::trim(size_t newSize, bool reallocate)
+{
+	if(!reallocate || isInline()) {
+		for(unsigned i = newSize; i < size; ++i) {
+			values[i] = T{};
+		}
+		return;
+	}
+
+	for(unsigned i = newSize; i < size; ++i) {
+		values[i].~T();
+	}
+
+	if(newSize <= inlineCount) {
+		// Move back to inline storage
+		auto heapValues = values;
+		values = getInline();
+		memcpy(static_cast<void*>(values), heapValues, sizeof(T) * newSize);
+		free(heapValues);
+		for(unsigned i = newSize; i < inlineCount; ++i) {
+			new(&values[i]) T{};
+		}
+		size = inlineCount;
+		return;
+	}
+
+	auto newmem = realloc(static_cast<void*>(values), sizeof(T) * newSize);
+	if(newmem == nullptr) {
+		// Existing block retained so restore discarded entries
+		for(unsigned i = newSize; i < size; ++i) {
+			new(&values[i]) T{};
+		}
+		return;
+	}
+
+	values = static_cast<T*>(newmem);
+	size = newSize;
+}
+
 template <typename T>
 using List = typename std::conditional<std::is_scalar<T>::value, ScalarList<T>, ObjectList<T>>::type;
 
@@ -3,7 +3,8 @@ COMPONENT_SRCDIRS := \
 	Platform \
 	System \
 	Wiring \
-	Services/HexDump
+	Services/HexDump \
+	Services/RingLog
 
 COMPONENT_INCDIRS := \
 	Components \
@@ -91,13 +92,25 @@ APP_CFLAGS			+= \
 	-DCOM_SPEED_SERIAL=$(COM_SPEED_SERIAL) \
 	-DSERIAL_BAUD_RATE=$(COM_SPEED_SERIAL)
 
-# Task queue counter to check for overflows
+# Task queue latency measurement
 COMPONENT_VARS		+= ENABLE_TASK_COUNT
 ifeq ($(ENABLE_TASK_COUNT),1)
 	GLOBAL_CFLAGS	+= -DENABLE_TASK_COUNT=1
 endif
 
-# Task queue length
+# Use fixed-size storage for Delegate instead of std::function
+COMPONENT_VARS		+= ENABLE_INPLACE_DELEGATE
+ifeq ($(ENABLE_INPLACE_DELEGATE),1)
+	GLOBAL_CFLAGS	+= -DENABLE_INPLACE_DELEGATE=1
+endif
+
+# Capture buffer size for InplaceDelegate, in bytes
+COMPONENT_VARS		+= INPLACE_DELEGATE_SIZE
+ifdef INPLACE_DELEGATE_SIZE
+	GLOBAL_CFLAGS	+= -DINPLACE_DELEGATE_SIZE=$(INPLACE_DELEGATE_SIZE)
+endif
+
+# Task queue length (per priority lane)
 COMPONENT_VARS		+= TASK_QUEUE_LENGTH
 TASK_QUEUE_LENGTH	?= 10
 COMPONENT_CXXFLAGS	+= -DTASK_QUEUE_LENGTH=$(TASK_QUEUE_LENGTH)
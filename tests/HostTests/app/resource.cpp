@@ -14,4 +14,10 @@ RESOURCE(ut_template1_out1_rst, "ut_template1.out1.rst")
 RESOURCE(image_png, "image.png")
 RESOURCE(multipart_result, "multipart-result.txt")
 
+RESOURCE(abstract_txt_gz, "abstract.txt.gz")
+RESOURCE(abstract_txt_zlib, "abstract.txt.zlib")
+RESOURCE(abstract_txt_deflate, "abstract.txt.deflate")
+RESOURCE(ut_template1_out1_rst_gz, "ut_template1.out1.rst.gz")
+RESOURCE(image_png_gz, "image.png.gz")
+
 } // namespace Resource
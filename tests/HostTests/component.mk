@@ -26,6 +26,13 @@ endif
 COMPONENT_DEPENDS := \
 	malloc_count
 
+# Track heap allocation sites so they can be checked, and so leaks are reported at exit
+ifeq ($(SMING_ARCH),Host)
+MALLOC_COUNT_SITES ?= 64
+endif
+MALLOC_COUNT_SITES ?= 0
+APP_CFLAGS += -DMALLOC_COUNT_SITES=$(MALLOC_COUNT_SITES)
+
 ifneq ($(DISABLE_NETWORK),1)
 COMPONENT_SRCDIRS += \
 	modules/Network \
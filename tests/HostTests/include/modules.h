@@ -11,7 +11,13 @@
 #define ARCH_TEST_MAP(XX)                                                                                              \
 	XX_NET(Hosted)                                                                                                     \
 	XX_NET(HttpRequest)                                                                                                \
-	XX_NET(TcpClient)
+	XX_NET(HttpPipeline)                                                                                               \
+	XX_NET(HttpRange)                                                                                                  \
+	XX_NET(HttpClientPool)                                                                                             \
+	XX_NET(TcpClient)                                                                                                  \
+	XX_NET(Udp)                                                                                                        \
+	XX_NET(DnsCache)                                                                                                   \
+	XX_NET(EventSource)
 #else
 #define ARCH_TEST_MAP(XX)
 #endif
@@ -25,9 +31,14 @@
 	XX(Range)                                                                                                          \
 	XX(String)                                                                                                         \
 	XX(ArduinoString)                                                                                                  \
+	XX(StringSearch)                                                                                                   \
 	XX(Wiring)                                                                                                         \
+	XX(Delegate)                                                                                                       \
+	XX(MemoryPool)                                                                                                     \
+	XX(MallocCount)                                                                                                    \
 	XX_NET(Crypto)                                                                                                     \
 	XX(CStringArray)                                                                                                   \
+	XX(PerfectHash)                                                                                                    \
 	XX(Stream)                                                                                                         \
 	XX(TemplateStream)                                                                                                 \
 	XX(Formatter)                                                                                                      \
@@ -38,12 +49,15 @@
 	XX(Uuid)                                                                                                           \
 	XX_NET(Http)                                                                                                       \
 	XX_NET(Url)                                                                                                        \
+	XX_NET(Websocket)                                                                                                  \
 	XX(ArduinoJson5)                                                                                                   \
 	XX(ArduinoJson6)                                                                                                   \
 	XX(Storage)                                                                                                        \
 	XX(Files)                                                                                                          \
 	XX(Spiffs)                                                                                                         \
+	XX(RingLog)                                                                                                        \
 	XX(Rational)                                                                                                       \
 	XX(Clocks)                                                                                                         \
 	XX(Timers)                                                                                                         \
+	XX(Coroutine)                                                                                                      \
 	ARCH_TEST_MAP(XX)
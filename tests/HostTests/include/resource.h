@@ -17,4 +17,13 @@ DECLARE_FSTR(ut_template1_out1_rst) // emit_contents = true
 DECLARE_FSTR(image_png)
 DECLARE_FSTR(multipart_result)
 
+// Compressed content, generated from abstract.txt
+DECLARE_FSTR(abstract_txt_gz)
+DECLARE_FSTR(abstract_txt_zlib)
+DECLARE_FSTR(abstract_txt_deflate)
+
+// Larger compressed content. image.png does not compress so is sent as stored blocks.
+DECLARE_FSTR(ut_template1_out1_rst_gz)
+DECLARE_FSTR(image_png_gz)
+
 } // namespace Resource
@@ -0,0 +1,101 @@
+#include <HostTests.h>
+#include <Coroutine.h>
+
+namespace
+{
+class TestRoutine : public Coroutine
+{
+public:
+	TestRoutine(TaskDelegate finished) : finished(finished)
+	{
+	}
+
+	String steps;
+	Co::Event event;
+	uint32_t sleepTime{0};
+	uint32_t timerTime{0};
+
+protected:
+	void run() override
+	{
+		CO_BEGIN();
+
+		steps += 'a';
+		CO_YIELD();
+		steps += 'b';
+
+		timer.start();
+		CO_SLEEP(100);
+		sleepTime = timer.elapsedTime();
+		steps += 'c';
+
+		// Signalled by test group
+		CO_AWAIT(event);
+		steps += 'd';
+
+		timer.start();
+		coTimer.start(50);
+		CO_AWAIT(coTimer);
+		timerTime = timer.elapsedTime();
+		steps += 'e';
+
+		for(count = 0; count < 3; ++count) {
+			CO_YIELD();
+			steps += 'y';
+		}
+
+		CO_END();
+	}
+
+	void onFinished() override
+	{
+		// Test group may be destroyed on completion, so defer
+		System.queueCallback(finished);
+	}
+
+private:
+	TaskDelegate finished;
+	Co::Timer coTimer;
+	OneShotFastMs timer;
+	unsigned count{0};
+};
+
+} // namespace
+
+class CoroutineTest : public TestGroup
+{
+public:
+	CoroutineTest() : TestGroup(_F("Coroutine"))
+	{
+	}
+
+	void execute() override
+	{
+		TEST_CASE("Coroutine class")
+		{
+			routine.resume();
+			// Routine waits for this event after sleeping
+			eventTimer.initializeMs<200>([this]() { routine.event.signal(); }).startOnce();
+			pending();
+		}
+	}
+
+	void routineFinished()
+	{
+		debug_i("sleep %u ms, timer %u ms", routine.sleepTime, routine.timerTime);
+		REQUIRE_EQ(routine.steps, "abcdeyyy");
+		REQUIRE(routine.isFinished());
+		REQUIRE(routine.sleepTime >= 100);
+		REQUIRE(routine.timerTime >= 50);
+		complete();
+	}
+
+private:
+	TestRoutine routine{TaskDelegate(&CoroutineTest::routineFinished, this)};
+	Timer eventTimer;
+};
+
+void REGISTER_TEST(Coroutine)
+{
+	registerGroup<CoroutineTest>();
+}
@@ -0,0 +1,124 @@
+#include <HostTests.h>
+#include <InplaceDelegate.h>
+#include <malloc_count.h>
+
+namespace
+{
+unsigned liveObjects;
+
+struct Tracker {
+	Tracker(int value) : value(value)
+	{
+		++liveObjects;
+	}
+
+	Tracker(const Tracker& other) : value(other.value)
+	{
+		++liveObjects;
+	}
+
+	~Tracker()
+	{
+		--liveObjects;
+	}
+
+	int value;
+};
+
+struct Adder {
+	int add(int x)
+	{
+		return x + offset;
+	}
+
+	int offset;
+};
+
+int twice(int x)
+{
+	return x * 2;
+}
+
+} // namespace
+
+class DelegateTest : public TestGroup
+{
+public:
+	DelegateTest() : TestGroup(_F("Delegate"))
+	{
+	}
+
+	void execute() override
+	{
+		using IntDelegate = InplaceDelegate<int(int)>;
+
+		TEST_CASE("InplaceDelegate")
+		{
+			IntDelegate empty;
+			REQUIRE(!empty);
+			REQUIRE(empty == nullptr);
+
+			IntDelegate func(twice);
+			REQUIRE_EQ(func(3), 6);
+
+			Adder adder{5};
+			IntDelegate method(&Adder::add, &adder);
+			REQUIRE_EQ(method(1), 6);
+
+			liveObjects = 0;
+			{
+				Tracker tracker(10);
+				IntDelegate lambda([tracker](int x) { return x + tracker.value; });
+				REQUIRE_EQ(liveObjects, 2U);
+				IntDelegate copy(lambda);
+				REQUIRE_EQ(liveObjects, 3U);
+				IntDelegate moved(std::move(copy));
+				REQUIRE_EQ(liveObjects, 3U);
+				REQUIRE(!copy);
+				REQUIRE_EQ(moved(2), 12);
+				lambda = nullptr;
+				REQUIRE_EQ(liveObjects, 2U);
+			}
+			REQUIRE_EQ(liveObjects, 0U);
+		}
+
+		TEST_CASE("Allocations")
+		{
+			// Larger than std::function small-object buffer on all architectures
+			uint32_t a{1}, b{2}, c{3}, d{4}, e{5}, f{6};
+			auto lambda = [a, b, c, d, e, f](int x) -> int { return x + a + b + c + d + e + f; };
+
+			auto stdCount = countAllocations<std::function<int(int)>>(lambda);
+			auto delegateCount = countAllocations<Delegate<int(int)>>(lambda);
+			auto inplaceCount = countAllocations<InplaceDelegate<int(int), 32>>(lambda);
+
+			Serial << _F("Allocations for ") << iterations << _F(" delegates: std::function ") << stdCount
+				   << _F(", Delegate ") << delegateCount << _F(", InplaceDelegate ") << inplaceCount << endl;
+			REQUIRE_EQ(inplaceCount, 0U);
+		}
+	}
+
+	/*
+	 * Construct, copy and invoke a delegate a number of times
+	 */
+	template <typename DelegateType, typename Func> size_t countAllocations(Func func)
+	{
+		auto startCount = MallocCount::getAllocCount();
+		int result{0};
+		for(unsigned i = 0; i < iterations; ++i) {
+			DelegateType delegate(func);
+			auto copy = delegate;
+			result += copy(i);
+		}
+		REQUIRE(result != 0);
+		return MallocCount::getAllocCount() - startCount;
+	}
+
+private:
+	static constexpr unsigned iterations{100};
+};
+
+void REGISTER_TEST(Delegate)
+{
+	registerGroup<DelegateTest>();
+}
@@ -0,0 +1,155 @@
+#include <HostTests.h>
+#include <malloc_count.h>
+
+using namespace MallocCount;
+
+class MallocCountTest : public TestGroup
+{
+public:
+	MallocCountTest() : TestGroup(_F("MallocCount"))
+	{
+	}
+
+	void execute() override
+	{
+		auto allocCount = getAllocCount();
+		allocate();
+		release();
+		if(getAllocCount() == allocCount) {
+			Serial.println(_F("malloc_count not enabled, skipping tests"));
+			return;
+		}
+
+		TEST_CASE("Block count")
+		{
+			auto blockCount = getBlockCount();
+			auto current = getCurrent();
+			allocate();
+			REQUIRE_EQ(getBlockCount(), blockCount + numBlocks);
+			REQUIRE_EQ(getCurrent(), current + allocSize);
+			release();
+			REQUIRE_EQ(getBlockCount(), blockCount);
+			REQUIRE_EQ(getCurrent(), current);
+		}
+
+		TEST_CASE("Heap snapshot")
+		{
+			HeapSnapshot before;
+			getHeapSnapshot(before);
+			printHeapSnapshot(before);
+			REQUIRE(before.freeBlocks != 0);
+			REQUIRE(before.largestBlock != 0);
+			REQUIRE(before.largestBlock <= before.freeBytes);
+			REQUIRE(before.freeBytes <= system_get_free_heap_size());
+			REQUIRE(before.getFragmentation() < 100);
+			unsigned histogramBlocks{0};
+			for(auto n : before.histogram) {
+				histogramBlocks += n;
+			}
+			REQUIRE_EQ(histogramBlocks, before.freeBlocks);
+			REQUIRE_EQ(getLargestFreeBlock(), before.largestBlock);
+
+			allocate();
+			HeapSnapshot after;
+			getHeapSnapshot(after);
+			printHeapSnapshot(after);
+			REQUIRE(after.freeBytes + allocSize <= before.freeBytes);
+#ifdef ARCH_HOST
+			// Heap is notional, a single block reduced by the amount allocated
+			REQUIRE_EQ(before.freeBlocks, 1U);
+			REQUIRE_EQ(after.freeBlocks, 1U);
+			REQUIRE_EQ(before.getFragmentation(), 0U);
+			REQUIRE_EQ(after.largestBlock, before.largestBlock - allocSize);
+			REQUIRE_EQ(getLargestFreeBlock(), after.largestBlock);
+#endif
+
+			release();
+			HeapSnapshot restored;
+			getHeapSnapshot(restored);
+			REQUIRE(restored.freeBytes > after.freeBytes);
+#ifdef ARCH_HOST
+			REQUIRE_EQ(restored.freeBytes, before.freeBytes);
+			REQUIRE_EQ(restored.largestBlock, before.largestBlock);
+#endif
+		}
+
+		TEST_CASE("Allocation sites")
+		{
+#if MALLOC_COUNT_SITES
+			SiteInfo sites[MALLOC_COUNT_SITES + 1];
+
+			// Our blocks come from a single call site, which should rank highly
+			allocate();
+			auto count = getSites(sites, 8);
+			REQUIRE(count != 0);
+			const SiteInfo* site = findSite(sites, count, nullptr);
+			REQUIRE(site != nullptr);
+			auto caller = site->caller;
+			REQUIRE(caller != nullptr);
+			REQUIRE(site->total >= numBlocks);
+			printSites(5);
+
+			// Site remains in the table after its blocks are freed
+			release();
+			count = getSites(sites, ARRAY_SIZE(sites));
+			site = findSite(sites, count, caller);
+			REQUIRE(site != nullptr);
+			REQUIRE_EQ(site->count, 0U);
+			REQUIRE_EQ(site->bytes, 0U);
+			REQUIRE(site->total >= numBlocks);
+
+			// Sorted by decreasing current allocation
+			for(unsigned i = 1; i < count; ++i) {
+				REQUIRE(sites[i - 1].bytes >= sites[i].bytes);
+			}
+#else
+			SiteInfo sites[4];
+			allocate();
+			REQUIRE_EQ(getSites(sites, ARRAY_SIZE(sites)), 0U);
+			release();
+#endif
+		}
+	}
+
+private:
+	static constexpr size_t blockSize{1000};
+	static constexpr size_t numBlocks{8};
+	static constexpr size_t allocSize{blockSize * numBlocks};
+
+	void allocate()
+	{
+		for(auto& block : blocks) {
+			block = malloc(blockSize);
+			REQUIRE(block != nullptr);
+		}
+	}
+
+	void release()
+	{
+		for(auto& block : blocks) {
+			free(block);
+			block = nullptr;
+		}
+	}
+
+	/*
+	 * Locate an entry by caller address, or if null the one holding exactly our blocks
+	 */
+	const SiteInfo* findSite(const SiteInfo* sites, size_t count, const void* caller)
+	{
+		for(unsigned i = 0; i < count; ++i) {
+			auto& site = sites[i];
+			if(caller == nullptr ? (site.count == numBlocks && site.bytes == allocSize) : (site.caller == caller)) {
+				return &site;
+			}
+		}
+		return nullptr;
+	}
+
+	void* blocks[numBlocks]{};
+};
+
+void REGISTER_TEST(MallocCount)
+{
+	registerGroup<MallocCountTest>();
+}
@@ -0,0 +1,183 @@
+#include <HostTests.h>
+#include <MemoryPool.h>
+#include <malloc_count.h>
+
+#ifndef MEMORY_POOL_BENCHMARK_ITERATIONS
+#ifdef ARCH_HOST
+#define MEMORY_POOL_BENCHMARK_ITERATIONS 100000
+#else
+#define MEMORY_POOL_BENCHMARK_ITERATIONS 10000
+#endif
+#endif
+
+using namespace MemoryPool;
+
+namespace
+{
+struct Message : public Pooled<Message, 4> {
+	uint32_t id;
+	char text[20];
+};
+
+/*
+ * Simple generator so heap and pool runs see identical sequences
+ */
+class Random
+{
+public:
+	uint32_t next()
+	{
+		seed = seed * 1103515245 + 12345;
+		return seed >> 8;
+	}
+
+private:
+	uint32_t seed{1};
+};
+
+constexpr size_t slotCount{64};
+constexpr size_t sizeClasses[]{24, 56, 120};
+
+} // namespace
+
+class MemoryPoolTest : public TestGroup
+{
+public:
+	MemoryPoolTest() : TestGroup(_F("MemoryPool"))
+	{
+	}
+
+	void execute() override
+	{
+		TEST_CASE("Pool")
+		{
+			StaticPool<13, 3> pool("test");
+			REQUIRE(pool.getBlockSize() == 16U);
+			REQUIRE(pool.getFreeCount() == 3U);
+
+			void* blocks[3];
+			for(auto& block : blocks) {
+				block = pool.allocate();
+				REQUIRE(block != nullptr);
+				REQUIRE(pool.contains(block));
+			}
+			REQUIRE(pool.allocate() == nullptr);
+
+			auto& stats = pool.getStats();
+			REQUIRE(stats.used == 3);
+			REQUIRE(stats.highWater == 3);
+			REQUIRE(stats.allocCount == 3U);
+			REQUIRE(stats.failCount == 1U);
+
+			pool.release(blocks[1]);
+			REQUIRE(pool.allocate() == blocks[1]);
+			for(auto block : blocks) {
+				pool.release(block);
+			}
+			REQUIRE(stats.used == 0);
+			pool.resetStats();
+			REQUIRE(stats.highWater == 0);
+			REQUIRE(stats.failCount == 0U);
+
+			printStats(Serial);
+		}
+
+		TEST_CASE("Pooled objects")
+		{
+			auto& pool = Message::getPool();
+			Message* messages[6];
+			auto allocCount = MallocCount::getAllocCount();
+			for(unsigned i = 0; i < 4; ++i) {
+				messages[i] = new Message;
+				REQUIRE(pool.contains(messages[i]));
+			}
+			REQUIRE_EQ(MallocCount::getAllocCount(), allocCount);
+
+			// Pool exhausted, so use heap
+			for(unsigned i = 4; i < 6; ++i) {
+				messages[i] = new Message;
+				REQUIRE(!pool.contains(messages[i]));
+			}
+			REQUIRE(pool.getStats().failCount == 2U);
+
+			for(auto msg : messages) {
+				delete msg;
+			}
+			REQUIRE(pool.getStats().used == 0);
+		}
+
+		TEST_CASE("Fragmentation benchmark")
+		{
+			Serial << MEMORY_POOL_BENCHMARK_ITERATIONS << " iterations, " << slotCount << " slots" << endl;
+			auto heapAllocs = churn(
+				_F("heap"), [](size_t size) { return malloc(size); }, [](void* ptr) { free(ptr); });
+
+			// Storage is too large for the stack on hardware
+			static StaticPool<sizeClasses[0], slotCount> pool0("small");
+			static StaticPool<sizeClasses[1], slotCount> pool1("medium");
+			static StaticPool<sizeClasses[2], slotCount> pool2("large");
+			Pool* pools[]{&pool0, &pool1, &pool2};
+			SizeClassAllocator allocator(pools, ARRAY_SIZE(pools));
+			auto poolAllocs = churn(
+				_F("pool"), [&](size_t size) { return allocator.allocate(size); },
+				[&](void* ptr) { allocator.release(ptr); });
+
+			printStats(Serial);
+			// Heap allocations are only counted if malloc_count is enabled
+			if(MallocCount::getAllocCount() != 0) {
+				REQUIRE(heapAllocs != 0);
+			}
+			REQUIRE(poolAllocs == 0U);
+			REQUIRE(allocator.getHeapCount() == 0U);
+			REQUIRE(getUsed() == 0U);
+		}
+	}
+
+private:
+	/*
+	 * Simulate long-running allocation pattern: short-lived blocks of varying size,
+	 * interleaved with some which persist for much longer.
+	 * Returns number of heap allocations made.
+	 */
+	template <typename Alloc, typename Free> size_t churn(const String& name, Alloc alloc, Free release)
+	{
+		void* slots[slotCount]{};
+		Random random;
+		auto allocCount = MallocCount::getAllocCount();
+		auto startMem = MallocCount::getCurrent();
+		MallocCount::resetPeak();
+
+		OneShotFastMs timer;
+		for(unsigned i = 0; i < MEMORY_POOL_BENCHMARK_ITERATIONS; ++i) {
+			auto n = random.next();
+			// Low slots are long-lived: only recycle them occasionally
+			auto slot = n % slotCount;
+			if(slot < slotCount / 4 && (n & 0xf000) != 0) {
+				slot += slotCount / 4;
+			}
+			if(slots[slot] != nullptr) {
+				release(slots[slot]);
+				slots[slot] = nullptr;
+			} else {
+				auto size = sizeClasses[(n >> 16) % ARRAY_SIZE(sizeClasses)] - (n >> 20) % 8;
+				slots[slot] = alloc(size);
+				memset(slots[slot], 0xaa, size);
+			}
+		}
+		for(auto& ptr : slots) {
+			release(ptr);
+			ptr = nullptr;
+		}
+		auto elapsed = timer.elapsedTime();
+
+		allocCount = MallocCount::getAllocCount() - allocCount;
+		Serial << name << ": " << elapsed << " ms, " << allocCount << " heap allocations, peak heap "
+			   << MallocCount::getPeak() - startMem << endl;
+		return allocCount;
+	}
+};
+
+void REGISTER_TEST(MemoryPool)
+{
+	registerGroup<MemoryPoolTest>();
+}
@@ -0,0 +1,199 @@
+#include <HostTests.h>
+
+#include <Network/DnsCache.h>
+#include <esp_systemapi.h>
+
+namespace
+{
+/*
+ * Lookups are answered by the test, by calling resolved()
+ */
+class TestDnsCache : public DnsCache
+{
+public:
+	using DnsCache::resolved;
+
+	err_t resolve(const String& name, IpAddress&) override
+	{
+		lastQuery = name;
+		++queryCount;
+		return ERR_INPROGRESS;
+	}
+
+	String lastQuery;
+	unsigned queryCount{0};
+};
+
+void advance(uint64_t seconds)
+{
+	host_time_advance(seconds * 1000000000ULL);
+}
+
+} // namespace
+
+class DnsCacheTest : public TestGroup
+{
+public:
+	DnsCacheTest() : TestGroup(_F("DnsCache"))
+	{
+	}
+
+	void execute() override
+	{
+		bool wasVirtual = host_time_is_virtual();
+		host_time_set_virtual(true, 0);
+
+		TestDnsCache cache;
+		DnsCache::Settings settings;
+		settings.ttl = 300;
+		settings.negativeTtl = 10;
+		settings.staleTtl = 300;
+		settings.prefetch = 30;
+		cache.setSettings(settings);
+		auto& stats = cache.getStats();
+
+		const IpAddress addr1(10, 0, 0, 1);
+		const IpAddress addr2(10, 0, 0, 2);
+		IpAddress addr;
+		IpAddress result;
+		unsigned callbackCount{0};
+		auto callback = [&](const String&, IpAddress address) {
+			++callbackCount;
+			result = address;
+		};
+
+		TEST_CASE("Miss")
+		{
+			REQUIRE(cache.lookup("host1", addr, callback) == ERR_INPROGRESS);
+			REQUIRE_EQ(cache.queryCount, 1U);
+			REQUIRE(cache.lastQuery == "host1");
+			REQUIRE_EQ(stats.misses, 1U);
+			cache.resolved("host1", addr1);
+			REQUIRE_EQ(callbackCount, 1U);
+			REQUIRE(result == addr1);
+		}
+
+		TEST_CASE("Hit")
+		{
+			advance(100);
+			REQUIRE(cache.lookup("host1", addr, callback) == ERR_OK);
+			REQUIRE(addr == addr1);
+			REQUIRE_EQ(stats.hits, 1U);
+			REQUIRE_EQ(cache.queryCount, 1U);
+		}
+
+		TEST_CASE("Prefetch")
+		{
+			// Within prefetch window
+			advance(175);
+			REQUIRE(cache.lookup("host1", addr, callback) == ERR_OK);
+			REQUIRE(addr == addr1);
+			REQUIRE_EQ(stats.hits, 2U);
+			REQUIRE_EQ(stats.prefetches, 1U);
+			REQUIRE_EQ(cache.queryCount, 2U);
+
+			// Only one background lookup at a time
+			REQUIRE(cache.lookup("host1", addr, callback) == ERR_OK);
+			REQUIRE_EQ(stats.prefetches, 1U);
+			REQUIRE_EQ(cache.queryCount, 2U);
+
+			// New address is valid for a full TTL
+			cache.resolved("host1", addr2);
+			REQUIRE_EQ(callbackCount, 1U);
+			advance(200);
+			REQUIRE(cache.lookup("host1", addr, callback) == ERR_OK);
+			REQUIRE(addr == addr2);
+			REQUIRE_EQ(stats.hits, 4U);
+			REQUIRE_EQ(stats.prefetches, 1U);
+			REQUIRE_EQ(stats.staleHits, 0U);
+		}
+
+		TEST_CASE("Serve stale")
+		{
+			advance(101);
+			REQUIRE(cache.lookup("host1", addr, callback) == ERR_OK);
+			REQUIRE(addr == addr2);
+			REQUIRE_EQ(stats.staleHits, 1U);
+			REQUIRE_EQ(stats.revalidations, 1U);
+			REQUIRE_EQ(stats.prefetches, 1U);
+			REQUIRE_EQ(cache.queryCount, 3U);
+
+			// Failed revalidation keeps the stale address
+			cache.resolved("host1", IpAddress());
+			REQUIRE_EQ(stats.failures, 1U);
+			REQUIRE(cache.lookup("host1", addr, callback) == ERR_OK);
+			REQUIRE(addr == addr2);
+			REQUIRE_EQ(stats.staleHits, 2U);
+			REQUIRE_EQ(stats.revalidations, 2U);
+			REQUIRE_EQ(cache.queryCount, 4U);
+		}
+
+		TEST_CASE("Expiry")
+		{
+			advance(300);
+			REQUIRE(cache.lookup("host1", addr, callback) == ERR_INPROGRESS);
+			REQUIRE_EQ(stats.misses, 2U);
+			REQUIRE_EQ(cache.queryCount, 5U);
+			cache.resolved("host1", IpAddress());
+			REQUIRE_EQ(callbackCount, 2U);
+			REQUIRE(result.isNull());
+			REQUIRE_EQ(stats.failures, 2U);
+		}
+
+		TEST_CASE("Negative caching")
+		{
+			REQUIRE(cache.lookup("host1", addr, callback) == ERR_VAL);
+			REQUIRE_EQ(stats.negativeHits, 1U);
+			advance(9);
+			REQUIRE(cache.lookup("host1", addr, callback) == ERR_VAL);
+			REQUIRE_EQ(stats.negativeHits, 2U);
+			REQUIRE_EQ(cache.queryCount, 5U);
+
+			advance(1);
+			REQUIRE(cache.lookup("host1", addr, callback) == ERR_INPROGRESS);
+			REQUIRE_EQ(stats.misses, 3U);
+			cache.resolved("host1", addr1);
+			REQUIRE_EQ(callbackCount, 3U);
+			REQUIRE(result == addr1);
+			REQUIRE(cache.lookup("host1", addr, callback) == ERR_OK);
+		}
+
+		TEST_CASE("Long uptime")
+		{
+			/*
+			 * Ages are measured using the RTC, so remain correct after millis() wraps at 2^32 ms.
+			 * Moving the RTC alone avoids running every timer in the system through the same interval.
+			 */
+			constexpr uint32_t jump{4294967 + 100};
+			RTC.setRtcSeconds(RTC.getRtcSeconds() + jump);
+			REQUIRE(cache.lookup("host1", addr, callback) == ERR_INPROGRESS);
+			REQUIRE_EQ(stats.misses, 4U);
+			RTC.setRtcSeconds(RTC.getRtcSeconds() - jump);
+		}
+
+		TEST_CASE("Waiting callbacks")
+		{
+			// All callbacks waiting on a name are called, and only once
+			callbackCount = 0;
+			REQUIRE(cache.lookup("host2", addr, callback) == ERR_INPROGRESS);
+			REQUIRE(cache.lookup("host2", addr, callback) == ERR_INPROGRESS);
+			cache.resolved("host1", addr2);
+			REQUIRE_EQ(callbackCount, 1U);
+			cache.resolved("host2", addr1);
+			REQUIRE_EQ(callbackCount, 3U);
+			cache.resolved("host2", addr1);
+			REQUIRE_EQ(callbackCount, 3U);
+		}
+
+		cache.printStats(Serial);
+
+		if(!wasVirtual) {
+			host_time_set_virtual(false, 0);
+		}
+	}
+};
+
+void REGISTER_TEST(DnsCache)
+{
+	registerGroup<DnsCacheTest>();
+}
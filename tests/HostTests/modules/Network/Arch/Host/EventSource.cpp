@@ -0,0 +1,344 @@
+#include <HostTests.h>
+
+#include <Network/HttpServer.h>
+#include <Network/HttpClient.h>
+#include <Network/Http/EventSourceResource.h>
+#include <Platform/Station.h>
+
+namespace
+{
+constexpr uint16_t serverPort{8081};
+constexpr unsigned subscriberCount{2};
+constexpr size_t smallBufferSize{512};
+constexpr unsigned stallEventCount{150};
+
+/*
+ * Raw client which can stop acknowledging received data, so the server's send window fills
+ * just as it would for a slow or stalled peer
+ */
+class StalledClient : public TcpClient
+{
+public:
+	StalledClient() : TcpClient(false)
+	{
+	}
+
+	void resume()
+	{
+		stalled = false;
+		if(tcp != nullptr && unacked != 0) {
+			tcp_recved(tcp, unacked);
+		}
+		unacked = 0;
+	}
+
+	String received;
+	bool stalled{true};
+	bool remoteClosed{false};
+
+protected:
+	err_t onConnected(err_t err) override
+	{
+		auto res = TcpClient::onConnected(err);
+		if(err == ERR_OK) {
+			tcp_recv(tcp, [](void* arg, tcp_pcb*, pbuf* p, err_t) -> err_t {
+				auto client = static_cast<StalledClient*>(static_cast<TcpConnection*>(arg));
+				client->onData(p);
+				return ERR_OK;
+			});
+		}
+		return res;
+	}
+
+private:
+	void onData(pbuf* p)
+	{
+		if(p == nullptr) {
+			remoteClosed = true;
+			return;
+		}
+		for(auto q = p; q != nullptr; q = q->next) {
+			received.concat(static_cast<const char*>(q->payload), q->len);
+		}
+		if(stalled) {
+			unacked += p->tot_len;
+		} else {
+			tcp_recved(tcp, p->tot_len);
+		}
+		pbuf_free(p);
+	}
+
+	size_t unacked{0};
+};
+
+String makeEvent(unsigned index)
+{
+	String s(index);
+	s += ' ';
+	s.padRight(100, '.');
+	return s;
+}
+
+/*
+ * Split received stream into event numbers, checking each event is complete
+ */
+bool parseEvents(const String& stream, Vector<unsigned>& events)
+{
+	int pos = stream.indexOf("\r\n\r\n");
+	if(pos < 0) {
+		return false;
+	}
+	pos += 4;
+	while(unsigned(pos) < stream.length()) {
+		int end = stream.indexOf("\n\n", pos);
+		if(end < 0) {
+			return false;
+		}
+		String event = stream.substring(pos, end);
+		if(!event.startsWith("data: ")) {
+			return false;
+		}
+		unsigned index = event.substring(6).toInt();
+		if(event.substring(6) != makeEvent(index)) {
+			return false;
+		}
+		events.add(index);
+		pos = end + 2;
+	}
+	return true;
+}
+
+} // namespace
+
+class EventSourceTest : public TestGroup
+{
+public:
+	EventSourceTest() : TestGroup(_F("EventSource")), server(new HttpServer)
+	{
+	}
+
+	void execute() override
+	{
+		if(!WifiStation.isConnected()) {
+			Serial.println("No network, skipping tests");
+			return;
+		}
+
+		eventSource = new EventSourceResource(HTTP_SSE_BUFFER_SIZE, subscriberCount);
+		server->listen(serverPort);
+		server->paths.set("/events", eventSource);
+
+		savedSettings = HttpClient::getConnectionPool().getSettings();
+		auto settings = savedSettings;
+		settings.maxPerHost = subscriberCount + 1;
+		settings.maxPipelineDepth = 1;
+		HttpClient::getConnectionPool().setSettings(settings);
+
+		Url url = getUrl(F("/events"));
+
+		// One more request than the limit, which should be refused
+		for(unsigned i = 0; i <= subscriberCount; ++i) {
+			auto req = new HttpRequest(url);
+			req->onBody([this, i](HttpConnection&, const char* at, size_t length) -> int {
+				received[i].concat(at, length);
+				return 0;
+			});
+			req->onRequestComplete([this](HttpConnection& connection, bool) -> int {
+				if(connection.getResponse()->code == HTTP_STATUS_SERVICE_UNAVAILABLE) {
+					++refused;
+				}
+				return 0;
+			});
+			client.send(req);
+		}
+
+		timer.initializeMs<500>([this]() { sendEvents(); });
+		timer.startOnce();
+		pending();
+	}
+
+	void sendEvents()
+	{
+		TEST_CASE("Subscribe")
+		{
+			REQUIRE_EQ(eventSource->getSubscriberCount(), subscriberCount);
+			REQUIRE_EQ(refused, 1U);
+		}
+
+		REQUIRE(eventSource->send(F("first")));
+		REQUIRE(eventSource->send(F("line 1\nline 2"), F("update"), F("2")));
+		REQUIRE(eventSource->sendComment());
+
+		timer.initializeMs<500>([this]() { checkEvents(); });
+		timer.startOnce();
+	}
+
+	void checkEvents()
+	{
+		TEST_CASE("Receive events")
+		{
+			String expected = F("data: first\n\n"
+								"event: update\nid: 2\ndata: line 1\ndata: line 2\n\n"
+								":\n\n");
+			for(unsigned i = 0; i < subscriberCount; ++i) {
+				REQUIRE_EQ(received[i], expected);
+			}
+			REQUIRE_EQ(eventSource->getDroppedCount(), 0U);
+			REQUIRE_EQ(eventSource->getDisconnectCount(), 0U);
+		}
+
+		HttpClient::cleanup();
+		startStall(EventSourceResource::DropPolicy::DropOldest);
+	}
+
+	/*
+	 * One subscriber reads everything, the other stops reading so falls behind
+	 */
+	void startStall(EventSourceResource::DropPolicy policy)
+	{
+		dropPolicy = policy;
+		String path = (policy == EventSourceResource::DropPolicy::DropOldest) ? F("/drop") : F("/disconnect");
+		eventSource = new EventSourceResource(smallBufferSize, subscriberCount);
+		eventSource->setDropPolicy(policy);
+		server->paths.set(path, eventSource);
+
+		Url url = getUrl(path);
+		received[0] = nullptr;
+		auto req = new HttpRequest(url);
+		req->onBody([this](HttpConnection&, const char* at, size_t length) -> int {
+			received[0].concat(at, length);
+			return 0;
+		});
+		REQUIRE(client.send(req));
+
+		stalledClient = new StalledClient;
+		REQUIRE(stalledClient->connect(WifiStation.getIP(), serverPort));
+		String request = F("GET ");
+		request += path;
+		request += F(" HTTP/1.1\r\nHost: ");
+		request += url.Host;
+		request += F("\r\n\r\n");
+		REQUIRE(stalledClient->sendString(request));
+
+		expected = nullptr;
+		eventIndex = 0;
+		timer.initializeMs<500>([this]() { publishStall(); });
+		timer.startOnce();
+	}
+
+	void publishStall()
+	{
+		if(eventIndex == 0) {
+			REQUIRE_EQ(eventSource->getSubscriberCount(), subscriberCount);
+		}
+
+		auto event = makeEvent(eventIndex);
+		REQUIRE(eventSource->send(event));
+		expected += F("data: ");
+		expected += event;
+		expected += F("\n\n");
+
+		if(++eventIndex < stallEventCount) {
+			timer.initializeMs<10>([this]() { publishStall(); });
+		} else {
+			timer.initializeMs<500>([this]() { checkStall(); });
+		}
+		timer.startOnce();
+	}
+
+	void checkStall()
+	{
+		bool dropOldest = (dropPolicy == EventSourceResource::DropPolicy::DropOldest);
+
+		debug_i("Drop policy %s", dropOldest ? "DropOldest" : "Disconnect");
+
+		TEST_CASE("Stalled subscriber")
+		{
+			// Reading subscriber is unaffected
+			REQUIRE_EQ(received[0], expected);
+
+			if(dropOldest) {
+				REQUIRE(eventSource->getDroppedCount() != 0);
+				REQUIRE_EQ(eventSource->getDisconnectCount(), 0U);
+				REQUIRE_EQ(eventSource->getSubscriberCount(), subscriberCount);
+			} else {
+				REQUIRE_EQ(eventSource->getDisconnectCount(), 1U);
+				REQUIRE_EQ(eventSource->getSubscriberCount(), subscriberCount - 1);
+			}
+		}
+
+		stalledClient->resume();
+		timer.initializeMs<500>([this, dropOldest]() {
+			TEST_CASE("Resume stalled subscriber")
+			{
+				Vector<unsigned> events;
+				REQUIRE(parseEvents(stalledClient->received, events));
+				REQUIRE(events.count() != 0);
+				REQUIRE_EQ(events[0], 0U);
+				bool gaps{false};
+				for(unsigned i = 1; i < events.count(); ++i) {
+					REQUIRE(events[i] > events[i - 1]);
+					gaps |= (events[i] != events[i - 1] + 1);
+				}
+				auto last = events[events.count() - 1];
+				if(dropOldest) {
+					// Only whole events are skipped, and the subscriber catches up
+					REQUIRE(gaps);
+					REQUIRE_EQ(last, stallEventCount - 1);
+					REQUIRE(!stalledClient->remoteClosed);
+				} else {
+					// Everything sent before the disconnect arrives intact
+					REQUIRE(!gaps);
+					REQUIRE(last < stallEventCount - 1);
+					REQUIRE(stalledClient->remoteClosed);
+				}
+			}
+
+			HttpClient::cleanup();
+			delete stalledClient;
+			stalledClient = nullptr;
+			if(dropOldest) {
+				startStall(EventSourceResource::DropPolicy::Disconnect);
+			} else {
+				finish();
+			}
+		});
+		timer.startOnce();
+	}
+
+	void finish()
+	{
+		HttpClient::getConnectionPool().setSettings(savedSettings);
+		server->shutdown();
+		server = nullptr;
+		timer.initializeMs<1000>([this]() { complete(); });
+		timer.startOnce();
+	}
+
+private:
+	Url getUrl(const String& path) const
+	{
+		Url url;
+		url.Host = WifiStation.getIP().toString();
+		url.Port = serverPort;
+		url.Path = path;
+		return url;
+	}
+
+	HttpServer* server;
+	EventSourceResource* eventSource{nullptr};
+	HttpClient client;
+	HttpClientPool::Settings savedSettings;
+	String received[subscriberCount + 1];
+	unsigned refused{0};
+	StalledClient* stalledClient{nullptr};
+	EventSourceResource::DropPolicy dropPolicy{};
+	String expected;
+	unsigned eventIndex{0};
+	Timer timer;
+};
+
+void REGISTER_TEST(EventSource)
+{
+	registerGroup<EventSourceTest>();
+}
@@ -0,0 +1,234 @@
+#include <HostTests.h>
+
+#include <Network/HttpServer.h>
+#include <Network/HttpClient.h>
+#include <Platform/Station.h>
+
+namespace
+{
+// Pool distinguishes hosts by address and port, so each server is a separate host
+constexpr uint16_t serverPorts[]{8083, 8084};
+constexpr uint16_t unusedPort{8085};
+constexpr unsigned holdTime{200};
+
+/*
+ * Response content is held back for a while, so requests queued behind it have to wait.
+ * Server picks up the content when it next polls the connection.
+ */
+class HeldStream : public MemoryDataStream
+{
+public:
+	HeldStream() : releaseTime(millis() + holdTime)
+	{
+	}
+
+	uint16_t readMemoryBlock(char* data, int bufSize) override
+	{
+		return isHeld() ? 0 : MemoryDataStream::readMemoryBlock(data, bufSize);
+	}
+
+	bool isFinished() override
+	{
+		return !isHeld() && MemoryDataStream::isFinished();
+	}
+
+private:
+	bool isHeld() const
+	{
+		return int32_t(millis() - releaseTime) < 0;
+	}
+
+	uint32_t releaseTime;
+};
+
+} // namespace
+
+class HttpClientPoolTest : public TestGroup
+{
+public:
+	HttpClientPoolTest() : TestGroup(_F("HTTP client pool"))
+	{
+	}
+
+	void execute() override
+	{
+		if(!WifiStation.isConnected()) {
+			Serial.println("No network, skipping tests");
+			return;
+		}
+
+		for(unsigned i = 0; i < ARRAY_SIZE(servers); ++i) {
+			auto server = new HttpServer;
+			server->listen(serverPorts[i]);
+			server->paths.set("/ping", [](HttpRequest&, HttpResponse& response) { response.sendString(F("pong")); });
+			server->paths.set("/hold", [](HttpRequest&, HttpResponse& response) {
+				auto stream = new HeldStream;
+				stream->print(F("pong"));
+				response.sendDataStream(stream, MIME_TEXT);
+			});
+			servers[i] = server;
+		}
+
+		auto& pool = HttpClient::getConnectionPool();
+		HttpClient::cleanup();
+		savedSettings = pool.getSettings();
+		HttpClientPool::Settings settings;
+		settings.maxConnections = 3;
+		settings.maxPerHost = 2;
+		// Responses may take a couple of seconds, so keep idle connections until the timeout test
+		settings.idleTimeout = 60;
+		settings.maxPipelineDepth = 1;
+		pool.setSettings(settings);
+		pool.resetStats();
+
+		nextStep();
+		pending();
+	}
+
+	void nextStep()
+	{
+		auto& pool = HttpClient::getConnectionPool();
+		auto& stats = pool.getStats();
+
+		switch(step++) {
+		case 0:
+			TEST_CASE("Parallel connections to one host")
+			{
+				// Third request must wait for a response on one of the two connections
+				send(0, F("/hold"));
+				send(0, F("/hold"));
+				send(0, F("/ping"));
+				REQUIRE_EQ(pool.count(), 2U);
+				REQUIRE_EQ(pool.count(getUrl(0)), 2U);
+				REQUIRE_EQ(stats.created, 2U);
+				REQUIRE_EQ(stats.evicted, 0U);
+			}
+			break;
+
+		case 1:
+			TEST_CASE("Queue wait")
+			{
+				REQUIRE_EQ(stats.started, 3U);
+				REQUIRE(stats.maxWaitTime >= holdTime);
+				REQUIRE(stats.totalWaitTime >= stats.maxWaitTime);
+			}
+
+			TEST_CASE("Reuse idle connection")
+			{
+				reusedCount = stats.reused;
+				send(0, F("/ping"));
+				REQUIRE_EQ(stats.created, 2U);
+				REQUIRE_EQ(stats.reused, reusedCount + 1);
+				REQUIRE_EQ(pool.count(), 2U);
+			}
+			break;
+
+		case 2:
+			TEST_CASE("Evict least recently used")
+			{
+				// Pool is full after the first request, so the second evicts an idle connection
+				send(1, F("/hold"));
+				REQUIRE_EQ(stats.created, 3U);
+				send(1, F("/hold"));
+				REQUIRE_EQ(stats.created, 4U);
+				REQUIRE_EQ(stats.evicted, 1U);
+				REQUIRE_EQ(pool.count(), 3U);
+				REQUIRE_EQ(pool.count(getUrl(0)), 1U);
+				REQUIRE_EQ(pool.count(getUrl(1)), 2U);
+
+				// Remaining connection to first host is idle, so gets used
+				send(0, F("/ping"));
+				REQUIRE_EQ(stats.created, 4U);
+				REQUIRE_EQ(stats.evicted, 1U);
+			}
+
+			TEST_CASE("Reject when full")
+			{
+				// Every connection is busy, so nothing can be evicted for a new host
+				Url url = getUrl(0);
+				url.Port = unusedPort;
+				REQUIRE(!client.send(new HttpRequest(url)));
+				REQUIRE_EQ(stats.rejected, 1U);
+				REQUIRE_EQ(pool.count(), 3U);
+				REQUIRE_EQ(pool.count(url), 0U);
+			}
+			break;
+
+		case 3:
+			TEST_CASE("Idle timeout")
+			{
+				REQUIRE_EQ(failed, 0U);
+				auto settings = pool.getSettings();
+				settings.idleTimeout = 1;
+				pool.setSettings(settings);
+
+				// Allow for the timeout plus the cleanup timer interval
+				timer.initializeMs<3000>([this]() {
+					auto& pool = HttpClient::getConnectionPool();
+					REQUIRE_EQ(pool.count(), 0U);
+					REQUIRE_EQ(pool.getStats().evicted, 4U);
+					pool.printStats(Serial);
+					nextStep();
+				});
+				timer.startOnce();
+			}
+			break;
+
+		default:
+			HttpClient::cleanup();
+			pool.setSettings(savedSettings);
+			for(auto& server : servers) {
+				server->shutdown();
+				server = nullptr;
+			}
+			timer.initializeMs<1000>([this]() { complete(); });
+			timer.startOnce();
+		}
+	}
+
+private:
+	Url getUrl(unsigned serverIndex) const
+	{
+		Url url;
+		url.Host = WifiStation.getIP().toString();
+		url.Port = serverPorts[serverIndex];
+		url.Path = F("/ping");
+		return url;
+	}
+
+	/*
+	 * Move to next step once all outstanding requests have completed
+	 */
+	void send(unsigned serverIndex, const String& path)
+	{
+		Url url = getUrl(serverIndex);
+		url.Path = path;
+		auto req = new HttpRequest(url);
+		req->onRequestComplete([this](HttpConnection& connection, bool success) -> int {
+			if(!success || connection.getResponse()->getBody() != F("pong")) {
+				++failed;
+			}
+			if(--outstanding == 0) {
+				// Connections cannot be changed from within their own callback
+				System.queueCallback([this]() { nextStep(); });
+			}
+			return 0;
+		});
+		++outstanding;
+		REQUIRE(client.send(req));
+	}
+
+	HttpServer* servers[ARRAY_SIZE(serverPorts)]{};
+	HttpClient client;
+	HttpClientPool::Settings savedSettings;
+	Timer timer;
+	unsigned step{0};
+	unsigned outstanding{0};
+	unsigned failed{0};
+	uint32_t reusedCount{0};
+};
+
+void REGISTER_TEST(HttpClientPool)
+{
+	registerGroup<HttpClientPoolTest>();
+}
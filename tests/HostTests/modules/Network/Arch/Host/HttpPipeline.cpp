@@ -0,0 +1,141 @@
+#include <HostTests.h>
+
+#include <Network/HttpServer.h>
+#include <Network/HttpClient.h>
+#include <Platform/Station.h>
+
+#ifndef HTTP_PIPELINE_BENCHMARK_REQUESTS
+#define HTTP_PIPELINE_BENCHMARK_REQUESTS 16
+#endif
+
+namespace
+{
+constexpr uint16_t serverPort{8080};
+constexpr unsigned requestCount{HTTP_PIPELINE_BENCHMARK_REQUESTS};
+static_assert(requestCount <= HTTP_REQUEST_POOL_SIZE, "Too many requests for queue");
+
+// Pipeline depths to compare, over a single connection
+constexpr uint8_t depths[]{1, 2, 4, 8};
+
+} // namespace
+
+class HttpPipelineTest : public TestGroup
+{
+public:
+	HttpPipelineTest() : TestGroup(_F("HTTP pipelining")), server(new HttpServer)
+	{
+	}
+
+	void execute() override
+	{
+		if(!WifiStation.isConnected()) {
+			Serial.println("No network, skipping tests");
+			return;
+		}
+
+		server->listen(serverPort);
+		server->paths.set("/ping", [](HttpRequest&, HttpResponse& response) { response.sendString(F("pong")); });
+
+		savedSettings = HttpClient::getConnectionPool().getSettings();
+		startRun();
+		pending();
+	}
+
+	/*
+	 * Depth starts at 1 on a new connection, so warm it up before timing anything
+	 */
+	void startRun()
+	{
+		auto& pool = HttpClient::getConnectionPool();
+		HttpClient::cleanup();
+		auto settings = savedSettings;
+		settings.maxPerHost = 1;
+		settings.maxPipelineDepth = depths[runIndex];
+		pool.setSettings(settings);
+
+		warmingUp = true;
+		sendBatch();
+	}
+
+	/*
+	 * Queue all requests at once, so the client can pipeline as many as permitted
+	 */
+	void sendBatch()
+	{
+		Url url;
+		url.Host = WifiStation.getIP().toString();
+		url.Port = serverPort;
+		url.Path = F("/ping");
+
+		completed = 0;
+		failed = 0;
+		HttpClient::getConnectionPool().resetStats();
+		runTimer.start();
+		for(unsigned i = 0; i < requestCount; ++i) {
+			auto req = new HttpRequest(url);
+			req->onRequestComplete([this](HttpConnection& connection, bool success) -> int {
+				if(!success || connection.getResponse()->getBody() != F("pong")) {
+					++failed;
+				}
+				if(++completed == requestCount) {
+					reachedDepth = static_cast<HttpClientConnection&>(connection).getPipelineDepth();
+					// Connections cannot be cleaned up from within their own callback
+					System.queueCallback([this]() { batchComplete(); });
+				}
+				return 0;
+			});
+			REQUIRE(client.send(req));
+		}
+	}
+
+	void batchComplete()
+	{
+		REQUIRE_EQ(failed, 0U);
+		if(warmingUp) {
+			warmingUp = (reachedDepth < depths[runIndex]);
+			sendBatch();
+			return;
+		}
+		finishRun();
+	}
+
+	void finishRun()
+	{
+		uint32_t elapsed = runTimer.elapsedTime();
+		auto depth = depths[runIndex];
+		auto requestsPerSecond = uint64_t(requestCount) * 1000000 / std::max(elapsed, 1U);
+		Serial << _F("Depth ") << depth << ": " << requestCount << _F(" requests in ") << elapsed << _F(" us, ")
+			   << requestsPerSecond << _F(" requests/sec") << endl;
+		HttpClient::getConnectionPool().printStats(Serial);
+		REQUIRE_EQ(reachedDepth, depth);
+
+		if(++runIndex < ARRAY_SIZE(depths)) {
+			startRun();
+			return;
+		}
+
+		HttpClient::cleanup();
+		HttpClient::getConnectionPool().setSettings(savedSettings);
+		server->shutdown();
+		server = nullptr;
+		timer.initializeMs<1000>([this]() { complete(); });
+		timer.startOnce();
+	}
+
+private:
+	HttpServer* server{nullptr};
+	HttpClient client;
+	HttpClientPool::Settings savedSettings;
+	OneShotFastUs runTimer;
+	Timer timer;
+	unsigned runIndex{0};
+	unsigned completed{0};
+	unsigned failed{0};
+	uint8_t reachedDepth{0};
+	bool warmingUp{false};
+};
+
+void REGISTER_TEST(HttpPipeline)
+{
+	registerGroup<HttpPipelineTest>();
+}
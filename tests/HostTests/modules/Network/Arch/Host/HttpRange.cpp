@@ -0,0 +1,320 @@
+#include <HostTests.h>
+
+#include <Network/HttpServer.h>
+#include <Network/HttpClient.h>
+#include <Platform/Station.h>
+
+namespace
+{
+constexpr uint16_t serverPort{8082};
+constexpr size_t contentSize{3000};
+DEFINE_FSTR_LOCAL(fileName, "range.bin")
+
+/*
+ * Reports the full content size but only contains the first part,
+ * so the server sends a short response and closes the connection.
+ */
+class TruncatedStream : public MemoryDataStream
+{
+public:
+	TruncatedStream(size_t missing) : missing(missing)
+	{
+	}
+
+	int available() override
+	{
+		return MemoryDataStream::available() + missing;
+	}
+
+private:
+	size_t missing;
+};
+
+/*
+ * Sends the first part of the content then stalls, so the response never completes
+ */
+class StalledStream : public TruncatedStream
+{
+public:
+	using TruncatedStream::TruncatedStream;
+
+	bool isFinished() override
+	{
+		return false;
+	}
+};
+
+String makeContent(char first)
+{
+	String s;
+	s.reserve(contentSize);
+	for(unsigned i = 0; i < contentSize; ++i) {
+		s += char(first + (i % 26));
+	}
+	return s;
+}
+
+} // namespace
+
+class HttpRangeTest : public TestGroup
+{
+public:
+	HttpRangeTest() : TestGroup(_F("HTTP ranges")), server(new HttpServer)
+	{
+	}
+
+	void execute() override
+	{
+		if(!WifiStation.isConnected()) {
+			Serial.println("No network, skipping tests");
+			return;
+		}
+
+		// Downloads need a writeable filesystem, and an earlier test may have mounted a read-only one
+		REQUIRE(spiffs_mount());
+
+		content = makeContent('a');
+		etag = F("\"v1\"");
+
+		server->listen(serverPort);
+		server->paths.set("/data", [this](HttpRequest& request, HttpResponse& response) {
+			auto& headers = static_cast<const HttpHeaders&>(request.headers);
+			lastRange = headers[HTTP_HEADER_RANGE];
+			lastIfRange = headers[HTTP_HEADER_IF_RANGE];
+			++requestCount;
+
+			response.headers[HTTP_HEADER_ETAG] = etag;
+			size_t length = content.length();
+			MemoryDataStream* stream;
+			if(stallNext) {
+				stallNext = false;
+				length /= 2;
+				stream = new StalledStream(content.length() - length);
+			} else if(truncateNext) {
+				truncateNext = false;
+				length /= 2;
+				stream = new TruncatedStream(content.length() - length);
+				response.headers[HTTP_HEADER_CONNECTION] = F("close");
+			} else {
+				stream = new MemoryDataStream;
+			}
+			stream->write(content.c_str(), length);
+			response.sendDataStream(stream, MIME_BINARY);
+		});
+
+		nextStep();
+		pending();
+	}
+
+	void nextStep()
+	{
+		switch(step++) {
+		case 0:
+			TEST_CASE("Single range")
+			{
+				request(F("bytes=100-199"), nullptr, [this](bool success, HttpResponse& response) {
+					REQUIRE(success);
+					REQUIRE(response.code == HTTP_STATUS_PARTIAL_CONTENT);
+					REQUIRE_EQ(response.headers[HTTP_HEADER_ACCEPT_RANGES], _F("bytes"));
+					REQUIRE_EQ(response.headers[HTTP_HEADER_CONTENT_RANGE], _F("bytes 100-199/3000"));
+					REQUIRE(body == content.substring(100, 200));
+				});
+			}
+			break;
+
+		case 1:
+			TEST_CASE("Multiple ranges")
+			{
+				request(F("bytes=0-9,-10"), nullptr, [this](bool success, HttpResponse& response) {
+					REQUIRE(success);
+					REQUIRE(response.code == HTTP_STATUS_PARTIAL_CONTENT);
+					auto& contentType = response.headers[HTTP_HEADER_CONTENT_TYPE];
+					REQUIRE(contentType.startsWith(F("multipart/byteranges; boundary=")));
+					REQUIRE(!response.headers.contains(HTTP_HEADER_CONTENT_RANGE));
+					int part1 = body.indexOf(F("Content-Range: bytes 0-9/3000\r\n"));
+					int part2 = body.indexOf(F("Content-Range: bytes 2990-2999/3000\r\n"));
+					REQUIRE(part1 >= 0);
+					REQUIRE(part2 > part1);
+					REQUIRE(body.indexOf(content.substring(0, 10), part1) > part1);
+					REQUIRE(body.indexOf(content.substring(2990), part2) > part2);
+				});
+			}
+			break;
+
+		case 2:
+			TEST_CASE("Unsatisfiable range")
+			{
+				request(F("bytes=3000-"), nullptr, [this](bool success, HttpResponse& response) {
+					REQUIRE(!success);
+					REQUIRE(response.code == HTTP_STATUS_RANGE_NOT_SATISFIABLE);
+					REQUIRE_EQ(response.headers[HTTP_HEADER_CONTENT_RANGE], _F("bytes */3000"));
+					REQUIRE(body.length() == 0);
+				});
+			}
+			break;
+
+		case 3:
+			TEST_CASE("If-Range mismatch")
+			{
+				// Content has changed, so all of it is sent
+				request(F("bytes=100-199"), F("\"v0\""), [this](bool success, HttpResponse& response) {
+					REQUIRE(success);
+					REQUIRE(response.code == HTTP_STATUS_OK);
+					REQUIRE(!response.headers.contains(HTTP_HEADER_CONTENT_RANGE));
+					REQUIRE(body == content);
+				});
+			}
+			break;
+
+		case 4:
+			TEST_CASE("If-Range match")
+			{
+				request(F("bytes=100-199"), etag, [this](bool success, HttpResponse& response) {
+					REQUIRE(success);
+					REQUIRE(response.code == HTTP_STATUS_PARTIAL_CONTENT);
+					REQUIRE(body == content.substring(100, 200));
+				});
+			}
+			break;
+
+		case 5:
+			TEST_CASE("Resume interrupted download")
+			{
+				// First response is cut short, so the client sends the request again for the remainder
+				fileDelete(fileName);
+				truncateNext = true;
+				requestCount = 0;
+				REQUIRE(client.downloadFile(getUrl(), fileName,
+											onComplete([this](bool success, HttpResponse& response) {
+												REQUIRE(success);
+												REQUIRE(response.code == HTTP_STATUS_PARTIAL_CONTENT);
+												REQUIRE_EQ(requestCount, 2U);
+												REQUIRE_EQ(lastRange, _F("bytes=1500-"));
+												REQUIRE_EQ(lastIfRange, etag);
+											})));
+			}
+			break;
+
+		case 6:
+			TEST_CASE("Resume complete download")
+			{
+				// Server can't satisfy a range which starts at the end, but we already have everything
+				REQUIRE(client.resumeDownload(getUrl(), fileName, etag,
+											  onComplete([this](bool success, HttpResponse& response) {
+												  REQUIRE(success);
+												  REQUIRE(response.code == HTTP_STATUS_RANGE_NOT_SATISFIABLE);
+												  REQUIRE_EQ(lastRange, _F("bytes=3000-"));
+											  })));
+			}
+			break;
+
+		case 7:
+			TEST_CASE("Truncate on 200")
+			{
+				// Content changed since partial download, so file is replaced
+				REQUIRE(fileSetContent(fileName, content.substring(0, 1000)) == 1000);
+				content = makeContent('A');
+				etag = F("\"v2\"");
+				REQUIRE(client.resumeDownload(getUrl(), fileName, F("\"v1\""),
+											  onComplete([this](bool success, HttpResponse& response) {
+												  REQUIRE(success);
+												  REQUIRE(response.code == HTTP_STATUS_OK);
+												  REQUIRE_EQ(lastRange, _F("bytes=1000-"));
+												  REQUIRE_EQ(lastIfRange, _F("\"v1\""));
+											  })));
+			}
+			break;
+
+		case 8:
+			TEST_CASE("Destroy connection during resumable download")
+			{
+				// Partial content is kept for resending, but the request goes with the connection
+				fileDelete(fileName);
+				stallNext = true;
+				REQUIRE(client.downloadFile(getUrl(), fileName, [this](HttpConnection&, bool) -> int {
+					++stalledCompleteCount;
+					return 0;
+				}));
+				timer.initializeMs<500>([this]() {
+					HttpClient::cleanup();
+					REQUIRE_EQ(stalledCompleteCount, 0U);
+					nextStep();
+				});
+				timer.startOnce();
+			}
+			break;
+
+		default:
+			fileDelete(fileName);
+			HttpClient::cleanup();
+			server->shutdown();
+			server = nullptr;
+			timer.initializeMs<1000>([this]() { complete(); });
+			timer.startOnce();
+		}
+	}
+
+private:
+	using Check = Delegate<void(bool success, HttpResponse& response)>;
+
+	Url getUrl() const
+	{
+		Url url;
+		url.Host = WifiStation.getIP().toString();
+		url.Port = serverPort;
+		url.Path = F("/data");
+		return url;
+	}
+
+	/*
+	 * Run checks on completion. File content is compared once the download stream has been closed.
+	 */
+	RequestCompletedDelegate onComplete(Check check, bool isDownload = true)
+	{
+		return [this, check, isDownload](HttpConnection& connection, bool success) -> int {
+			check(success, *connection.getResponse());
+			System.queueCallback([this, isDownload]() {
+				if(isDownload) {
+					REQUIRE(fileGetContent(fileName) == content);
+				}
+				nextStep();
+			});
+			return 0;
+		};
+	}
+
+	void request(const String& range, const String& ifRange, Check check)
+	{
+		body = nullptr;
+		auto req = new HttpRequest(getUrl());
+		req->headers[HTTP_HEADER_RANGE] = range;
+		if(ifRange) {
+			req->headers[HTTP_HEADER_IF_RANGE] = ifRange;
+		}
+		req->onBody([this](HttpConnection&, const char* at, size_t length) -> int {
+			body.concat(at, length);
+			return 0;
+		});
+		req->onRequestComplete(onComplete(check, false));
+		REQUIRE(client.send(req));
+	}
+
+	HttpServer* server;
+	HttpClient client;
+	Timer timer;
+	String content;
+	String etag;
+	String body;
+	String lastRange;
+	String lastIfRange;
+	unsigned step{0};
+	unsigned requestCount{0};
+	unsigned stalledCompleteCount{0};
+	bool truncateNext{false};
+	bool stallNext{false};
+};
+
+void REGISTER_TEST(HttpRange)
+{
+	registerGroup<HttpRangeTest>();
+}
@@ -0,0 +1,136 @@
+#include <HostTests.h>
+
+#include <Network/UdpConnection.h>
+#include <Platform/Station.h>
+
+class UdpTest : public TestGroup
+{
+public:
+	UdpTest()
+		: TestGroup(_F("Udp")), server2([this](UdpConnection&, char* data, int size, IpAddress, uint16_t) {
+			  received2.add(String(data, size));
+		  })
+	{
+	}
+
+	void execute() override
+	{
+		if(!WifiStation.isConnected()) {
+			Serial.println("No network, skipping tests");
+			return;
+		}
+
+		server.setBatchReceiveHandler([this](UdpConnection&, const UdpDatagram* datagrams, unsigned count) {
+			++batchCount;
+			for(unsigned i = 0; i < count; ++i) {
+				received.add(String(datagrams[i].data, datagrams[i].length));
+			}
+
+			// Datagrams for server2 arrived at the same time, so its dispatch is still pending
+			if(clearHandler) {
+				REQUIRE_EQ(received2.count(), 0U);
+				server2.setBatchReceiveHandler(nullptr);
+				clearHandler = false;
+			}
+		});
+		server.listen(port);
+
+		TEST_CASE("UdpConnection::sendBatch")
+		{
+			// Includes one datagram too large for the send pool
+			String large;
+			large.pad(UDP_SEND_POOL_BUFFER_SIZE + 100, 'x');
+			for(unsigned i = 0; i < 10; ++i) {
+				sent.add(String(i) + _F(": This is a small datagram"));
+			}
+			sent.add(large);
+
+			UdpDatagram datagrams[11];
+			for(unsigned i = 0; i < sent.count(); ++i) {
+				datagrams[i] = UdpDatagram{sent[i].c_str(), uint16_t(sent[i].length()), WifiStation.getIP(), port};
+			}
+
+			/*
+			 * Loopback copies each datagram, so the first pooled buffer is free again
+			 * by the time the next datagram is sent.
+			 */
+			REQUIRE_EQ(client.sendBatch(datagrams, 6), 6U);
+			REQUIRE_EQ(client.getSendAllocCount(), 1U);
+
+			// Pooled buffer re-used, large datagram needs its own buffer
+			REQUIRE_EQ(client.sendBatch(&datagrams[6], 5), 5U);
+			REQUIRE_EQ(client.getSendAllocCount(), 2U);
+
+			timer.initializeMs<1000>([this]() { checkReceived(); });
+			timer.startOnce();
+			pending();
+		}
+	}
+
+	void checkReceived()
+	{
+		debug_i("Received %u datagrams in %u batches", received.count(), batchCount);
+		REQUIRE_EQ(server.getDroppedCount(), 0U);
+		REQUIRE_EQ(received.count(), sent.count());
+		for(unsigned i = 0; i < sent.count(); ++i) {
+			REQUIRE_EQ(received[i], sent[i]);
+		}
+		REQUIRE(batchCount != 0);
+		REQUIRE(batchCount < received.count());
+
+		clearPendingHandler();
+	}
+
+	void clearPendingHandler()
+	{
+		TEST_CASE("Clear batch handler with dispatch pending")
+		{
+			server2.setBatchReceiveHandler([this](UdpConnection&, const UdpDatagram*, unsigned) { ++batchCount2; });
+			server2.listen(port2);
+
+			// First datagram goes to server, whose handler removes the handler for server2
+			const char* msg[]{"trigger", "one", "two", "three"};
+			UdpDatagram datagrams[4];
+			for(unsigned i = 0; i < 4; ++i) {
+				datagrams[i] =
+					UdpDatagram{msg[i], uint16_t(strlen(msg[i])), WifiStation.getIP(), (i == 0) ? port : port2};
+			}
+			clearHandler = true;
+			REQUIRE_EQ(client.sendBatch(datagrams, 4), 4U);
+
+			timer.initializeMs<1000>([this]() {
+				REQUIRE(!clearHandler);
+				// Queued datagrams were passed to the data callback instead
+				REQUIRE_EQ(batchCount2, 0U);
+				REQUIRE_EQ(received2.count(), 3U);
+				REQUIRE(received2[0] == "one");
+				REQUIRE(received2[2] == "three");
+
+				server.close();
+				server2.close();
+				client.close();
+				complete();
+			});
+			timer.startOnce();
+		}
+	}
+
+private:
+	static constexpr uint16_t port{9877};
+	static constexpr uint16_t port2{9878};
+	UdpConnection server;
+	UdpConnection server2;
+	UdpConnection client;
+	Vector<String> sent;
+	Vector<String> received;
+	Vector<String> received2;
+	unsigned batchCount{0};
+	unsigned batchCount2{0};
+	bool clearHandler{false};
+	Timer timer;
+};
+
+void REGISTER_TEST(Udp)
+{
+	registerGroup<UdpTest>();
+}
@@ -4,6 +4,61 @@
 #include <Data/Stream/Base64OutputStream.h>
 #include <Data/WebHelpers/base64.h>
 
+#ifndef BASE64_BENCHMARK_ITERATIONS
+#define BASE64_BENCHMARK_ITERATIONS 200
+#endif
+
+namespace
+{
+const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/*
+ * Simple byte-at-a-time implementations for reference
+ */
+__noinline size_t byteEncode(const uint8_t* in, size_t len, char* out)
+{
+	auto p = out;
+	uint32_t acc{0};
+	unsigned bits{0};
+	for(size_t i = 0; i < len; ++i) {
+		acc = (acc << 8) | in[i];
+		bits += 8;
+		while(bits >= 6) {
+			bits -= 6;
+			*p++ = alphabet[(acc >> bits) & 0x3f];
+		}
+	}
+	if(bits != 0) {
+		*p++ = alphabet[(acc << (6 - bits)) & 0x3f];
+	}
+	while((p - out) % 4 != 0) {
+		*p++ = '=';
+	}
+	return p - out;
+}
+
+__noinline size_t byteDecode(const char* in, size_t len, uint8_t* out)
+{
+	auto p = out;
+	uint32_t acc{0};
+	unsigned bits{0};
+	for(size_t i = 0; i < len; ++i) {
+		auto c = strchr(alphabet, in[i]);
+		if(c == nullptr || in[i] == '\0') {
+			continue;
+		}
+		acc = (acc << 6) | (c - alphabet);
+		bits += 6;
+		if(bits >= 8) {
+			bits -= 8;
+			*p++ = acc >> bits;
+		}
+	}
+	return p - out;
+}
+
+} // namespace
+
 class Base64Test : public TestGroup
 {
 public:
@@ -14,6 +69,7 @@ public:
 	void execute() override
 	{
 		libTests();
+		referenceTests();
 		streamTests();
 	}
 
@@ -78,6 +134,61 @@ public:
 		}
 	}
 
+	void referenceTests()
+	{
+		constexpr size_t bufSize{1024};
+		auto data = new uint8_t[bufSize];
+		auto encoded = new char[bufSize * 2];
+		// Decoder requires space for a whole number of groups
+		constexpr size_t decodeSize{bufSize + 4};
+		auto decoded = new uint8_t[decodeSize];
+		os_get_random(data, bufSize);
+
+		TEST_CASE("Compare with reference")
+		{
+			unsigned errors{0};
+			for(unsigned len = 0; len < 300; ++len) {
+				auto offset = os_random() % (bufSize - len);
+				int encLen = base64_encode(len, &data[offset], bufSize * 2, encoded);
+				auto refLen = byteEncode(&data[offset], len, &encoded[bufSize]);
+				if(size_t(encLen) != refLen || memcmp(encoded, &encoded[bufSize], refLen) != 0) {
+					++errors;
+					continue;
+				}
+				int decLen = base64_decode(encLen, encoded, decodeSize, decoded);
+				if(size_t(decLen) != len || memcmp(decoded, &data[offset], len) != 0) {
+					++errors;
+				}
+			}
+			REQUIRE_EQ(errors, 0U);
+		}
+
+		TEST_CASE("Decode with line breaks and invalid characters")
+		{
+			String s = base64_encode(data, 100);
+			s.replace(_F("A"), _F("A\r\n"));
+			s.replace(_F("B"), _F("B !"));
+			REQUIRE(byteDecode(s.c_str(), s.length(), decoded) == 100);
+			REQUIRE(memcmp(decoded, data, 100) == 0);
+			REQUIRE(base64_decode(s) == String(reinterpret_cast<const char*>(data), 100));
+		}
+
+		TEST_CASE("Benchmark")
+		{
+			Serial << BASE64_BENCHMARK_ITERATIONS << " iterations of " << bufSize << " bytes" << endl;
+
+			size_t encLen = byteEncode(data, bufSize, encoded);
+			benchmark(F("encode byte"), [&]() { return byteEncode(data, bufSize, encoded); });
+			benchmark(F("encode libb64"), [&]() { return base64_encode(bufSize, data, bufSize * 2, encoded); });
+			benchmark(F("decode byte"), [&]() { return byteDecode(encoded, encLen, decoded); });
+			benchmark(F("decode libb64"), [&]() { return base64_decode(encLen, encoded, decodeSize, decoded); });
+		}
+
+		delete[] decoded;
+		delete[] encoded;
+		delete[] data;
+	}
+
 	void streamTests()
 	{
 		TEST_CASE("Base64OutputStream / StreamTransformer")
@@ -91,7 +202,37 @@ public:
 			s = base64_decode(s);
 			REQUIRE(Resource::image_png == s);
 		}
+
+		TEST_CASE("Base64OutputStream line breaks")
+		{
+			// Buffer sizes are chosen so blocks don't align with lines
+			for(auto resultSize : {500U, 64U, 12U}) {
+				auto src = new FSTR::Stream(Resource::image_png);
+				Base64OutputStream base64stream(src, resultSize);
+				MemoryDataStream output;
+				output.copyFrom(&base64stream);
+				String s;
+				REQUIRE(output.moveString(s));
+				int lineLength = s.indexOf('\n');
+				REQUIRE_EQ(lineLength, 72);
+				s.replace("\n", 1, "", 0);
+				REQUIRE(s == base64_encode(String(Resource::image_png)));
+			}
+		}
 	}
+
+private:
+	template <typename Func> void benchmark(const String& name, Func func)
+	{
+		OneShotFastUs timer;
+		for(unsigned i = 0; i < BASE64_BENCHMARK_ITERATIONS; ++i) {
+			sink = func();
+		}
+		auto elapsed = timer.elapsedTime();
+		Serial << name << ": " << elapsed << " us" << endl;
+	}
+
+	volatile intptr_t sink;
 };
 
 void REGISTER_TEST(Base64)
@@ -2,6 +2,10 @@
 
 #include "Network/Http/HttpCommon.h"
 #include "Network/Http/HttpHeaders.h"
+#include "Network/Http/HttpContentDecoder.h"
+#include "Network/Http/HttpRange.h"
+#include <Data/Stream/MemoryDataStream.h>
+#include <Data/Stream/RangeStream.h>
 #include <Data/WebConstants.h>
 #include <Platform/Timers.h>
 
@@ -17,6 +21,8 @@ public:
 		testHttpCommon();
 		testHttpHeaders();
 		profileHttpHeaders();
+		testContentDecoder();
+		testRange();
 	}
 
 	void testHttpCommon()
@@ -216,6 +222,215 @@ public:
 			REQUIRE(headers2.append(HTTP_HEADER_CONTENT_LENGTH, "1234") == false);
 		}
 	}
+
+	static int decode(HttpContentDecoder::Format format, const String& input, size_t blockSize, String& output,
+					  uint8_t windowBits = HTTP_CLIENT_DECODE_WINDOW_BITS)
+	{
+		output = "";
+		HttpContentDecoder decoder(
+			format,
+			[&](const char* data, size_t length) -> int {
+				output.concat(data, length);
+				return 0;
+			},
+			windowBits);
+		for(size_t pos = 0; pos < input.length(); pos += blockSize) {
+			int err = decoder.decode(input.c_str() + pos, std::min(blockSize, input.length() - pos));
+			if(err != 0) {
+				return err;
+			}
+		}
+		return decoder.finish();
+	}
+
+	void testContentDecoder()
+	{
+		using Format = HttpContentDecoder::Format;
+
+		TEST_CASE("Content-Encoding")
+		{
+			Format format;
+			REQUIRE(HttpContentDecoder::getFormat("gzip", format));
+			REQUIRE(format == Format::gzip);
+			REQUIRE(HttpContentDecoder::getFormat(" X-GZIP", format));
+			REQUIRE(format == Format::gzip);
+			REQUIRE(HttpContentDecoder::getFormat("deflate", format));
+			REQUIRE(format == Format::deflate);
+			REQUIRE(!HttpContentDecoder::getFormat("br", format));
+			REQUIRE(!HttpContentDecoder::getFormat(String(), format));
+		}
+
+		struct Source {
+			Format format;
+			const FlashString& data;
+		};
+		const Source sources[]{
+			{Format::gzip, Resource::abstract_txt_gz},
+			{Format::deflate, Resource::abstract_txt_zlib},
+			{Format::deflate, Resource::abstract_txt_deflate},
+		};
+
+		TEST_CASE("Decode content")
+		{
+			for(auto& src : sources) {
+				String input = src.data;
+				for(size_t blockSize : {1, 7, 100, 1460, 4096}) {
+					String output;
+					REQUIRE_EQ(decode(src.format, input, blockSize, output), 0);
+					REQUIRE(Resource::abstract_txt == output);
+				}
+
+				// Anything after the compressed data is ignored
+				String output;
+				REQUIRE_EQ(decode(src.format, input + "trailing", 100, output), 0);
+				REQUIRE(Resource::abstract_txt == output);
+			}
+		}
+
+		/*
+		 * Compressed data spans many input buffers, and blocks smaller than the decoder's input margin
+		 * leave it repeatedly short of data.
+		 */
+		TEST_CASE("Decode multi-KB content in small blocks")
+		{
+			const Source largeSources[]{
+				{Format::gzip, Resource::ut_template1_out1_rst_gz},
+				{Format::gzip, Resource::image_png_gz},
+			};
+			const FlashString* expected[]{&Resource::ut_template1_out1_rst, &Resource::image_png};
+			for(unsigned i = 0; i < ARRAY_SIZE(largeSources); ++i) {
+				String input = largeSources[i].data;
+				REQUIRE(input.length() > 4096);
+				for(size_t blockSize : {1, 13, 64, 319, 321}) {
+					String output;
+					REQUIRE_EQ(decode(largeSources[i].format, input, blockSize, output), 0);
+					REQUIRE(*expected[i] == output);
+				}
+			}
+		}
+
+		TEST_CASE("Invalid content")
+		{
+			String output;
+			String input = Resource::abstract_txt_gz;
+			input.setLength(input.length() - 10);
+			REQUIRE(decode(Format::gzip, input, 100, output) != 0);
+
+			input = Resource::abstract_txt_gz;
+			input[input.length() / 2] ^= 0x55;
+			REQUIRE(decode(Format::gzip, input, 100, output) != 0);
+
+			// zlib header indicates window size, which exceeds our limit
+			REQUIRE(decode(Format::deflate, Resource::abstract_txt_zlib, 100, output, 9) != 0);
+		}
+	}
+
+	/*
+	 * Parse a Range header and return the ranges as a string, e.g. "0-9,20-29", or the return value if <= 0
+	 */
+	static String parseRange(const String& value, uint32_t size)
+	{
+		constexpr unsigned maxRanges{4};
+		HttpRange ranges[maxRanges];
+		int count = HttpRange::parse(value, size, ranges, maxRanges);
+		if(count <= 0) {
+			return String(count);
+		}
+		String s;
+		for(int i = 0; i < count; ++i) {
+			if(i != 0) {
+				s += ',';
+			}
+			s += ranges[i].start;
+			s += '-';
+			s += ranges[i].end;
+		}
+		return s;
+	}
+
+	void testRange()
+	{
+		TEST_CASE("Range header")
+		{
+			REQUIRE_EQ(parseRange(_F("bytes=0-99"), 1000), _F("0-99"));
+			REQUIRE_EQ(parseRange(_F("bytes=900-"), 1000), _F("900-999"));
+			REQUIRE_EQ(parseRange(_F("bytes=-100"), 1000), _F("900-999"));
+			REQUIRE_EQ(parseRange(_F("bytes=-2000"), 1000), _F("0-999"));
+			REQUIRE_EQ(parseRange(_F("bytes=500-5000"), 1000), _F("500-999"));
+			REQUIRE_EQ(parseRange(_F("bytes= 0-9 , 20-29,, 100-"), 110), _F("0-9,20-29,100-109"));
+			REQUIRE_EQ(parseRange(_F("bytes=0-9,2000-"), 1000), _F("0-9"));
+			REQUIRE_EQ(parseRange(_F("bytes=0-99999999999999999999"), 1000), _F("0-999"));
+			REQUIRE_EQ(parseRange(_F("Bytes=0-9"), 1000), _F("0-9"));
+
+			// Unsatisfiable
+			REQUIRE_EQ(parseRange(_F("bytes=1000-"), 1000), "0");
+			REQUIRE_EQ(parseRange(_F("bytes=-0"), 1000), "0");
+			REQUIRE_EQ(parseRange(_F("bytes=0-"), 0), "0");
+
+			// Invalid, overlapping or too many ranges are ignored
+			REQUIRE_EQ(parseRange(_F("items=0-9"), 1000), "-1");
+			REQUIRE_EQ(parseRange(_F("bytes="), 1000), "-1");
+			REQUIRE_EQ(parseRange(_F("bytes=9-0"), 1000), "-1");
+			REQUIRE_EQ(parseRange(_F("bytes=a-b"), 1000), "-1");
+			REQUIRE_EQ(parseRange(_F("bytes=-"), 1000), "-1");
+			REQUIRE_EQ(parseRange(_F("bytes=0-9 x"), 1000), "-1");
+			REQUIRE_EQ(parseRange(_F("bytes=0-9,\xb2-9"), 1000), "-1");
+			REQUIRE_EQ(parseRange(_F("bytes=0-99,50-149"), 1000), "-1");
+			REQUIRE_EQ(parseRange(_F("bytes=0-0,2-2,4-4,6-6,8-8"), 1000), "-1");
+		}
+
+		TEST_CASE("Content-Range header")
+		{
+			HttpRange range{100, 199};
+			REQUIRE_EQ(range.length(), 100U);
+			REQUIRE_EQ(range.toString(1000), _F("bytes 100-199/1000"));
+
+			range = {};
+			REQUIRE(HttpRange::parseContentRange(_F("bytes 100-199/1000"), range));
+			REQUIRE_EQ(range.start, 100U);
+			REQUIRE_EQ(range.end, 199U);
+			REQUIRE(HttpRange::parseContentRange(_F("bytes 0-0/*"), range));
+			REQUIRE_EQ(range.end, 0U);
+			REQUIRE(!HttpRange::parseContentRange(_F("bytes */1000"), range));
+			REQUIRE(!HttpRange::parseContentRange(_F("bytes 199-100/1000"), range));
+			REQUIRE(!HttpRange::parseContentRange(_F("bytes 100-199"), range));
+			REQUIRE(!HttpRange::parseContentRange(String(), range));
+
+			uint32_t size{0};
+			REQUIRE(HttpRange::parseUnsatisfiedRange(_F("bytes */1000"), size));
+			REQUIRE_EQ(size, 1000U);
+			REQUIRE(!HttpRange::parseUnsatisfiedRange(_F("bytes 0-9/1000"), size));
+			REQUIRE(!HttpRange::parseUnsatisfiedRange(_F("bytes */*"), size));
+			REQUIRE(!HttpRange::parseUnsatisfiedRange(_F("bytes */1000x"), size));
+		}
+
+		TEST_CASE("RangeStream")
+		{
+			String content = Resource::abstract_txt;
+			std::shared_ptr<IDataSourceStream> source(new MemoryDataStream(String(content)));
+
+			// Streams sharing a source are read in turn
+			for(auto& range : {HttpRange{100, 299}, HttpRange{0, 9}, HttpRange{500, 500}}) {
+				RangeStream stream(source, range.start, range.length());
+				REQUIRE_EQ(stream.available(), int(range.length()));
+				MemoryDataStream output;
+				output.copyFrom(&stream);
+				REQUIRE(stream.isFinished());
+				String s;
+				REQUIRE(output.moveString(s));
+				REQUIRE_EQ(s, content.substring(range.start, range.end + 1));
+			}
+
+			RangeStream stream(source, 10, 20);
+			REQUIRE_EQ(stream.seekFrom(5, SeekOrigin::Start), 5);
+			REQUIRE_EQ(stream.seekFrom(-1, SeekOrigin::End), 19);
+			REQUIRE_EQ(stream.seekFrom(2, SeekOrigin::Current), -1);
+			REQUIRE_EQ(stream.available(), 1);
+			char c;
+			REQUIRE_EQ(stream.readMemoryBlock(&c, 1), 1U);
+			REQUIRE_EQ(c, content[29]);
+		}
+	}
 };
 
 void REGISTER_TEST(Http)
@@ -3,6 +3,8 @@
 #include <Network/Url.h>
 #include <Network/Http/HttpRequest.h>
 #include <Network/Http/HttpBodyParser.h>
+#include <Network/Http/FormUrlParser.h>
+#include <Network/Http/HttpParamsView.h>
 #include <Data/Stream/UrlencodedOutputStream.h>
 #include <Data/Stream/MemoryDataStream.h>
 
@@ -45,6 +47,97 @@ public:
 			testUrl(FS_URL3, "81e66a3a");
 		}
 
+		TEST_CASE("FormUrlParser")
+		{
+			DEFINE_FSTR_LOCAL(FS_form, "name=Mary+had+a+little+lamb%2c&flag&&param%202=It%27s+fleece%"
+									   "20was+very+red.&empty=");
+			// Try all block sizes, including those which split escape sequences
+			for(unsigned blockSize = 1; blockSize <= FS_form.length(); ++blockSize) {
+				HttpParams params;
+				String value;
+				FormUrlParser parser([&](const String& name, const char* fragment, size_t length, bool complete) {
+					value.concat(fragment, length);
+					if(complete) {
+						params[name] = value;
+						value = "";
+					}
+					return true;
+				});
+				String form = FS_form;
+				for(unsigned pos = 0; pos < form.length(); pos += blockSize) {
+					parser.parse(&form[pos], std::min(size_t(blockSize), form.length() - pos));
+				}
+				parser.finish();
+				REQUIRE_EQ(params.count(), 4U);
+				REQUIRE_EQ(params["name"], "Mary had a little lamb,");
+				REQUIRE(params.contains("flag"));
+				REQUIRE_EQ(params["param 2"], "It's fleece was very red.");
+				REQUIRE_EQ(params["empty"], "");
+			}
+		}
+
+		TEST_CASE("FormUrlParser long value")
+		{
+			// Value is several times the unescape buffer size, with escapes falling at every buffer offset
+			String expected;
+			String form = F("long=");
+			for(unsigned i = 0; expected.length() < 5 * FORM_URL_PARSER_BUFSIZE; ++i) {
+				if(i % 7 == 0) {
+					expected += ',';
+					form += F("%2C");
+				} else if(i % 11 == 0) {
+					expected += ' ';
+					form += '+';
+				} else {
+					char c = 'a' + (i % 26);
+					expected += c;
+					form += c;
+				}
+			}
+			form += F("&last=1");
+
+			for(unsigned blockSize = 1; blockSize <= 16; ++blockSize) {
+				HttpParams params;
+				String value;
+				unsigned fragmentCount{0};
+				FormUrlParser parser([&](const String& name, const char* fragment, size_t length, bool complete) {
+					REQUIRE(length <= std::max(size_t(blockSize), size_t(FORM_URL_PARSER_BUFSIZE)));
+					++fragmentCount;
+					value.concat(fragment, length);
+					if(complete) {
+						params[name] = value;
+						value = "";
+					}
+					return true;
+				});
+				for(unsigned pos = 0; pos < form.length(); pos += blockSize) {
+					REQUIRE(parser.parse(&form[pos], std::min(size_t(blockSize), form.length() - pos)));
+				}
+				REQUIRE(parser.finish());
+				REQUIRE_EQ(params.count(), 2U);
+				REQUIRE_EQ(params["long"], expected);
+				REQUIRE_EQ(params["last"], "1");
+				REQUIRE(fragmentCount > 2);
+			}
+		}
+
+		TEST_CASE("HttpParamsView")
+		{
+			String query = F("?cid=fa373784&param+1=Mary+had+a+little+lamb%2c&&flag");
+			HttpParamsView params(query);
+			REQUIRE_EQ(params.count(), 3U);
+			REQUIRE_EQ(params["cid"], "fa373784");
+			REQUIRE_EQ(params["param 1"], "Mary had a little lamb,");
+			REQUIRE(params.contains("flag"));
+			REQUIRE(!params["param+1"]);
+
+			HttpParams copy(query);
+			REQUIRE_EQ(copy.count(), 3U);
+			for(auto& param : params) {
+				REQUIRE_EQ(copy[param.getName()], param.getValue());
+			}
+		}
+
 		HttpRequest request;
 
 		TEST_CASE("HttpRequest getQueryParameter()")
@@ -0,0 +1,305 @@
+#include <HostTests.h>
+
+#include <Network/Http/Websocket/WebsocketConnection.h>
+#include <Network/Http/Websocket/WebsocketDeflate.h>
+#include <memory>
+
+namespace
+{
+// Examples from RFC 7692 7.2.3
+const uint8_t helloCompressed[]{0xf2, 0x48, 0xcd, 0xc9, 0xc9, 0x07, 0x00};
+const uint8_t helloBfinal[]{0xf3, 0x48, 0xcd, 0xc9, 0xc9, 0x07, 0x00, 0x00};
+const uint8_t helloStored[]{0x00, 0x05, 0x00, 0xfa, 0xff, 0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x00};
+
+String makeTelemetry(unsigned count)
+{
+	String s;
+	s += '[';
+	for(unsigned i = 0; i < count; ++i) {
+		if(i != 0) {
+			s += ',';
+		}
+		s += _F("{\"sensor\":\"temperature\",\"index\":");
+		s += i;
+		s += _F(",\"value\":");
+		s += 20 + (i % 7);
+		s += '}';
+	}
+	s += ']';
+	return s;
+}
+
+/*
+ * Build a frame as a client would send it, masked
+ */
+String makeFrame(uint8_t opcode, bool fin, bool rsv1, const String& payload)
+{
+	const uint8_t maskKey[]{0x37, 0xfa, 0x21, 0x3d};
+	String frame;
+	frame += char((fin ? 0x80 : 0) | (rsv1 ? 0x40 : 0) | opcode);
+	auto len = payload.length();
+	if(len < 126) {
+		frame += char(0x80 | len);
+	} else {
+		frame += char(0x80 | 126);
+		frame += char(len >> 8);
+		frame += char(len & 0xff);
+	}
+	frame.concat(reinterpret_cast<const char*>(maskKey), sizeof(maskKey));
+	for(unsigned i = 0; i < len; ++i) {
+		frame += char(payload[i] ^ maskKey[i % 4]);
+	}
+	return frame;
+}
+
+/*
+ * Feeds received data directly to the frame processor, as if from TCP
+ */
+class TestWebsocket : public WebsocketConnection
+{
+public:
+	TestWebsocket(bool compressed)
+	{
+		if(compressed) {
+			deflate.reset(new WebsocketDeflate);
+		}
+		setMessageHandler([this](WebsocketConnection&, const String& message) {
+			received += message;
+			++messageCount;
+		});
+		setPongHandler([this](WebsocketConnection&) { ++pongCount; });
+	}
+
+	/*
+	 * Data is modified in place, as for received TCP data
+	 */
+	bool receive(String& data, unsigned sliceSize)
+	{
+		TcpClient client(false);
+		for(unsigned pos = 0; pos < data.length(); pos += sliceSize) {
+			auto len = std::min(size_t(sliceSize), data.length() - pos);
+			if(!processFrame(client, &data[pos], len)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	String received;
+	unsigned messageCount{0};
+	unsigned pongCount{0};
+};
+
+} // namespace
+
+class WebsocketTest : public TestGroup
+{
+public:
+	WebsocketTest() : TestGroup(_F("Websocket"))
+	{
+	}
+
+	void execute() override
+	{
+		testDeflate();
+		testNegotiation();
+		testFrames();
+	}
+
+	void testDeflate()
+	{
+		WebsocketDeflate deflate;
+
+		TEST_CASE("Decompress RFC examples")
+		{
+			REQUIRE_EQ(deflate.decompress(helloCompressed, sizeof(helloCompressed)), "Hello");
+			REQUIRE_EQ(deflate.decompress(helloBfinal, sizeof(helloBfinal)), "Hello");
+			REQUIRE_EQ(deflate.decompress(helloStored, sizeof(helloStored)), "Hello");
+		}
+
+		TEST_CASE("Compress round trip")
+		{
+			String message = makeTelemetry(50);
+			String compressed = deflate.compress(message.c_str(), message.length());
+			REQUIRE(compressed);
+			Serial << _F("Compressed ") << message.length() << _F(" -> ") << compressed.length() << _F(" bytes")
+				   << endl;
+			REQUIRE(compressed.length() < message.length() / 2);
+			REQUIRE_EQ(deflate.decompress(compressed.c_str(), compressed.length()), message);
+		}
+
+		TEST_CASE("Small window")
+		{
+			WebsocketDeflate deflate8(8);
+			String message = makeTelemetry(20);
+			String compressed = deflate8.compress(message.c_str(), message.length());
+			REQUIRE(compressed);
+			REQUIRE_EQ(deflate.decompress(compressed.c_str(), compressed.length()), message);
+		}
+
+		TEST_CASE("Uncompressed messages")
+		{
+			REQUIRE(!deflate.compress("Hello", 5));
+
+			// Random data doesn't compress
+			uint8_t data[256];
+			os_get_random(data, sizeof(data));
+			REQUIRE(!deflate.compress(data, sizeof(data)));
+		}
+
+		TEST_CASE("Invalid messages")
+		{
+			const uint8_t bad[]{0xff, 0xff, 0xff, 0xff};
+			REQUIRE(!deflate.decompress(bad, sizeof(bad)));
+
+			String message;
+			message.pad(WEBSOCKET_DEFLATE_MAX_MESSAGE_SIZE + 1, 'a');
+			String compressed = deflate.compress(message.c_str(), message.length());
+			REQUIRE(compressed);
+			REQUIRE(!deflate.decompress(compressed.c_str(), compressed.length()));
+
+			message.setLength(WEBSOCKET_DEFLATE_MAX_MESSAGE_SIZE);
+			compressed = deflate.compress(message.c_str(), message.length());
+			REQUIRE_EQ(deflate.decompress(compressed.c_str(), compressed.length()), message);
+		}
+	}
+
+	void testNegotiation()
+	{
+		TEST_CASE("Server accept")
+		{
+			String response;
+			std::unique_ptr<WebsocketDeflate> deflate;
+
+			deflate.reset(WebsocketDeflate::accept(_F("permessage-deflate; client_max_window_bits"), response));
+			REQUIRE(deflate);
+			REQUIRE_EQ(deflate->getWindowBits(), 15);
+			REQUIRE_EQ(response, _F("permessage-deflate; server_no_context_takeover; client_no_context_takeover"));
+
+			deflate.reset(WebsocketDeflate::accept(
+				_F("x-webkit-deflate-frame, permessage-deflate; server_max_window_bits=\"10\""), response));
+			REQUIRE(deflate);
+			REQUIRE_EQ(deflate->getWindowBits(), 10);
+			REQUIRE_EQ(response, _F("permessage-deflate; server_no_context_takeover; client_no_context_takeover; "
+									"server_max_window_bits=10"));
+
+			// First acceptable offer is chosen
+			deflate.reset(WebsocketDeflate::accept(
+				_F("permessage-deflate; server_max_window_bits=16, permessage-deflate; server_max_window_bits=9"),
+				response));
+			REQUIRE(deflate);
+			REQUIRE_EQ(deflate->getWindowBits(), 9);
+		}
+
+		TEST_CASE("Server decline")
+		{
+			String response;
+			REQUIRE(WebsocketDeflate::accept(_F("permessage-deflate; unknown_param"), response) == nullptr);
+			REQUIRE(WebsocketDeflate::accept(_F("permessage-deflate; server_max_window_bits"), response) == nullptr);
+			REQUIRE(WebsocketDeflate::accept(_F("permessage-deflate; client_no_context_takeover; "
+												"client_no_context_takeover"),
+											 response) == nullptr);
+			REQUIRE(WebsocketDeflate::accept(_F("x-webkit-deflate-frame"), response) == nullptr);
+		}
+
+		TEST_CASE("Client response")
+		{
+			WebsocketDeflate* deflate;
+			REQUIRE(WebsocketDeflate::checkResponse(String(), deflate));
+			REQUIRE(deflate == nullptr);
+
+			REQUIRE(WebsocketDeflate::checkResponse(_F("permessage-deflate; server_no_context_takeover"), deflate));
+			REQUIRE(deflate != nullptr);
+			REQUIRE_EQ(deflate->getWindowBits(), 15);
+			delete deflate;
+
+			REQUIRE(WebsocketDeflate::checkResponse(
+				_F("permessage-deflate; server_no_context_takeover; client_max_window_bits=9"), deflate));
+			REQUIRE(deflate != nullptr);
+			REQUIRE_EQ(deflate->getWindowBits(), 9);
+			delete deflate;
+
+			// Server must agree not to use context takeover
+			REQUIRE(!WebsocketDeflate::checkResponse(_F("permessage-deflate"), deflate));
+			REQUIRE(!WebsocketDeflate::checkResponse(_F("permessage-deflate; server_no_context_takeover, "
+														"permessage-deflate; server_no_context_takeover"),
+													 deflate));
+			REQUIRE(!WebsocketDeflate::checkResponse(_F("x-webkit-deflate-frame"), deflate));
+		}
+
+		TEST_CASE("Client offer")
+		{
+			String response;
+			std::unique_ptr<WebsocketDeflate> server(WebsocketDeflate::accept(WebsocketDeflate::getOffer(), response));
+			REQUIRE(server);
+			WebsocketDeflate* client;
+			REQUIRE(WebsocketDeflate::checkResponse(response, client));
+			REQUIRE(client != nullptr);
+			delete client;
+		}
+	}
+
+	void testFrames()
+	{
+		WebsocketDeflate deflate;
+		String message = makeTelemetry(150);
+		String compressed = deflate.compress(message.c_str(), message.length());
+		REQUIRE(compressed.length() >= 3 * 126);
+
+		/*
+		 * Compressed message in three fragments, each long enough to need an extended length,
+		 * with a control frame between the first two
+		 */
+		auto fragmentLength = compressed.length() / 3;
+		String compressedStream;
+		compressedStream += makeFrame(WS_FRAME_TEXT, false, true, compressed.substring(0, fragmentLength));
+		compressedStream += makeFrame(WS_FRAME_PONG, true, false, F("pong"));
+		compressedStream += makeFrame(0, false, false, compressed.substring(fragmentLength, 2 * fragmentLength));
+		compressedStream += makeFrame(0, true, false, compressed.substring(2 * fragmentLength));
+		// Followed by an uncompressed message in two fragments
+		compressedStream += makeFrame(WS_FRAME_TEXT, false, false, F("Hello "));
+		compressedStream += makeFrame(0, true, false, F("world"));
+
+		TEST_CASE("Receive fragmented compressed message")
+		{
+			for(unsigned sliceSize : {1, 2, 3, 7, 100, 4096}) {
+				TestWebsocket ws(true);
+				String data = compressedStream;
+				REQUIRE(ws.receive(data, sliceSize));
+				REQUIRE_EQ(ws.pongCount, 1U);
+				REQUIRE(ws.messageCount >= 3);
+				REQUIRE(ws.received == message + F("Hello world"));
+			}
+		}
+
+		TEST_CASE("RSV1 on continuation frame")
+		{
+			String data = makeFrame(WS_FRAME_TEXT, false, true, compressed.substring(0, fragmentLength));
+			data += makeFrame(0, true, true, compressed.substring(fragmentLength));
+			TestWebsocket ws(true);
+			REQUIRE(!ws.receive(data, 5));
+			REQUIRE_EQ(ws.messageCount, 0U);
+		}
+
+		TEST_CASE("RSV1 on control frame")
+		{
+			String data = makeFrame(WS_FRAME_PONG, true, true, F("pong"));
+			TestWebsocket ws(true);
+			REQUIRE(!ws.receive(data, 3));
+			REQUIRE_EQ(ws.pongCount, 0U);
+		}
+
+		TEST_CASE("RSV1 without deflate")
+		{
+			String data = makeFrame(WS_FRAME_TEXT, true, true, compressed);
+			TestWebsocket ws(false);
+			REQUIRE(!ws.receive(data, 16));
+			REQUIRE_EQ(ws.messageCount, 0U);
+		}
+	}
+};
+
+void REGISTER_TEST(Websocket)
+{
+	registerGroup<WebsocketTest>();
+}
@@ -0,0 +1,105 @@
+#include <HostTests.h>
+#include <Data/PerfectHash.h>
+#include <Data/WebConstants.h>
+#include <Network/Http/HttpHeaderFields.h>
+
+namespace
+{
+constexpr const char* colourNames[]{"red", "green", "blue", "Red", "indigo", "violet", ""};
+DEFINE_PERFECT_HASH_MAP(colourMap, colourNames, true);
+DEFINE_PERFECT_HASH_MAP(colourMapCase, colourNames, false);
+
+// All standard header names plus a few more, so at least 44 keys
+#define XX(tag, str, flags, comment) str,
+constexpr const char* headerNames[]{
+	HTTP_HEADER_FIELDNAME_MAP(XX) "Accept-Language", "Age", "Allow", "Cookie", "Keep-Alive", "Origin", "Pragma",
+	"Referer", "Retry-After", "Vary", "Via", "Warning",
+};
+#undef XX
+DEFINE_PERFECT_HASH_MAP(headerMap, headerNames, true);
+
+// Largest supported map
+#define KEY_ROW(n)                                                                                                     \
+	"key" #n "0", "key" #n "1", "key" #n "2", "key" #n "3", "key" #n "4", "key" #n "5", "key" #n "6", "key" #n "7",    \
+		"key" #n "8", "key" #n "9"
+constexpr const char* manyKeys[]{
+	KEY_ROW(0),  KEY_ROW(1),  KEY_ROW(2),  KEY_ROW(3),  KEY_ROW(4),  KEY_ROW(5),  KEY_ROW(6),  KEY_ROW(7),
+	KEY_ROW(8),  KEY_ROW(9),  KEY_ROW(10), KEY_ROW(11), KEY_ROW(12), KEY_ROW(13), KEY_ROW(14), KEY_ROW(15),
+	KEY_ROW(16), KEY_ROW(17), KEY_ROW(18), KEY_ROW(19), KEY_ROW(20), KEY_ROW(21), KEY_ROW(22), KEY_ROW(23),
+	KEY_ROW(24), "key250",    "key251",    "key252",    "key253",
+};
+#undef KEY_ROW
+DEFINE_PERFECT_HASH_MAP(manyKeyMap, manyKeys, false);
+
+} // namespace
+
+class PerfectHashTest : public TestGroup
+{
+public:
+	PerfectHashTest() : TestGroup(_F("PerfectHash"))
+	{
+	}
+
+	void execute() override
+	{
+		TEST_CASE("Map")
+		{
+			REQUIRE_EQ(colourMap.indexOf("red"), 0);
+			REQUIRE_EQ(colourMap.indexOf("GREEN"), 1);
+			REQUIRE_EQ(colourMap.indexOf("Blue"), 2);
+			REQUIRE_EQ(colourMap.indexOf("violet"), 5);
+			REQUIRE_EQ(colourMap.indexOf(""), 6);
+			REQUIRE_EQ(colourMap.indexOf("viole"), -1);
+			REQUIRE_EQ(colourMap.indexOf("yellow"), -1);
+			REQUIRE_EQ(colourMap.indexOf(nullptr), -1);
+
+			// Key length given explicitly
+			REQUIRE_EQ(colourMap.indexOf("bluegreen", 4), 2);
+
+			// Duplicate key resolves to first entry
+			REQUIRE_EQ(colourMap.indexOf("RED"), 0);
+			REQUIRE_EQ(colourMapCase.indexOf("Red"), 3);
+			REQUIRE_EQ(colourMapCase.indexOf("RED"), -1);
+		}
+
+		TEST_CASE("Large maps")
+		{
+			static_assert(headerMap.count() >= 44, "Too few keys");
+			for(unsigned i = 0; i < headerMap.count(); ++i) {
+				REQUIRE_EQ(headerMap.indexOf(headerNames[i]), int(i));
+			}
+			REQUIRE_EQ(headerMap.indexOf("content-LENGTH"), int(HttpHeaderFieldName::CONTENT_LENGTH) - 1);
+			REQUIRE_EQ(headerMap.indexOf("Content-Lengths"), -1);
+
+			static_assert(manyKeyMap.count() == 254, "Wrong key count");
+			for(unsigned i = 0; i < manyKeyMap.count(); ++i) {
+				REQUIRE_EQ(manyKeyMap.indexOf(manyKeys[i]), int(i));
+			}
+			REQUIRE_EQ(manyKeyMap.indexOf("KEY00"), -1);
+			REQUIRE_EQ(manyKeyMap.indexOf("key254"), -1);
+		}
+
+		TEST_CASE("ContentType")
+		{
+#define XX(name, ext, mime)                                                                                            \
+	REQUIRE(ContentType::fromString(_F(mime)) == MIME_##name);                                                         \
+	if(ext[0] != '\0') {                                                                                               \
+		REQUIRE(ContentType::fromFileExtension(_F(ext), MIME_UNKNOWN) == MIME_##name);                                 \
+	}
+			MIME_TYPE_MAP(XX)
+#undef XX
+
+			REQUIRE(ContentType::fromFileExtension(_F("HTM"), MIME_UNKNOWN) == MIME_HTML);
+			REQUIRE(ContentType::fromFileExtension(_F("Json"), MIME_UNKNOWN) == MIME_JSON);
+			REQUIRE(ContentType::fromFileExtension(_F("foo"), MIME_UNKNOWN) == MIME_UNKNOWN);
+			REQUIRE(ContentType::fromString(_F("Application/XML")) == MIME_XML);
+			REQUIRE(ContentType::fromString(_F("text/htm")) == MIME_UNKNOWN);
+			REQUIRE(ContentType::fromFullFileName(_F("/path/index.Html"), MIME_UNKNOWN) == MIME_HTML);
+		}
+	}
+};
+
+void REGISTER_TEST(PerfectHash)
+{
+	registerGroup<PerfectHashTest>();
+}
@@ -0,0 +1,161 @@
+#include <HostTests.h>
+#include <Storage.h>
+#include <Services/RingLog/RingLog.h>
+#include <Services/RingLog/RingLogStream.h>
+
+class RingLogTest : public TestGroup
+{
+public:
+	RingLogTest() : TestGroup(_F("RingLog"))
+	{
+	}
+
+	void execute() override
+	{
+		part = Storage::findPartition(F("ringlog0"));
+		if(!part) {
+			Serial << _F("ringlog0 partition not found, skipping tests") << endl;
+			return;
+		}
+
+		TEST_CASE("Append and remount")
+		{
+			REQUIRE(ringLog.format(part));
+			REQUIRE(ringLog.isEmpty());
+			REQUIRE(ringLog.begin() == ringLog.end());
+
+			for(unsigned i = 0; i < 100; ++i) {
+				REQUIRE(ringLog.append(makeRecord(i)));
+			}
+			REQUIRE_EQ(ringLog.getStats().appendCount, 100U);
+
+			REQUIRE(ringLog.mount(part));
+			REQUIRE_EQ(checkRecords(0), 100U);
+		}
+
+		TEST_CASE("Wrap")
+		{
+			REQUIRE(ringLog.format(part));
+			unsigned count = 0;
+			while(ringLog.getStats().sectorErases < 3U * ringLog.getSectorCount()) {
+				REQUIRE(ringLog.append(makeRecord(count)));
+				++count;
+			}
+			REQUIRE_EQ(ringLog.getUsedSectors(), ringLog.getSectorCount());
+
+			REQUIRE(ringLog.mount(part));
+			auto first = ringLog.getContent(*ringLog.begin());
+			unsigned start = first.substring(7).toInt();
+			debug_i("Wrote %u records, oldest is #%u", count, start);
+			REQUIRE_EQ(start + checkRecords(start), count);
+		}
+
+		TEST_CASE("Interrupted append")
+		{
+			REQUIRE(ringLog.format(part));
+			for(unsigned i = 0; i < 10; ++i) {
+				REQUIRE(ringLog.append(makeRecord(i)));
+			}
+
+			// Simulate power loss after header write but before payload write
+			auto pos = ringLog.getWritePosition();
+			const uint16_t len = 20;
+			const uint16_t hdr[]{len, uint16_t(~len), 0x1234, 0x5678};
+			REQUIRE(part.write(ringLog.getAddress(pos), hdr, sizeof(hdr)));
+
+			REQUIRE(ringLog.mount(part));
+			REQUIRE_EQ(checkRecords(0), 10U);
+			REQUIRE(ringLog.append(makeRecord(10)));
+			REQUIRE(ringLog.getWritePosition().sequence == pos.sequence + 1);
+			REQUIRE_EQ(checkRecords(0), 11U);
+		}
+
+		TEST_CASE("Stream")
+		{
+			REQUIRE(ringLog.format(part));
+			String expected;
+			for(unsigned i = 0; i < 200; ++i) {
+				auto s = makeRecord(i);
+				REQUIRE(ringLog.append(s));
+				expected += s;
+			}
+			Storage::RingLogStream stream(ringLog);
+			String content = stream.readString(0xffff);
+			REQUIRE(content == expected);
+			REQUIRE(stream.isFinished());
+		}
+
+		TEST_CASE("Benchmark")
+		{
+			benchmark();
+		}
+
+		ringLog.unmount();
+	}
+
+	static String makeRecord(unsigned index)
+	{
+		String s = F("record ");
+		s += index;
+		s += F(": temperature=21.5, humidity=45, pressure=1013\n");
+		return s;
+	}
+
+	/*
+	 * Iterate over ringLog and confirm records are consecutive, starting from `start`
+	 */
+	unsigned checkRecords(unsigned start)
+	{
+		unsigned count = 0;
+		for(auto& record : ringLog) {
+			REQUIRE(ringLog.verify(record));
+			REQUIRE(ringLog.getContent(record) == makeRecord(start + count));
+			++count;
+		}
+		return count;
+	}
+
+	void benchmark()
+	{
+		const unsigned recordCount = 1000;
+
+		REQUIRE(ringLog.format(part));
+		OneShotFastUs timer;
+		for(unsigned i = 0; i < recordCount; ++i) {
+			ringLog.append(makeRecord(i));
+		}
+		auto ringLogTime = timer.elapsedTime();
+
+		timer.start();
+		REQUIRE(ringLog.mount(part));
+		auto mountTime = timer.elapsedTime();
+
+		DEFINE_FSTR_LOCAL(filename, "ringlog.bench");
+		fileDelete(filename);
+		auto file = fileOpen(filename, File::CreateNewAlways | File::WriteOnly);
+		REQUIRE(file >= 0);
+		timer.start();
+		for(unsigned i = 0; i < recordCount; ++i) {
+			auto s = makeRecord(i);
+			fileWrite(file, s.c_str(), s.length());
+			fileFlush(file);
+		}
+		auto spiffsTime = timer.elapsedTime();
+		fileClose(file);
+		fileDelete(filename);
+
+		Serial << _F("Append ") << recordCount << _F(" records:") << endl;
+		Serial << _F("  RingLog: ") << ringLogTime.toString() << endl;
+		Serial << _F("  SPIFFS:  ") << spiffsTime.toString() << endl;
+		Serial << _F("  RingLog mount: ") << mountTime.toString() << endl;
+	}
+
+private:
+	Storage::Partition part;
+	Storage::RingLog ringLog;
+};
+
+void REGISTER_TEST(RingLog)
+{
+	registerGroup<RingLogTest>();
+}
@@ -4,6 +4,8 @@
 #include <Data/Stream/LimitedMemoryStream.h>
 #include <Data/Stream/XorOutputStream.h>
 #include <Data/Stream/SharedMemoryStream.h>
+#include <Data/Stream/SegmentedStream.h>
+#include <Data/Buffer/CircularBuffer.h>
 #include <Data/WebHelpers/base64.h>
 #include <malloc_count.h>
 
@@ -213,6 +215,128 @@ public:
 			REQUIRE(data.use_count() == 1);
 		}
 
+		TEST_CASE("SegmentedStream")
+		{
+			String ref;
+			SegmentedStream stream(64);
+			for(unsigned i = 0; i < 100; ++i) {
+				ref += F("{\"id\":");
+				ref += i;
+				ref += F(",\"value\":\"");
+				ref += String(i * 12345, HEX);
+				ref += F("\"},");
+				stream << F("{\"id\":") << i << F(",\"value\":\"") << String(i * 12345, HEX) << F("\"},");
+			}
+			REQUIRE_EQ(size_t(stream.available()), ref.length());
+			REQUIRE_EQ(stream.getSize(), ref.length());
+			REQUIRE(stream.getSegmentCount() == (ref.length() + 63) / 64);
+
+			// Segments are released as content is read
+			auto segmentCount = stream.getSegmentCount();
+			MemoryDataStream mem;
+			REQUIRE_EQ(mem.copyFrom(&stream, 100), ref.length());
+			REQUIRE(stream.isFinished());
+			REQUIRE_EQ(stream.getSegmentCount(), 0U);
+			debug_i("SegmentedStream released %u segments", segmentCount);
+
+			String s;
+			REQUIRE(mem.moveString(s));
+			REQUIRE(s == ref);
+
+			// Seeking backwards not supported
+			stream << "abcdef";
+			REQUIRE(stream.seek(2));
+			REQUIRE(stream.seekFrom(0, SeekOrigin::Start) < 0);
+			char buf[8];
+			REQUIRE(stream.readMemoryBlock(buf, sizeof(buf)) == 4);
+			REQUIRE(memcmp(buf, "cdef", 4) == 0);
+
+			// Segments cannot be empty, so zero size uses the default
+			SegmentedStream stream2(0);
+			REQUIRE_EQ(stream2.getBlockSize(), SegmentedStream(SegmentedStream::defaultSegmentSize).getBlockSize());
+			REQUIRE_EQ(stream2.write(reinterpret_cast<const uint8_t*>(ref.c_str()), ref.length()), ref.length());
+			REQUIRE(stream2.getSegmentCount() != 0);
+		}
+
+		TEST_CASE("SpscRing")
+		{
+			uint16_t storage[16];
+			SpscRing<uint16_t> ring(storage, ARRAY_SIZE(storage));
+			REQUIRE(!ring.setBuffer(storage, 15));
+			REQUIRE(ring.isEmpty());
+
+			// Fill, leaving read/write positions part-way through buffer
+			uint16_t value{0};
+			for(unsigned i = 0; i < 10; ++i) {
+				REQUIRE(ring.push(i));
+			}
+			for(unsigned i = 0; i < 10; ++i) {
+				REQUIRE(ring.pop(value));
+				REQUIRE_EQ(value, i);
+			}
+
+			// Bulk write wraps around end of buffer
+			uint16_t data[20];
+			for(unsigned i = 0; i < ARRAY_SIZE(data); ++i) {
+				data[i] = 100 + i;
+			}
+			REQUIRE_EQ(ring.write(data, ARRAY_SIZE(data)), 16U);
+			REQUIRE(ring.isFull());
+			REQUIRE(!ring.push(0));
+			REQUIRE_EQ(*ring.peekLast(), 115);
+
+			// Contiguous spans stop at end of buffer
+			uint16_t* span;
+			REQUIRE_EQ(ring.getReadSpan(span), 6U);
+			REQUIRE_EQ(span[0], 100);
+			ring.commitRead(6);
+			REQUIRE_EQ(ring.getReadSpan(span), 10U);
+			REQUIRE_EQ(span[0], 106);
+
+			REQUIRE_EQ(ring.getWriteSpan(span), 6U);
+			span[0] = 999;
+			ring.commitWrite(1);
+			REQUIRE_EQ(ring.available(), 11U);
+
+			uint16_t out[16]{};
+			REQUIRE_EQ(ring.peek(out, 16, 8), 3U);
+			REQUIRE_EQ(out[0], 114);
+			REQUIRE_EQ(out[2], 999);
+			REQUIRE_EQ(ring.read(out, 16), 11U);
+			REQUIRE_EQ(out[10], 999);
+			REQUIRE(ring.isEmpty());
+		}
+
+		TEST_CASE("CircularBuffer")
+		{
+			CircularBuffer buffer(100);
+			REQUIRE_EQ(buffer.room(), 128U);
+
+			String ref;
+			for(unsigned i = 0; i < 20; ++i) {
+				String line = "Line ";
+				line += i;
+				line += "\r\n";
+				ref += line;
+				REQUIRE_EQ(buffer.write(reinterpret_cast<const uint8_t*>(line.c_str()), line.length()), line.length());
+				// Read back half, so content wraps around buffer
+				char tmp[8];
+				auto len = buffer.readMemoryBlock(tmp, sizeof(tmp));
+				REQUIRE(buffer.seek(len));
+				REQUIRE(ref.startsWith(String(tmp, len)));
+				ref.remove(0, len);
+			}
+
+			const char* data;
+			auto len = buffer.getReadSpan(data);
+			REQUIRE(len != 0 && len <= size_t(buffer.available()));
+			REQUIRE(ref.startsWith(String(data, len)));
+
+			String s = buffer.readString(1024);
+			REQUIRE(s == ref);
+			REQUIRE(buffer.isFinished());
+		}
+
 		auto memNow = MallocCount::getCurrent();
 		// auto memNow = system_get_free_heap_size();
 		REQUIRE_EQ(memStart, memNow);
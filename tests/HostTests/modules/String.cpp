@@ -1,6 +1,9 @@
 #include <HostTests.h>
 
 #include <Data/HexString.h>
+#include <Data/InternedString.h>
+#include <WHashMap.h>
+#include <malloc_count.h>
 
 class StringTest : public TestGroup
 {
@@ -17,6 +20,7 @@ public:
 		testString();
 		testMove();
 		testMakeHexString();
+		testInterning();
 	}
 
 	template <typename T> void templateTest(T)
@@ -212,6 +216,65 @@ public:
 			REQUIRE(makeHexString(hwaddr, 0, ':') == String::empty);
 		}
 	}
+
+	void testInterning()
+	{
+		TEST_CASE("InternedString")
+		{
+			StringPool pool(64);
+			InternedString s1("content-type", pool);
+			REQUIRE(s1);
+			REQUIRE(s1 == "content-type");
+			REQUIRE(s1.length() == 12U);
+
+			// Same content gives same storage, without further allocation
+			auto allocCount = MallocCount::getAllocCount();
+			String key("content-type");
+			InternedString s2(key, pool);
+			REQUIRE(s2 == s1);
+			REQUIRE(s2.c_str() == s1.c_str());
+			if(allocCount != 0) {
+				// Allocations are only counted if malloc_count is enabled
+				REQUIRE(MallocCount::getAllocCount() == allocCount + 1); // Just `key`
+			}
+			REQUIRE(pool.count() == 1U);
+
+			InternedString s3("content-length", pool);
+			REQUIRE(s3 != s1);
+			REQUIRE(!InternedString::find("unknown", 7, pool));
+			REQUIRE(InternedString::find(F("content-length"), pool) == s3);
+
+			// Grow table and spill into further blocks
+			for(unsigned i = 0; i < 100; ++i) {
+				InternedString s(String(i), pool);
+				REQUIRE(s.toString() == String(i));
+			}
+			REQUIRE(pool.count() == 102U);
+			REQUIRE(InternedString("content-type", pool) == s1);
+			REQUIRE(InternedString(String(50), pool) == InternedString("50", pool));
+
+			HashMap<InternedString, int> map;
+			map[s1] = 1;
+			map[s3] = 2;
+			REQUIRE(map[InternedString("content-length", pool)] == 2);
+			REQUIRE(map.contains(InternedString(F("content-type"), pool)));
+			REQUIRE(!map.contains(InternedString("content-type")));
+
+			// Contiguous storage: no allocation per key
+			InternedString keys[8];
+			for(unsigned i = 0; i < ARRAY_SIZE(keys); ++i) {
+				keys[i] = InternedString(String(i), pool);
+			}
+			allocCount = MallocCount::getAllocCount();
+			SmallMap<InternedString, int, ARRAY_SIZE(keys)> smallMap;
+			for(unsigned i = 0; i < ARRAY_SIZE(keys); ++i) {
+				smallMap[keys[i]] = i;
+			}
+			REQUIRE_EQ(smallMap.count(), 8U);
+			REQUIRE(smallMap[InternedString("5", pool)] == 5);
+			REQUIRE_EQ(MallocCount::getAllocCount(), allocCount);
+		}
+	}
 };
 
 void REGISTER_TEST(String)
@@ -0,0 +1,212 @@
+#include <HostTests.h>
+#include <stringutil.h>
+
+#ifndef STRING_SEARCH_BENCHMARK_ITERATIONS
+#define STRING_SEARCH_BENCHMARK_ITERATIONS 2000
+#endif
+
+namespace
+{
+/*
+ * Simple byte-at-a-time implementations for reference
+ */
+__noinline const void* byteMemchr(const void* s, int c, size_t n)
+{
+	auto p = static_cast<const uint8_t*>(s);
+	for(; n != 0; ++p, --n) {
+		if(*p == uint8_t(c)) {
+			return p;
+		}
+	}
+	return nullptr;
+}
+
+__noinline const void* byteMemmem(const void* haystack, size_t haystacklen, const void* needle, size_t needlelen,
+								  bool ignoreCase)
+{
+	auto p = static_cast<const char*>(haystack);
+	auto str = static_cast<const char*>(needle);
+	for(size_t i = 0; i + needlelen <= haystacklen; ++i) {
+		size_t n = 0;
+		while(n < needlelen && (ignoreCase ? tolower(p[i + n]) == tolower(str[n]) : p[i + n] == str[n])) {
+			++n;
+		}
+		if(n == needlelen) {
+			return p + i;
+		}
+	}
+	return nullptr;
+}
+
+__noinline int byteMemicmp(const void* buf1, const void* buf2, size_t len)
+{
+	auto p1 = static_cast<const uint8_t*>(buf1);
+	auto p2 = static_cast<const uint8_t*>(buf2);
+	int result = 0;
+	while(len-- && (result = tolower(*p1++) - tolower(*p2++)) == 0) {
+	}
+	return result;
+}
+
+int sign(int value)
+{
+	return (value > 0) - (value < 0);
+}
+
+} // namespace
+
+class StringSearchTest : public TestGroup
+{
+public:
+	StringSearchTest() : TestGroup(_F("StringSearch"))
+	{
+	}
+
+	void execute() override
+	{
+		// Text with a mix of cases, no digits
+		for(unsigned i = 0; i < sizeof(text); ++i) {
+			uint8_t c = (i * 7 + (i >> 3)) % 27;
+			text[i] = (c == 26) ? ' ' : ((i & 0x10) ? 'A' : 'a') + c;
+		}
+
+		TEST_CASE("memchr")
+		{
+			unsigned errors = 0;
+			for(unsigned align = 0; align < 4; ++align) {
+				for(unsigned len = 0; len < 40; ++len) {
+					char buf[48];
+					memset(buf, 'x', sizeof(buf));
+					for(unsigned pos = 0; pos <= len; ++pos) {
+						if(pos < len) {
+							buf[align + pos] = '\x80';
+						}
+						if(memchr_swar(&buf[align], 0x80, len) != byteMemchr(&buf[align], 0x80, len)) {
+							++errors;
+						}
+						buf[align + pos] = 'x';
+					}
+				}
+			}
+			REQUIRE_EQ(errors, 0U);
+			REQUIRE(memchr_fast(text, '9', sizeof(text)) == nullptr);
+		}
+
+		TEST_CASE("memmem")
+		{
+			unsigned errors = 0;
+			for(unsigned offset = 0; offset < 64; ++offset) {
+				for(unsigned len = 1; len < 12; ++len) {
+					auto needle = &text[sizeof(text) - 64 + offset - len];
+					auto expected = byteMemmem(text, sizeof(text), needle, len, false);
+					if(memmem_swar(text, sizeof(text), needle, len) != expected) {
+						++errors;
+					}
+					if(memmem_fast(text, sizeof(text), needle, len) != expected) {
+						++errors;
+					}
+				}
+			}
+			REQUIRE_EQ(errors, 0U);
+			REQUIRE(memmem_swar(text, sizeof(text), "zz9", 3) == nullptr);
+			REQUIRE(memmem_swar(text, 2, text, 3) == nullptr);
+			REQUIRE(memmem_swar(text, 2, text, 0) == text);
+		}
+
+		TEST_CASE("memmemi")
+		{
+			String s = F("Content-Type: text/HTML; charset=UTF-8");
+			auto buf = s.c_str();
+			REQUIRE(memmemi(buf, s.length(), "content-type", 12) == buf);
+			REQUIRE(memmemi(buf, s.length(), "Text/html", 9) == buf + 14);
+			REQUIRE(memmemi(buf, s.length(), "utf-8", 5) == buf + s.length() - 5);
+			REQUIRE(memmemi(buf, s.length(), "utf-9", 5) == nullptr);
+			REQUIRE(strstri(buf, "CHARSET") == buf + 25);
+
+			unsigned errors = 0;
+			for(unsigned offset = 0; offset < 64; ++offset) {
+				char needle[8];
+				memcpy(needle, &text[offset * 5], sizeof(needle));
+				needle[offset % sizeof(needle)] ^= 0x20; // Change case of one character
+				if(memmemi(text, sizeof(text), needle, sizeof(needle)) !=
+				   byteMemmem(text, sizeof(text), needle, sizeof(needle), true)) {
+					++errors;
+				}
+			}
+			REQUIRE_EQ(errors, 0U);
+		}
+
+		TEST_CASE("memicmp")
+		{
+			// Include characters either side of the alphabetic ranges
+			const char* s1 = "@AZ[`az{\x80\xc1\xda\xe1 0123456789abcdefghijklmnopqrstuvwxyz";
+			const char* s2 = "@az[`AZ{\x80\xe1\xfa\xc1 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+			auto len = strlen(s1);
+			unsigned errors = 0;
+			char buf1[64];
+			char buf2[64];
+			for(unsigned align1 = 0; align1 < 4; ++align1) {
+				for(unsigned align2 = 0; align2 < 4; ++align2) {
+					memcpy(&buf1[align1], s1, len);
+					memcpy(&buf2[align2], s2, len);
+					for(unsigned n = 0; n <= len; ++n) {
+						if(sign(memicmp(&buf1[align1], &buf2[align2], n)) !=
+						   sign(byteMemicmp(&buf1[align1], &buf2[align2], n))) {
+							++errors;
+						}
+					}
+				}
+			}
+			REQUIRE_EQ(errors, 0U);
+
+			String str = F("Content-Length");
+			REQUIRE(str.equalsIgnoreCase("content-length"));
+			REQUIRE(!str.equalsIgnoreCase("content-lengths"));
+			REQUIRE(!str.equalsIgnoreCase("content-lengtH\0", 15));
+		}
+
+		TEST_CASE("Benchmark")
+		{
+			char upper[sizeof(text)];
+			for(unsigned i = 0; i < sizeof(text); ++i) {
+				upper[i] = toupper(text[i]);
+			}
+			auto needle = &text[sizeof(text) - 10];
+
+			Serial << STRING_SEARCH_BENCHMARK_ITERATIONS << " iterations of " << sizeof(text) << " bytes" << endl;
+
+			benchmark(F("memchr byte"), [&]() { return byteMemchr(text, '9', sizeof(text)); });
+			benchmark(F("memchr libc"), [&]() { return memchr(text, '9', sizeof(text)); });
+			benchmark(F("memchr swar"), [&]() { return memchr_swar(text, '9', sizeof(text)); });
+
+			benchmark(F("memmem byte"), [&]() { return byteMemmem(text, sizeof(text), needle, 10, false); });
+			benchmark(F("memmem libc"), [&]() { return memmem(text, sizeof(text), needle, 10); });
+			benchmark(F("memmem swar"), [&]() { return memmem_swar(text, sizeof(text), needle, 10); });
+
+			benchmark(F("memmemi byte"), [&]() { return byteMemmem(text, sizeof(text), needle, 10, true); });
+			benchmark(F("memmemi swar"), [&]() { return memmemi(text, sizeof(text), needle, 10); });
+
+			benchmark(F("memicmp byte"), [&]() { return byteMemicmp(text, upper, sizeof(text)); });
+			benchmark(F("memicmp swar"), [&]() { return memicmp(text, upper, sizeof(text)); });
+		}
+	}
+
+private:
+	template <typename Func> void benchmark(const String& name, Func func)
+	{
+		OneShotFastUs timer;
+		for(unsigned i = 0; i < STRING_SEARCH_BENCHMARK_ITERATIONS; ++i) {
+			sink = intptr_t(func());
+		}
+		auto elapsed = timer.elapsedTime();
+		Serial << name << ": " << elapsed << " us" << endl;
+	}
+
+	alignas(4) char text[1024];
+	volatile intptr_t sink;
+};
+
+void REGISTER_TEST(StringSearch)
+{
+	registerGroup<StringSearchTest>();
+}
@@ -72,7 +72,92 @@ public:
 	}
 };
 
+/*
+ * Check priority lanes, spill list and deferred callbacks
+ */
+class TaskQueueTest : public TestGroup
+{
+public:
+	TaskQueueTest() : TestGroup(_F("Task queue"))
+	{
+	}
+
+	void execute() override
+	{
+		TEST_CASE("Priority order")
+		{
+			order = nullptr;
+			System.queueCallback([this]() { order += 'L'; }, TaskPriority::Low);
+			System.queueCallback([this]() { order += 'N'; });
+			System.queueCallback([this]() { order += 'H'; }, TaskPriority::High);
+			System.queueCallback([this]() { checkOrder(); }, TaskPriority::Low);
+			pending();
+		}
+	}
+
+	void checkOrder()
+	{
+		REQUIRE_EQ(order, "HNL");
+
+		TEST_CASE("Spill list")
+		{
+			System.resetTaskStats();
+			spillCount = 0;
+			// Fill lane with more delegates than it can hold, then check they're all executed in order
+			for(unsigned i = 0; i < spillTotal; ++i) {
+				REQUIRE(System.queueCallback([this, i]() {
+					REQUIRE_EQ(spillCount, i);
+					++spillCount;
+				}));
+			}
+			auto& stats = System.getTaskStats(TaskPriority::Normal);
+			REQUIRE(stats.spillCount != 0);
+			System.queueCallback([this]() { checkSpill(); }, TaskPriority::Low);
+		}
+	}
+
+	void checkSpill()
+	{
+		REQUIRE_EQ(spillCount, spillTotal);
+		auto& stats = System.getTaskStats(TaskPriority::Normal);
+		REQUIRE_EQ(stats.spillCount, 0);
+		REQUIRE(stats.maxSpill != 0);
+		REQUIRE_EQ(stats.failed, 0U);
+		Serial << _F("Normal lane: executed ") << stats.executed << _F(", maxCount ") << stats.maxCount
+			   << _F(", maxSpill ") << stats.maxSpill << _F(", maxLatency ") << stats.maxLatency << endl;
+
+		TEST_CASE("Deferred callback")
+		{
+			timer.start();
+			REQUIRE(System.queueDeferredCallback(200, [this]() { order += '2'; }));
+			REQUIRE(System.queueDeferredCallback(100, [this]() {
+				order = '1';
+				elapsed = timer.elapsedTime();
+			}));
+			REQUIRE(System.queueDeferredCallback(300, [this]() { checkDeferred(); }, TaskPriority::High));
+		}
+	}
+
+	void checkDeferred()
+	{
+		uint32_t total = timer.elapsedTime();
+		debug_i("Deferred callbacks after %u, %u ms", elapsed, total);
+		REQUIRE_EQ(order, "12");
+		REQUIRE(elapsed >= 100);
+		REQUIRE(total >= 300);
+		complete();
+	}
+
+private:
+	static constexpr unsigned spillTotal{50};
+	String order;
+	unsigned spillCount{0};
+	OneShotFastMs timer;
+	uint32_t elapsed{0};
+};
+
 void REGISTER_TEST(System)
 {
 	registerGroup<SystemTest>();
+	registerGroup<TaskQueueTest>();
 }
@@ -8,6 +8,9 @@
 #include <HardwareTimer.h>
 #include <Platform/Timers.h>
 #include <malloc_count.h>
+#ifdef ARCH_HOST
+#include <chrono>
+#endif
 
 using Timer1TestApi = Timer1Api<TIMER_CLKDIV_16, eHWT_Maskable>;
 
@@ -371,6 +374,125 @@ public:
 	}
 };
 
+/*
+ * Measure cost of arming and disarming timers as the number of active timers increases
+ */
+class TimerScaleTest : public TestGroup
+{
+public:
+#ifdef ARCH_HOST
+	static constexpr unsigned maxTimers = 20000;
+#else
+	static constexpr unsigned maxTimers = 200;
+#endif
+
+	TimerScaleTest() : TestGroup(_F("Timer scaling"))
+	{
+	}
+
+	void execute() override
+	{
+		for(unsigned count = 10; count <= maxTimers; count *= 10) {
+			profile(count);
+		}
+		profile(maxTimers);
+	}
+
+	void profile(unsigned count)
+	{
+		auto timers = new SimpleTimer[count];
+		auto callback = [](void*) {};
+
+		// Pseudo-random intervals so timers are not armed in expiry order
+		uint32_t seed = 1;
+		auto nextInterval = [&]() {
+			seed = seed * 1103515245 + 12345;
+			return 60000 + (seed >> 16) % 60000;
+		};
+
+		OneShotFastUs timer;
+		for(unsigned i = 0; i < count; ++i) {
+			timers[i].initializeMs(nextInterval(), callback).startOnce();
+		}
+		auto armTime = timer.elapsedTime();
+
+		// Re-arm every timer, as happens when timeouts are extended
+		timer.start();
+		for(unsigned i = 0; i < count; ++i) {
+			timers[i].setIntervalMs(nextInterval());
+			timers[i].startOnce();
+		}
+		auto rearmTime = timer.elapsedTime();
+
+		// Disarm in reverse order
+		timer.start();
+		for(unsigned i = count; i > 0; --i) {
+			timers[i - 1].stop();
+		}
+		auto disarmTime = timer.elapsedTime();
+
+		delete[] timers;
+
+		Serial << count << _F(" timers: arm ") << armTime.toString() << _F(", re-arm ") << rearmTime.toString()
+			   << _F(", disarm ") << disarmTime.toString() << _F(", ") << armTime / count << _F(" per arm") << endl;
+	}
+};
+
+#ifdef ARCH_HOST
+/*
+ * Run a day-long simulation using virtual time
+ */
+class VirtualTimeTest : public TestGroup
+{
+public:
+	VirtualTimeTest() : TestGroup(_F("Virtual time"))
+	{
+	}
+
+	void execute() override
+	{
+		wasVirtual = host_time_is_virtual();
+		realStart = std::chrono::steady_clock::now();
+		host_time_set_virtual(true, 0);
+		rtcStart = RTC.getRtcSeconds();
+		clockStart = os_get_nanoseconds();
+
+		hourTimer.initializeMs<3600 * 1000>([this]() { ++hours; }).start();
+		dayTimer.initializeMs<(24 * 3600 + 60) * 1000>([this]() { check(); }).startOnce();
+		pending();
+	}
+
+	void check()
+	{
+		hourTimer.stop();
+		auto rtcElapsed = RTC.getRtcSeconds() - rtcStart;
+		auto clockElapsed = (os_get_nanoseconds() - clockStart) / 1000000000ULL;
+		if(!wasVirtual) {
+			host_time_set_virtual(false, 0);
+		}
+		auto realElapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+																				 realStart)
+							   .count();
+
+		Serial << _F("Simulated ") << clockElapsed << _F(" seconds in ") << realElapsed << _F(" ms") << endl;
+		REQUIRE_EQ(hours, 24U);
+		REQUIRE_EQ(clockElapsed, 24U * 3600 + 60);
+		REQUIRE(rtcElapsed >= 24U * 3600 + 60);
+		REQUIRE(realElapsed < 60000);
+		complete();
+	}
+
+private:
+	Timer hourTimer;
+	Timer dayTimer;
+	std::chrono::steady_clock::time_point realStart;
+	uint64_t clockStart{0};
+	uint32_t rtcStart{0};
+	unsigned hours{0};
+	bool wasVirtual{false};
+};
+#endif
+
 void REGISTER_TEST(Timers)
 {
 	registerGroup<CallbackTimerApiTest<Timer1TestApi>>();
@@ -381,5 +503,10 @@ void REGISTER_TEST(Timers)
 	registerGroup<CallbackTimerSpeedTest<SimpleTimer>>();
 	registerGroup<CallbackTimerSpeedTest<Timer>>();
 
+	registerGroup<TimerScaleTest>();
+#ifdef ARCH_HOST
+	registerGroup<VirtualTimeTest>();
+#endif
+
 	registerGroup<CallbackTimerTest>();
 }
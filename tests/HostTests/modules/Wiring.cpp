@@ -42,6 +42,31 @@ template <typename T> void fillMap(T& map)
 	Serial << "fillMap heap " << MallocCount::getCurrent() - startMem << endl;
 }
 
+template <typename T> void addItem(T& vector, String&& item)
+{
+	vector.add(std::move(item));
+}
+
+void addItem(std::vector<String>& vector, String&& item)
+{
+	vector.push_back(std::move(item));
+}
+
+template <typename T> size_t benchmarkAdd(const char* name, T& vector, unsigned count)
+{
+	auto allocCount = MallocCount::getAllocCount();
+	auto startMem = MallocCount::getCurrent();
+	OneShotFastUs timer;
+	for(unsigned i = 0; i < count; ++i) {
+		addItem(vector, String(i));
+	}
+	auto elapsed = timer.elapsedTime();
+	allocCount = MallocCount::getAllocCount() - allocCount;
+	Serial << name << ": " << count << " items, " << elapsed << " us, " << allocCount << " allocations, heap "
+		   << MallocCount::getCurrent() - startMem << endl;
+	return allocCount;
+}
+
 } // namespace
 
 class WiringTest : public TestGroup
@@ -271,6 +296,103 @@ public:
 			Serial.println();
 		}
 
+		TEST_CASE("Vector growth benchmark")
+		{
+			constexpr unsigned count{200};
+
+			Vector<String> vector1;
+			auto allocs1 = benchmarkAdd("Vector<String>", vector1, count);
+			Vector<String> vector2(10, 0);
+			auto allocs2 = benchmarkAdd("Vector<String> (geometric)", vector2, count);
+			ContiguousVector<String> vector3(10, 0);
+			auto allocs3 = benchmarkAdd("ContiguousVector<String>", vector3, count);
+			std::vector<String> vector4;
+			auto allocs4 = benchmarkAdd("std::vector<String>", vector4, count);
+			(void)allocs4;
+
+			// One allocation per element plus reallocations, only counted if malloc_count is enabled
+			if(MallocCount::getAllocCount() != 0) {
+				REQUIRE(allocs1 > count);
+				REQUIRE(allocs2 > count && allocs2 < allocs1);
+				REQUIRE(allocs3 < 20);
+			}
+
+			for(unsigned i = 0; i < count; ++i) {
+				String s(i);
+				REQUIRE(vector1[i] == s);
+				REQUIRE(vector2[i] == s);
+				REQUIRE(vector3[i] == s);
+			}
+
+			REQUIRE(vector3.emplace("emplaced"));
+			REQUIRE(vector3.lastElement() == "emplaced");
+			REQUIRE(vector3.insertElementAt(vector3[0], 0));
+			REQUIRE(vector3.remove(1));
+			REQUIRE(vector3.removeElement("emplaced"));
+			REQUIRE_EQ(vector3.count(), count);
+			vector3.sort([](const String& lhs, const String& rhs) { return lhs.compareTo(rhs); });
+			REQUIRE(vector3[0] == "0");
+			REQUIRE(vector3[1] == "1");
+			REQUIRE(vector3[2] == "10");
+		}
+
+		TEST_CASE("SmallVector<String>")
+		{
+			// Short strings don't use the heap
+			auto allocCount = MallocCount::getAllocCount();
+			SmallVector<String, 4> vector;
+			REQUIRE(vector.add("a"));
+			REQUIRE(vector.add("b"));
+			REQUIRE(vector.emplace("c"));
+			REQUIRE(vector.insertElementAt("first", 0));
+			REQUIRE_EQ(MallocCount::getAllocCount(), allocCount);
+			REQUIRE_EQ(vector.capacity(), 4U);
+			REQUIRE(vector[0] == "first");
+
+			// Spill to heap
+			REQUIRE(vector.add("d"));
+			REQUIRE(vector.capacity() > 4);
+			REQUIRE(vector[4] == "d");
+			// Allocations are only counted if malloc_count is enabled
+			if(allocCount != 0) {
+				REQUIRE(MallocCount::getAllocCount() != allocCount);
+			}
+
+			// And back again
+			REQUIRE(vector.remove(0));
+			REQUIRE(vector.remove(0));
+			vector.trimToSize();
+			REQUIRE_EQ(vector.capacity(), 4U);
+			REQUIRE_EQ(vector.count(), 3U);
+			REQUIRE(vector[0] == "b");
+			REQUIRE(vector[2] == "d");
+		}
+
+		TEST_CASE("SmallMap<String, String>")
+		{
+			auto allocCount = MallocCount::getAllocCount();
+			SmallMap<String, String, 4> map;
+			map["a"] = "value(a)";
+			map["b"] = "value(b)";
+			map["c"] = "value(c)";
+			REQUIRE_EQ(MallocCount::getAllocCount(), allocCount);
+
+			map["d"] = "value(d)";
+			map["e"] = "value(e)";
+			REQUIRE_EQ(map.count(), 5U);
+			REQUIRE(map["c"] == "value(c)");
+			REQUIRE(map["e"] == "value(e)");
+
+			map.remove("a");
+			REQUIRE(!map.contains("a"));
+			REQUIRE(map.valueAt(0) == "value(b)");
+
+			HashMap<String, String> other;
+			other.setMultiple(map);
+			REQUIRE_EQ(other.count(), 4U);
+			print(other);
+		}
+
 		TEST_CASE("MacAddress")
 		{
 			const uint8_t refOctets[]{0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc};